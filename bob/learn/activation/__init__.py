@@ -10,6 +10,30 @@ from . import version
 from .version import module as __version__
 from .version import api as __api_version__
 
+try:
+  import concurrent.futures
+
+  class Future(concurrent.futures.Future):
+    """A :py:class:`concurrent.futures.Future` for asynchronous activations
+
+    Objects of this type are returned by :py:meth:`Activation.f_async` and
+    friends. Besides the usual :py:class:`concurrent.futures.Future` API,
+    they can be awaited from :py:mod:`asyncio` coroutines.
+    """
+
+    def __await__(self):
+      import asyncio
+      return asyncio.wrap_future(self).__await__()
+
+except ImportError: #Python 2, without the futures backport
+  pass
+
+from .lazy import LazyActivation
+
+# applies the configurations tuned for this machine, if any
+from . import tuning
+tuning.ensure()
+
 def get_config():
   """Returns a string containing the configuration information.
   """
@@ -0,0 +1,265 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sun 18 Oct 2026 11:02:36 CEST
+
+"""Measures the accuracy of activation functions against a high-precision
+reference, in units in the last place (ULP) and in absolute terms
+
+The reference values are computed with :py:mod:`decimal`, at a precision
+well beyond that of doubles, from closed forms chosen not to overflow or
+cancel over the whole double range. Use :py:func:`measure` to evaluate one
+method of a function over given inputs, :py:func:`inputs` to generate the
+standard input sweeps and :py:func:`check` to compare the results with an
+error budget, such as those of :py:data:`BUDGETS`.
+"""
+
+from __future__ import division
+
+import time
+import decimal
+
+import numpy
+
+from . import Identity, Linear, Logistic, HyperbolicTangent, \
+    MultipliedHyperbolicTangent
+
+
+METHODS = ('f', 'f_prime', 'f_prime_from_f', 'f_second', 'f_second_from_f')
+"""The methods of activation functions whose accuracy can be measured"""
+
+REGIONS = ('dense', 'random', 'saturation', 'denormal')
+"""The input sweeps generated by :py:func:`inputs`"""
+
+_CONTEXT = decimal.Context(prec=60, Emax=decimal.MAX_EMAX,
+    Emin=decimal.MIN_EMIN, traps=[])
+
+
+def inputs(region, size=1000, dtype=numpy.float64, seed=0):
+  """Returns ``size`` inputs of the given ``dtype`` (64 or 32-bit floats)
+
+  Regions are:
+
+  ``dense``
+    Evenly spaced values in the range where functions vary, [-20, 20]
+
+  ``random``
+    Values with random signs and magnitudes spread uniformly, in log scale,
+    over the whole range of ``dtype``
+
+  ``saturation``
+    Values with random signs and magnitudes between 20 and the largest
+    value of ``dtype``, where functions saturate
+
+  ``denormal``
+    Subnormal values of ``dtype``, with random signs
+  """
+
+  info = numpy.finfo(dtype)
+  r = numpy.random.RandomState(seed)
+  sign = numpy.where(r.rand(size) < 0.5, -1., 1.)
+
+  if region == 'dense':
+    retval = numpy.linspace(-20., 20., size)
+
+  elif region == 'random':
+    retval = sign * numpy.exp(r.uniform(numpy.log(float(info.tiny)),
+      numpy.log(float(info.max)), size))
+
+  elif region == 'saturation':
+    retval = sign * numpy.exp(r.uniform(numpy.log(20.),
+      numpy.log(float(info.max)), size))
+
+  elif region == 'denormal':
+    # subnormals are integer multiples of the smallest one
+    smallest = float(info.tiny) * float(info.eps)
+    retval = sign * smallest * r.randint(1, int(1/float(info.eps)), size).astype(float)
+
+  else:
+    raise ValueError("region must be one of %s, not `%s'" % \
+        (', '.join(REGIONS), region))
+
+  return retval.astype(dtype)
+
+
+def _expm1(x):
+  """Returns exp(x) - 1, without cancellation for small ``x``"""
+
+  if abs(x) > decimal.Decimal('1e-5'): return x.exp() - 1
+  retval = term = x
+  for k in range(2, 14):
+    term = term * x / k
+    retval += term
+  return retval
+
+
+def _tanh(z):
+  """Returns tanh(z) and tanh'(z), computed from exp(-2|z|), which never
+  overflows"""
+
+  e = (-2 * abs(z)).exp()
+  m = _expm1(-2 * abs(z)) # e - 1, precise where e is close to 1
+  t = -m / (1 + e)
+  if z < 0: t = -t
+  return t, 4 * e / (1 + e) ** 2
+
+
+def _logistic(z):
+  """Returns logistic(z), logistic'(z) and logistic''(z), computed from
+  exp(-|z|), which never overflows"""
+
+  e = (-abs(z)).exp()
+  m = _expm1(-abs(z)) # e - 1, precise where e is close to 1
+  l = 1 / (1 + e) if z >= 0 else e / (1 + e)
+  d = e / (1 + e) ** 2
+  s = m / (1 + e) # 1 - 2*l, for z >= 0
+  if z < 0: s = -s
+  return l, d, d * s
+
+
+def _reference(activation, method, x):
+  """Returns the exact value of ``method`` at ``x``, as a Decimal - to be
+  called in the high-precision context"""
+
+  x = decimal.Decimal(float(x))
+
+  if isinstance(activation, Identity):
+    return (x, decimal.Decimal(1), decimal.Decimal(1), decimal.Decimal(0),
+        decimal.Decimal(0))[METHODS.index(method)]
+
+  if isinstance(activation, Linear):
+    C = decimal.Decimal(activation.C)
+    return (C * x, C, C, decimal.Decimal(0),
+        decimal.Decimal(0))[METHODS.index(method)]
+
+  if isinstance(activation, MultipliedHyperbolicTangent):
+    C = decimal.Decimal(activation.C)
+    M = decimal.Decimal(activation.M)
+  elif isinstance(activation, HyperbolicTangent):
+    C = M = decimal.Decimal(1)
+  else:
+    C = M = None
+
+  if C is not None:
+    if method == 'f_prime_from_f':
+      t = x / C
+      return C * M * (1 - t * t)
+    if method == 'f_second_from_f':
+      t = x / C
+      return -2 * C * M * M * t * (1 - t * t)
+    t, d = _tanh(M * x)
+    if method == 'f': return C * t
+    if method == 'f_prime': return C * M * d
+    return -2 * C * M * M * t * d
+
+  if isinstance(activation, Logistic):
+    if method == 'f_prime_from_f': return x * (1 - x)
+    if method == 'f_second_from_f': return x * (1 - x) * (1 - 2 * x)
+    l, d, s = _logistic(x)
+    return {'f': l, 'f_prime': d, 'f_second': s}[method]
+
+  raise TypeError("no reference is available for activation functions of type `%s'" % type(activation).__name__)
+
+
+def _best_time(call, repeat=3):
+  best = float('inf')
+  for k in range(repeat):
+    start = time.time()
+    call()
+    best = min(best, time.time() - start)
+  return best
+
+
+def measure(activation, method, z, dtype=None):
+  """Measures the error of ``method`` of the built-in ``activation`` on the
+  inputs ``z``
+
+  For ``f_prime_from_f`` and ``f_second_from_f``, the method is evaluated on
+  the activated values of ``z``. Results are rounded to ``dtype`` (by
+  default, that of ``z``) before comparison, so that the errors of 32-bit
+  floats are measured in their own ULPs.
+
+  Returns a dictionary with the maximum and mean errors, in ULPs
+  (``max_ulp``, ``mean_ulp``) and in absolute terms (``max_abs``,
+  ``mean_abs``), the input at which the largest ULP error was found
+  (``worst``) and the throughput of the method on ``z``, in elements per
+  second (``elements_per_second``).
+  """
+
+  dtype = numpy.dtype(dtype or z.dtype)
+  x = z.astype(numpy.float64)
+  if method.endswith('_from_f'): x = activation.f(x)
+
+  call = getattr(activation, method)
+  computed = call(x)
+  elapsed = _best_time(lambda: call(x, computed))
+
+  ulps = numpy.empty(len(x))
+  errors = numpy.empty(len(x))
+  with numpy.errstate(over='ignore'), decimal.localcontext(_CONTEXT):
+    rounded = computed.astype(dtype) # may overflow, like the references
+    for k, (value, result) in enumerate(zip(x, rounded)):
+      exact = _reference(activation, method, value)
+      nearest = dtype.type(float(exact))
+      if numpy.isinf(nearest) and nearest == result: # overflows alike
+        ulps[k] = errors[k] = 0.
+        continue
+      error = abs(decimal.Decimal(float(result)) - exact)
+      errors[k] = float(error)
+      ulps[k] = float(error / decimal.Decimal(float(numpy.spacing(abs(nearest)))))
+
+  worst = int(numpy.argmax(ulps))
+  return {
+      'max_ulp': float(ulps[worst]),
+      'mean_ulp': float(ulps.mean()),
+      'max_abs': float(errors.max()),
+      'mean_abs': float(errors.mean()),
+      'worst': float(z[worst]),
+      'elements_per_second': len(x) / elapsed if elapsed > 0 else float('inf'),
+      }
+
+
+_EXACT = {'f': (0, 0.), 'f_prime': (0, 0.), 'f_prime_from_f': (0, 0.),
+    'f_second': (0, 0.), 'f_second_from_f': (0, 0.)}
+
+def _derivatives(absolute):
+  return dict((k, (None, absolute)) for k in METHODS if k != 'f')
+
+BUDGETS = {
+    'float64': {
+      'Identity': _EXACT,
+      'Linear': dict(_EXACT, f=(0.5, None)),
+      'HyperbolicTangent': dict(_derivatives(1e-15), f=(2, 1e-15)),
+      'MultipliedHyperbolicTangent': dict(_derivatives(1e-15), f=(3, 1e-15)),
+      'Logistic': dict(_derivatives(1e-15), f=(2, 1e-15), f_prime_from_f=(2, 1e-15),
+        f_second_from_f=(3, 1e-15)),
+      },
+    'float32': {
+      'Identity': _EXACT,
+      'Linear': dict(_EXACT, f=(0.5, None)),
+      'HyperbolicTangent': dict(_derivatives(1e-7), f=(1, 1e-7),
+        f_prime_from_f=(1, 1e-7), f_second_from_f=(1, 1e-7)),
+      'MultipliedHyperbolicTangent': dict(_derivatives(1e-7), f=(1, 1e-7)),
+      'Logistic': dict(_derivatives(1e-7), f=(1, 1e-7), f_prime_from_f=(1, 1e-7),
+        f_second_from_f=(1, 1e-7)),
+      },
+    }
+"""Error budgets of the built-in functions over all :py:data:`REGIONS`, as
+(maximum ULP, maximum absolute) errors by input type, function type name and
+method. ``None`` leaves an error unbounded: derivatives lose all relative
+precision where functions saturate (and the second derivatives, also
+around zero), though their absolute errors remain small, and absolute
+errors of unbounded functions are meaningless."""
+
+
+def check(results, budget):
+  """Returns a list of the violations of the ``(max_ulp, max_abs)``
+  ``budget`` by the ``results`` of :py:func:`measure`"""
+
+  max_ulp, max_abs = budget
+  retval = []
+  if max_ulp is not None and results['max_ulp'] > max_ulp:
+    retval.append('%.3g ULP > %g ULP (at %r)' % (results['max_ulp'], max_ulp,
+      results['worst']))
+  if max_abs is not None and results['max_abs'] > max_abs:
+    retval.append('absolute error %.3g > %g' % (results['max_abs'], max_abs))
+  return retval
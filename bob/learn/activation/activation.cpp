@@ -14,9 +14,20 @@
 #include <bob.learn.activation/api.h>
 #include <bob.io.base/api.h>
 #include <bob.learn.activation/Activation.h>
+#include <bob.learn.activation/Stream.h>
+#include <bob.learn.activation/Statistics.h>
+#include <bob.learn.activation/Compact.h>
+#include <bob.learn.activation/Executor.h>
+#include <bob.learn.activation/Trace.h>
+#include <bob.learn.activation/Tuning.h>
+#include <bob.learn.activation/BufferPool.h>
+#include <bob.learn.activation/ResultCache.h>
 #include <boost/bind.hpp>
-#include <boost/function.hpp>
 #include <structmember.h>
+#include <algorithm>
+#include <exception>
+#include <cstdlib>
+#include <unistd.h>
 
 /*******************************************
  * Implementation of Activation base class *
@@ -35,12 +46,12 @@ PyDoc_STRVAR(s_activation_doc,
 .. warning::\n\
 \n\
    You cannot create classes in Python that derive from this one and\n\
-   expect them to work fine with the C++ code, as no hook is\n\
-   implemented as of this time to allow for this. You must create\n\
-   a class that inherits from the C++\n\
-   :cpp:type:`bob::learn::activation::Activation` in C++ and then bind it to\n\
-   Python like we have done for the classes available in these\n\
-   bindings.\n\
+   expect them to work fine with the C++ code. To implement an\n\
+   activation function in Python, use (or derive from)\n\
+   :py:class:`Custom` instead. Otherwise, create a class that\n\
+   inherits from the C++ :cpp:type:`bob::learn::activation::Activation`\n\
+   in C++ and then bind it to Python like we have done for the classes\n\
+   available in these bindings.\n\
 \n\
 ");
 
@@ -57,9 +68,39 @@ static PyObject* PyBobLearnActivation_new
 
 }
 
+/**
+ * Wraps the activation a into a new object of the derived Python type O
+ */
+template <typename O, typename T>
+static PyObject* new_derived(PyTypeObject* type, boost::shared_ptr<T> a) {
+
+  O* retval = (O*)PyBobLearnActivation_new(type, 0, 0);
+  if (!retval) return 0;
+
+  retval->cxx = a;
+  retval->parent.cxx = a;
+
+  return Py_BuildValue("N", retval);
+
+}
+
 PyObject* PyBobLearnActivation_NewFromActivation
 (boost::shared_ptr<bob::learn::activation::Activation> a) {
 
+  // built-in functions are returned with their own Python types
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::IdentityActivation>(a))
+    return new_derived<PyBobLearnIdentityActivationObject>(&PyBobLearnIdentityActivation_Type, p);
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::LinearActivation>(a))
+    return new_derived<PyBobLearnLinearActivationObject>(&PyBobLearnLinearActivation_Type, p);
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::LogisticActivation>(a))
+    return new_derived<PyBobLearnLogisticActivationObject>(&PyBobLearnLogisticActivation_Type, p);
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::HyperbolicTangentActivation>(a))
+    return new_derived<PyBobLearnHyperbolicTangentActivationObject>(&PyBobLearnHyperbolicTangentActivation_Type, p);
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::MultipliedHyperbolicTangentActivation>(a))
+    return new_derived<PyBobLearnMultipliedHyperbolicTangentActivationObject>(&PyBobLearnMultipliedHyperbolicTangentActivation_Type, p);
+  if (auto p = boost::dynamic_pointer_cast<bob::learn::activation::FormulaActivation>(a))
+    return new_derived<PyBobLearnFormulaActivationObject>(&PyBobLearnFormulaActivation_Type, p);
+
   PyBobLearnActivationObject* retval = (PyBobLearnActivationObject*)PyBobLearnActivation_new(&PyBobLearnActivation_Type, 0, 0);
 
   retval->cxx = a;
@@ -83,56 +124,433 @@ static int PyBobLearnActivation_init(PyBobLearnActivationObject* self,
 
 }
 
+typedef double (bob::learn::activation::Activation::*scalar_method_t) (double) const;
+
+/**
+ * Maps all elements of z through the batch version of method into res. Dimensions are
+ * visited in the memory order of z (largest stride outermost) and collapsed
+ * whenever both arrays are contiguous across them, so that Fortran-ordered
+ * and transposed views are also walked sequentially. If stats is set, the
+ * outputs of bob::learn::activation::F are accumulated into it on the fly.
+ * The evaluation is traced with the loop variant chosen (see Trace.h).
+ */
+static int apply(const bob::learn::activation::Activation& activation,
+    bob::learn::activation::Method method, PyArrayObject* z, PyArrayObject* res,
+    bob::learn::activation::Statistics* stats=0) {
+
+  int ndim = PyArray_NDIM(z);
+  if (ndim < 1 || ndim > 4) return 0;
+
+  // sorts dimensions by decreasing input stride
+  int order[4];
+  for (int k=0; k<ndim; ++k) order[k] = k;
+  for (int k=1; k<ndim; ++k) {
+    for (int l=k; l>0 && std::abs((std::ptrdiff_t)PyArray_STRIDE(z, order[l])) > std::abs((std::ptrdiff_t)PyArray_STRIDE(z, order[l-1])); --l) {
+      std::swap(order[l], order[l-1]);
+    }
+  }
+
+  // converts strides to elements and collapses contiguous dimensions
+  npy_intp n[4] = {1, 1, 1, 1};
+  std::ptrdiff_t zs[4] = {0, 0, 0, 0};
+  std::ptrdiff_t rs[4] = {0, 0, 0, 0};
+  int used = 0;
+  for (int k=0; k<ndim; ++k) {
+    npy_intp extent = PyArray_DIM(z, order[k]);
+    if (extent == 0) return 1; //nothing to do
+    if (extent == 1) continue;
+    std::ptrdiff_t zstride = PyArray_STRIDE(z, order[k]) / (std::ptrdiff_t)sizeof(double);
+    std::ptrdiff_t rstride = PyArray_STRIDE(res, order[k]) / (std::ptrdiff_t)sizeof(double);
+    if (used && zs[used-1] == zstride*extent && rs[used-1] == rstride*extent) {
+      n[used-1] *= extent;
+      zs[used-1] = zstride;
+      rs[used-1] = rstride;
+      continue;
+    }
+    n[used] = extent;
+    zs[used] = zstride;
+    rs[used] = rstride;
+    ++used;
+  }
+
+  // right-aligns the loop nest, so the innermost run is always the last one
+  if (used == 0) used = 1;
+  for (int k=3; k>=0; --k) {
+    int from = k - (4 - used);
+    n[k] = (from >= 0) ? n[from] : 1;
+    zs[k] = (from >= 0) ? zs[from] : 0;
+    rs[k] = (from >= 0) ? rs[from] : 0;
+  }
+
+  const double* zp = reinterpret_cast<const double*>(PyArray_DATA(z));
+  double* rp = reinterpret_cast<double*>(PyArray_DATA(res));
+
+  const char* variant = "strided";
+  if (stats) variant = "statistics";
+  else if (zs[3] == 1 && rs[3] == 1)
+    variant = (n[0]*n[1]*n[2] == 1) ? "contiguous" : "blocked";
+  bob::learn::activation::TraceSpan span(activation, method, variant, ndim,
+      PyArray_DIMS(z));
+
+  for (npy_intp i=0; i<n[0]; ++i)
+    for (npy_intp j=0; j<n[1]; ++j)
+      for (npy_intp k=0; k<n[2]; ++k) {
+        std::ptrdiff_t zo = i*zs[0] + j*zs[1] + k*zs[2];
+        std::ptrdiff_t ro = i*rs[0] + j*rs[1] + k*rs[2];
+        if (stats) bob::learn::activation::f_batch_with_statistics(activation, zp + zo, zs[3], rp + ro, rs[3], n[3], *stats);
+        else activation.batch(method, zp + zo, zs[3], rp + ro, rs[3], n[3]);
+      }
+
+  return 1;
+
+}
+
+/**
+ * Evaluates large arrays in parallel, as tuned for their activation (see
+ * Tuning.h), releasing the GIL meanwhile. Only arrays sharing a contiguous
+ * layout are split. If stats is set, each thread accumulates its outputs
+ * into its own statistics, merged into stats at the end. Returns 1 if the
+ * array was evaluated, 0 if it should be evaluated serially. Exceptions are
+ * thrown with the GIL held.
+ */
+static int parallel_apply(const bob::learn::activation::Activation& activation,
+    bob::learn::activation::Method method, PyArrayObject* z, PyArrayObject* res,
+    bob::learn::activation::Statistics* stats=0) {
+
+  std::size_t n = PyArray_SIZE(z);
+  if (!bob::learn::activation::may_parallelize(n)) return 0;
+
+  bool contiguous =
+    (PyArray_IS_C_CONTIGUOUS(z) && PyArray_IS_C_CONTIGUOUS(res)) ||
+    (PyArray_IS_F_CONTIGUOUS(z) && PyArray_IS_F_CONTIGUOUS(res));
+  if (!contiguous) return 0;
+
+  bob::learn::activation::Tuning tuning =
+    bob::learn::activation::get_tuning(activation.unique_identifier());
+  if (tuning.threads < 2 || n < tuning.threshold) return 0;
+
+  bob::learn::activation::CallTimer timer(activation, method, bob::learn::activation::PARALLEL, n);
+  bob::learn::activation::TraceSpan span(activation, method,
+      stats ? "parallel statistics" : "parallel", PyArray_NDIM(z), PyArray_DIMS(z));
+
+  const double* zp = reinterpret_cast<const double*>(PyArray_DATA(z));
+  double* rp = reinterpret_cast<double*>(PyArray_DATA(res));
+  std::exception_ptr error;
+
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    bob::learn::activation::parallel_batch(activation, method, zp, rp, n, tuning, stats);
+  }
+  catch (...) {
+    error = std::current_exception();
+  }
+  Py_END_ALLOW_THREADS
+
+  if (error) std::rethrow_exception(error);
+  return 1;
+
+}
+
 /**
- * Maps all elements of arr through function() into retval
+ * Calls apply() on behalf of a Python call, translating C++ exceptions (e.g.
+ * raised by activations implemented in Python) into Python ones. Returns 0
+ * with an exception set on errors.
  */
-static int apply(boost::function<double (double)> function,
-    PyBlitzArrayObject* z, PyBlitzArrayObject* res) {
-
-  if (z->ndim == 1) {
-    auto z_ = PyBlitzArrayCxx_AsBlitz<double,1>(z);
-    auto res_ = PyBlitzArrayCxx_AsBlitz<double,1>(res);
-    for (int k=0; k<z_->extent(0); ++k)
-      res_->operator()(k) = function(z_->operator()(k));
-    return 1;
-  }
-
-  else if (z->ndim == 2) {
-    auto z_ = PyBlitzArrayCxx_AsBlitz<double,2>(z);
-    auto res_ = PyBlitzArrayCxx_AsBlitz<double,2>(res);
-    for (int k=0; k<z_->extent(0); ++k)
-      for (int l=0; l<z_->extent(1); ++l)
-        res_->operator()(k,l) = function(z_->operator()(k,l));
-    return 1;
-  }
-
-  else if (z->ndim == 3) {
-    auto z_ = PyBlitzArrayCxx_AsBlitz<double,3>(z);
-    auto res_ = PyBlitzArrayCxx_AsBlitz<double,3>(res);
-    for (int k=0; k<z_->extent(0); ++k)
-      for (int l=0; l<z_->extent(1); ++l)
-        for (int m=0; m<z_->extent(2); ++m)
-          res_->operator()(k,l,m) = function(z_->operator()(k,l,m));
-    return 1;
-  }
-
-  else if (z->ndim == 4) {
-    auto z_ = PyBlitzArrayCxx_AsBlitz<double,4>(z);
-    auto res_ = PyBlitzArrayCxx_AsBlitz<double,4>(res);
-    for (int k=0; k<z_->extent(0); ++k)
-      for (int l=0; l<z_->extent(1); ++l)
-        for (int m=0; m<z_->extent(2); ++m)
-          for (int n=0; n<z_->extent(3); ++n)
-            res_->operator()(k,l,m,n) = function(z_->operator()(k,l,m,n));
-    return 1;
+static int checked_apply(PyBobLearnActivationObject* self,
+    bob::learn::activation::Method method, PyArrayObject* z, PyArrayObject* res,
+    bob::learn::activation::Statistics* stats=0) {
+
+  try {
+    if (parallel_apply(*self->cxx, method, z, res, stats)) return 1;
+    bob::learn::activation::CallTimer timer(*self->cxx, method, bob::learn::activation::SERIAL, PyArray_SIZE(z));
+    if (apply(*self->cxx, method, z, res, stats)) return 1;
+    PyErr_Format(PyExc_RuntimeError, "unexpected error occurred applying C++ `%s' to input array (DEBUG ME)", Py_TYPE(self)->tp_name);
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "unknown exception caught while applying `%s' to input array", Py_TYPE(self)->tp_name);
   }
 
   return 0;
 
 }
 
+int PyBobLearnActivation_Apply(PyBobLearnActivationObject* self,
+    bob::learn::activation::Method method, PyObject* z, PyObject* res) {
+  return checked_apply(self, method, reinterpret_cast<PyArrayObject*>(z),
+      reinterpret_cast<PyArrayObject*>(res));
+}
+
+/**
+ * Returns a new reference to a numpy array sharing the memory of ``o``,
+ * which may be a bob.blitz array, a numpy array or any object exporting the
+ * (PEP 3118) buffer protocol. Inputs are only copied if misaligned or
+ * byte-swapped. Outputs (``writeable``) are never copied and must be
+ * aligned, native and writeable: objects that could only be converted by a
+ * copy are rejected. Returns 0 and sets an exception on errors.
+ */
+static PyArrayObject* as_array(PyObject* o, bool writeable) {
+
+  PyObject* retval = 0;
+
+  if (PyBlitzArray_Check(o)) {
+    retval = PyBlitzArray_AsNumpyArray(reinterpret_cast<PyBlitzArrayObject*>(o), 0);
+  }
+  else if (writeable) {
+    retval = PyArray_FromAny(o, 0, 0, 0, NPY_ARRAY_WRITEABLE, 0);
+    if (retval && !PyArray_Check(o)) {
+      // outputs are written in place: fails if the buffer was copied
+      Py_buffer view;
+      if (PyObject_GetBuffer(o, &view, PyBUF_FULL_RO) < 0) {
+        Py_DECREF(retval);
+        return 0;
+      }
+      bool shared = view.buf == PyArray_DATA(reinterpret_cast<PyArrayObject*>(retval));
+      PyBuffer_Release(&view);
+      if (!shared) {
+        PyErr_Format(PyExc_TypeError, "output array of type `%s' cannot be written in place", Py_TYPE(o)->tp_name);
+        Py_DECREF(retval);
+        return 0;
+      }
+    }
+  }
+  else {
+    retval = PyArray_CheckFromAny(o, 0, 0, 0,
+        NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED, 0);
+  }
+
+  if (!retval) return 0;
+
+  PyArrayObject* arr = reinterpret_cast<PyArrayObject*>(retval);
+
+  if (writeable && !(PyArray_ISALIGNED(arr) && PyArray_ISNOTSWAPPED(arr) && PyArray_ISWRITEABLE(arr))) {
+    PyErr_Format(PyExc_TypeError, "output array of type `%s' must be aligned, writeable and in native byte order", Py_TYPE(o)->tp_name);
+    Py_DECREF(retval);
+    return 0;
+  }
+
+  return arr;
+
+}
+
+/**
+ * Checks if ``o`` can be treated as an array by as_array() above
+ */
+static bool is_array(PyObject* o) {
+  return PyBlitzArray_Check(o) || PyArray_Check(o) || PyObject_CheckBuffer(o);
+}
+
+/**
+ * Smallest output arrays, in bytes, taken from the buffer pool when pooling is
+ * on: smaller ones are cheap to allocate
+ */
+static const std::size_t POOLED_MINIMUM = 1 << 16;
+
+/**
+ * A buffer of the pool, given back when the array using it is deleted
+ */
+struct PooledBuffer {
+  void* data;
+  std::size_t bytes;
+};
+
+static void release_pooled_buffer(PyObject* capsule) {
+  PooledBuffer* buffer = reinterpret_cast<PooledBuffer*>(PyCapsule_GetPointer(capsule, 0));
+  bob::learn::activation::buffer_pool().release(buffer->data, buffer->bytes);
+  delete buffer;
+}
+
+/**
+ * Returns a new 64-bit float array with the same shape and memory layout as
+ * z, whose memory is taken from the buffer pool, or 0 with an exception set
+ */
+static PyArrayObject* pooled_array_like(PyArrayObject* z) {
+
+  int ndim = PyArray_NDIM(z);
+  std::size_t n = PyArray_SIZE(z);
+  std::size_t bytes = n * sizeof(double);
+
+  // dense strides, in the memory order of z
+  int order[4];
+  for (int k=0; k<ndim; ++k) order[k] = k;
+  for (int k=1; k<ndim; ++k) {
+    for (int l=k; l>0 && std::abs((std::ptrdiff_t)PyArray_STRIDE(z, order[l])) > std::abs((std::ptrdiff_t)PyArray_STRIDE(z, order[l-1])); --l) {
+      std::swap(order[l], order[l-1]);
+    }
+  }
+  npy_intp strides[4];
+  npy_intp stride = sizeof(double);
+  for (int k=ndim-1; k>=0; --k) {
+    strides[order[k]] = stride;
+    stride *= PyArray_DIM(z, order[k]);
+  }
+
+  PooledBuffer* buffer = new PooledBuffer;
+  buffer->bytes = bytes;
+  try {
+    buffer->data = bob::learn::activation::buffer_pool().acquire(bytes);
+  }
+  catch (std::exception&) {
+    delete buffer;
+    PyErr_NoMemory();
+    return 0;
+  }
+
+  PyObject* base = PyCapsule_New(buffer, 0, &release_pooled_buffer);
+  if (!base) {
+    bob::learn::activation::buffer_pool().release(buffer->data, bytes);
+    delete buffer;
+    return 0;
+  }
+  auto base_ = make_safe(base);
+
+  PyObject* retval = PyArray_NewFromDescr(&PyArray_Type,
+      PyArray_DescrFromType(NPY_FLOAT64), ndim, PyArray_DIMS(z), strides,
+      buffer->data, NPY_ARRAY_ALIGNED | NPY_ARRAY_WRITEABLE, 0);
+  if (!retval) return 0;
+
+  Py_INCREF(base); // stolen
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), base) < 0) {
+    Py_DECREF(retval);
+    return 0;
+  }
+
+  return reinterpret_cast<PyArrayObject*>(retval);
+
+}
+
+/**
+ * Converts and checks the input array ``z_object`` and the output array
+ * ``res_object`` of a call. If ``res_object`` is 0, a new output array with
+ * the same shape and memory layout as the input is allocated, from the
+ * buffer pool if pooling is on (see BufferPool.h). On success, returns 1 and
+ * new references to both arrays. Otherwise, returns 0 with an exception set.
+ */
+static int prepare_arrays(PyBobLearnActivationObject* self,
+    PyObject* z_object, PyObject* res_object,
+    PyArrayObject** z_, PyArrayObject** res_) {
+
+  PyArrayObject* z = as_array(z_object, false);
+  if (!z) return 0;
+  auto z_safe = make_safe(z);
+
+  if (PyArray_TYPE(z) != NPY_FLOAT64) {
+    PyErr_Format(PyExc_TypeError, "`%s' function only supports 64-bit float arrays for input array `z'", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  if (PyArray_NDIM(z) < 1 || PyArray_NDIM(z) > 4) {
+    PyErr_Format(PyExc_TypeError, "`%s' function only accepts 1, 2, 3 or 4-dimensional arrays (not %dD arrays)", Py_TYPE(self)->tp_name, PyArray_NDIM(z));
+    return 0;
+  }
+
+  PyArrayObject* res = 0;
+
+  if (!res_object) {
+
+    // creates output array, with the same memory layout as the input
+    if (bob::learn::activation::pooling() &&
+        PyArray_SIZE(z) * sizeof(double) >= POOLED_MINIMUM) {
+      res = pooled_array_like(z);
+    }
+    else {
+      res = reinterpret_cast<PyArrayObject*>(PyArray_NewLikeArray(z,
+            NPY_KEEPORDER, PyArray_DescrFromType(NPY_FLOAT64), 0));
+    }
+    if (!res) return 0;
+
+  }
+
+  else {
+
+    if (!is_array(res_object)) {
+      PyErr_Format(PyExc_TypeError, "`%s' function requires an array for output `res', not `%s'", Py_TYPE(self)->tp_name, Py_TYPE(res_object)->tp_name);
+      return 0;
+    }
+
+    res = as_array(res_object, true);
+    if (!res) return 0;
+    auto res_safe = make_safe(res);
+
+    if (PyArray_TYPE(res) != NPY_FLOAT64) {
+      PyErr_Format(PyExc_TypeError, "`%s' function only supports 64-bit float arrays for output array `res'", Py_TYPE(self)->tp_name);
+      return 0;
+    }
+
+    if (PyArray_NDIM(z) != PyArray_NDIM(res)) {
+      PyErr_Format(PyExc_RuntimeError, "Input and output arrays should have matching number of dimensions, but input array `z' has %d dimensions while output array `res' has %d dimensions", PyArray_NDIM(z), PyArray_NDIM(res));
+      return 0;
+    }
+
+    for (int i=0; i<PyArray_NDIM(z); ++i) {
+
+      if (PyArray_DIM(z, i) != PyArray_DIM(res, i)) {
+        PyErr_Format(PyExc_RuntimeError, "Input and output arrays should have matching sizes, but dimension %d of input array `z' has %" PY_FORMAT_SIZE_T "d positions while output array `res' has %" PY_FORMAT_SIZE_T "d positions", i, (Py_ssize_t)PyArray_DIM(z, i), (Py_ssize_t)PyArray_DIM(res, i));
+        return 0;
+      }
+
+    }
+
+    Py_INCREF(res);
+
+  }
+
+  Py_INCREF(z);
+  *z_ = z;
+  *res_ = res;
+  return 1;
+
+}
+
+/**
+ * Keeps a cached result alive while arrays share it
+ */
+static void release_cached_result(PyObject* capsule) {
+  delete reinterpret_cast<boost::shared_array<double>*>(PyCapsule_GetPointer(capsule, 0));
+}
+
+/**
+ * Tells if results for array ``z`` may be cached: only contiguous arrays of
+ * 64-bit floats, in C order, are hashed in a single pass
+ */
+static bool is_cacheable(PyArrayObject* z) {
+  return PyArray_TYPE(z) == NPY_FLOAT64 && PyArray_NDIM(z) >= 1 &&
+    PyArray_NDIM(z) <= 4 && PyArray_IS_C_CONTIGUOUS(z);
+}
+
+/**
+ * Returns a new read-only array sharing the cached ``result``, with the shape
+ * of ``z``, or 0 with an exception set
+ */
+static PyObject* cached_array(PyArrayObject* z,
+    const boost::shared_array<double>& result) {
+
+  boost::shared_array<double>* held = new boost::shared_array<double>(result);
+  PyObject* base = PyCapsule_New(held, 0, &release_cached_result);
+  if (!base) {
+    delete held;
+    return 0;
+  }
+  auto base_ = make_safe(base);
+
+  PyObject* retval = PyArray_New(&PyArray_Type, PyArray_NDIM(z),
+      PyArray_DIMS(z), NPY_FLOAT64, 0, result.get(), 0, NPY_ARRAY_CARRAY_RO, 0);
+  if (!retval) return 0;
+
+  Py_INCREF(base); // stolen
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), base) < 0) {
+    Py_DECREF(retval);
+    return 0;
+  }
+
+  return retval;
+
+}
+
 static PyObject* PyBobLearnActivation_call1(PyBobLearnActivationObject* self,
-    double (bob::learn::activation::Activation::*method) (double) const,
+    scalar_method_t method, bob::learn::activation::Method batch,
     PyObject* args, PyObject* kwds) {
 
   /* Parses input arguments in a single shot */
@@ -145,47 +563,84 @@ static PyObject* PyBobLearnActivation_call1(PyBobLearnActivationObject* self,
 
   //note: object z is borrowed
 
-  if (PyBlitzArray_Check(z) || PyArray_Check(z)) {
-
-    PyBlitzArrayObject* z_converted = 0;
-    if (!PyBlitzArray_Converter(z, &z_converted)) return 0;
-    auto z_converted_ = make_safe(z_converted);
+  if (PyBob_NumberCheck(z)) {
 
-    if (z_converted->type_num != NPY_FLOAT64) {
-      PyErr_Format(PyExc_TypeError, "`%s' function only supports 64-bit float arrays for input array `z'", Py_TYPE(self)->tp_name);
+    PyObject* z_float = PyNumber_Float(z);
+    auto z_float_ = make_safe(z_float);
+    try {
+      bob::learn::activation::CallTimer timer(*self->cxx, batch, bob::learn::activation::SCALAR, 1);
+      double res_c = ((*self->cxx).*method)(PyFloat_AsDouble(z_float));
+      return PyFloat_FromDouble(res_c);
+    }
+    catch (std::exception& e) {
+      PyErr_SetString(PyExc_RuntimeError, e.what());
       return 0;
     }
 
-    if (z_converted->ndim < 1 || z_converted->ndim > 4) {
-      PyErr_Format(PyExc_TypeError, "`%s' function only accepts 1, 2, 3 or 4-dimensional arrays (not %" PY_FORMAT_SIZE_T "dD arrays)", Py_TYPE(self)->tp_name, z_converted->ndim);
-      return 0;
+  }
+
+  else if (is_array(z)) {
+
+    // looks the input up in the result cache, if there is one
+    boost::shared_ptr<bob::learn::activation::ResultCache> cache =
+      self->cxx->result_cache();
+    PyObject* z_cached = 0;
+    std::vector<std::size_t> shape;
+    uint64_t hash = 0;
+
+    if (cache) {
+      PyArrayObject* z_array = as_array(z, false);
+      if (!z_array) return 0;
+      z_cached = reinterpret_cast<PyObject*>(z_array);
+      if (is_cacheable(z_array)) {
+        shape.assign(PyArray_DIMS(z_array), PyArray_DIMS(z_array) + PyArray_NDIM(z_array));
+        const double* data = reinterpret_cast<const double*>(PyArray_DATA(z_array));
+        std::size_t n = PyArray_SIZE(z_array);
+        // hits are counted and traced as serial evaluations, look-up included
+        bob::learn::activation::CallTimer timer(*self->cxx, batch, bob::learn::activation::SERIAL, n);
+        bob::learn::activation::TraceSpan span(*self->cxx, batch, "cached",
+            shape.size(), shape.data());
+        boost::shared_array<double> result;
+        Py_BEGIN_ALLOW_THREADS
+        result = cache->find(batch, shape, data, n, hash);
+        Py_END_ALLOW_THREADS
+        if (result) {
+          auto z_cached_ = make_safe(z_cached);
+          return cached_array(z_array, result);
+        }
+        // misses are, by the evaluation that follows
+        timer.dismiss();
+        span.dismiss();
+      }
+      z = z_cached;
     }
+    auto z_cached_ = make_xsafe(z_cached);
 
-    // creates output array
-    PyObject* res = PyBlitzArray_SimpleNew(NPY_FLOAT64, z_converted->ndim,
-        z_converted->shape);
+    PyArrayObject* z_converted = 0;
+    PyArrayObject* res = 0;
+    if (!prepare_arrays(self, z, 0, &z_converted, &res)) return 0;
+    auto z_converted_ = make_safe(z_converted);
     auto res_ = make_safe(res);
 
     // processes the data
-    int ok = apply(boost::bind(method, self->cxx, _1),
-        z_converted, reinterpret_cast<PyBlitzArrayObject*>(res));
-
-    if (!ok) {
-      PyErr_Format(PyExc_RuntimeError, "unexpected error occurred applying `%s' to input array (DEBUG ME)", Py_TYPE(self)->tp_name);
-      return 0;
+    if (!checked_apply(self, batch, z_converted, res)) return 0;
+
+    // caches a copy of the result, which the caller may change
+    if (!shape.empty()) {
+      const double* data = reinterpret_cast<const double*>(PyArray_DATA(z_converted));
+      const double* result = reinterpret_cast<const double*>(PyArray_DATA(res));
+      std::size_t n = PyArray_SIZE(z_converted);
+      Py_BEGIN_ALLOW_THREADS
+      try {
+        cache->insert(batch, shape, data, n, hash, result);
+      }
+      catch (std::exception&) {
+        // caching is best effort: the result is returned all the same
+      }
+      Py_END_ALLOW_THREADS
     }
 
-    return PyBlitzArray_NUMPY_WRAP(Py_BuildValue("O", res));
-
-  }
-
-  else if (PyBob_NumberCheck(z)) {
-
-    PyObject* z_float = PyNumber_Float(z);
-    auto z_float_ = make_safe(z_float);
-    auto bound_method = boost::bind(method, self->cxx, _1);
-    double res_c = bound_method(PyFloat_AsDouble(z_float));
-    return PyFloat_FromDouble(res_c);
+    return Py_BuildValue("O", res);
 
   }
 
@@ -195,69 +650,70 @@ static PyObject* PyBobLearnActivation_call1(PyBobLearnActivationObject* self,
 }
 
 static PyObject* PyBobLearnActivation_call2(PyBobLearnActivationObject* self,
-    double (bob::learn::activation::Activation::*method) (double) const,
-    PyObject* args, PyObject* kwds) {
+    bob::learn::activation::Method batch, PyObject* args, PyObject* kwds) {
 
   /* Parses input arguments in a single shot */
   static const char* const_kwlist[] = {"z", "res", 0};
   static char** kwlist = const_cast<char**>(const_kwlist);
 
-  PyBlitzArrayObject* z = 0;
-  PyBlitzArrayObject* res = 0;
+  PyObject* z_object = 0;
+  PyObject* res_object = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&", kwlist,
-        &PyBlitzArray_Converter, &z,
-        &PyBlitzArray_OutputConverter, &res
-        )) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO", kwlist,
+        &z_object, &res_object)) return 0;
 
-  //protects acquired resources through this scope
+  PyArrayObject* z = 0;
+  PyArrayObject* res = 0;
+  if (!prepare_arrays(self, z_object, res_object, &z, &res)) return 0;
   auto z_ = make_safe(z);
   auto res_ = make_safe(res);
 
-  if (z->type_num != NPY_FLOAT64) {
-    PyErr_Format(PyExc_TypeError, "`%s' function only supports 64-bit float arrays for input array `z'", Py_TYPE(self)->tp_name);
-    return 0;
-  }
-
-  if (res->type_num != NPY_FLOAT64) {
-    PyErr_Format(PyExc_TypeError, "`%s' function only supports 64-bit float arrays for output array `res'", Py_TYPE(self)->tp_name);
-    return 0;
-  }
+  //at this point all checks are done, we can proceed into calling C++
+  if (!checked_apply(self, batch, z, res)) return 0;
 
-  if (z->ndim < 1 || z->ndim > 4) {
-    PyErr_Format(PyExc_TypeError, "`%s' function only accepts 1, 2, 3 or 4-dimensional arrays (not %" PY_FORMAT_SIZE_T "dD arrays)", Py_TYPE(self)->tp_name, z->ndim);
-    return 0;
-  }
+  return Py_BuildValue("O", res);
 
-  if (z->ndim != res->ndim) {
-    PyErr_Format(PyExc_RuntimeError, "Input and output arrays should have matching number of dimensions, but input array `z' has %" PY_FORMAT_SIZE_T "d dimensions while output array `res' has %" PY_FORMAT_SIZE_T "d dimensions", z->ndim, res->ndim);
-    return 0;
-  }
+}
 
-  for (Py_ssize_t i=0; i<z->ndim; ++i) {
+/**
+ * Computes f() over an array, accumulating statistics of the outputs
+ */
+static PyObject* PyBobLearnActivation_call_stats(PyBobLearnActivationObject* self,
+    PyObject* args, PyObject* kwds) {
 
-    if (z->shape[i] != res->shape[i]) {
-      PyErr_Format(PyExc_RuntimeError, "Input and output arrays should have matching sizes, but dimension %" PY_FORMAT_SIZE_T "d of input array `z' has %" PY_FORMAT_SIZE_T "d positions while output array `res' has %" PY_FORMAT_SIZE_T "d positions", i, z->shape[i], res->shape[i]);
-      return 0;
-    }
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"z", "res", "stats", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
 
-  }
+  PyObject* z_object = 0;
+  PyObject* res_object = Py_None;
+  PyBobLearnActivationStatisticsObject* stats = 0;
 
-  //at this point all checks are done, we can proceed into calling C++
-  int ok = apply(boost::bind(method, self->cxx, _1), z, res);
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO!", kwlist,
+        &z_object, &res_object,
+        &PyBobLearnActivationStatistics_Type, &stats)) return 0;
 
-  if (!ok) {
-    PyErr_Format(PyExc_RuntimeError, "unexpected error occurred applying C++ `%s' to input array (DEBUG ME)", Py_TYPE(self)->tp_name);
+  if (!is_array(z_object)) {
+    PyErr_Format(PyExc_TypeError, "`%s' can only accumulate statistics over arrays, not objects of type `%s'", Py_TYPE(self)->tp_name, Py_TYPE(z_object)->tp_name);
     return 0;
   }
 
-  return PyBlitzArray_NUMPY_WRAP(Py_BuildValue("O", res));
+  PyArrayObject* z = 0;
+  PyArrayObject* res = 0;
+  if (!prepare_arrays(self, z_object, res_object == Py_None ? 0 : res_object,
+        &z, &res)) return 0;
+  auto z_ = make_safe(z);
+  auto res_ = make_safe(res);
+
+  if (!checked_apply(self, bob::learn::activation::F, z, res, stats->cxx.get())) return 0;
+
+  return Py_BuildValue("O", res);
 
 }
 
 PyDoc_STRVAR(s_call_str, "f");
 PyDoc_STRVAR(s_call_doc,
-"o.f(z, [res]) -> array | scalar\n\
+"o.f(z, [res, [stats]]) -> array | scalar\n\
 \n\
 Computes the activated value, given an input array or scalar\n\
 ``z``, placing results in ``res`` (and returning it).\n\
@@ -275,7 +731,15 @@ error otherwise.\n\
 .. note::\n\
 \n\
    This method only accepts 64-bit float arrays as input or\n\
-   output.\n\
+   output. Besides numpy arrays, any object exporting the buffer\n\
+   protocol (e.g. :py:class:`memoryview` or :py:class:`array.array`)\n\
+   is accepted without copying. Strided, transposed or\n\
+   Fortran-ordered arrays are traversed in memory order.\n\
+\n\
+If you pass a :py:class:`Statistics` object in ``stats``, the\n\
+statistics of the activated values are accumulated into it while\n\
+they are computed. In this case, ``z`` must be an array and\n\
+``res`` may be ``None``, to have a new array allocated.\n\
 \n\
 ");
 
@@ -284,21 +748,26 @@ static PyObject* PyBobLearnActivation_call(PyBobLearnActivationObject* self,
 
   Py_ssize_t nargs = (args?PyTuple_Size(args):0) + (kwds?PyDict_Size(kwds):0);
 
+  if (nargs == 3 || (kwds && PyDict_GetItemString(kwds, "stats"))) {
+    return PyBobLearnActivation_call_stats(self, args, kwds);
+  }
+
   switch (nargs) {
 
     case 1:
       return PyBobLearnActivation_call1
-        (self, &bob::learn::activation::Activation::f, args, kwds);
+        (self, &bob::learn::activation::Activation::f,
+         bob::learn::activation::F, args, kwds);
       break;
 
     case 2:
       return PyBobLearnActivation_call2
-        (self, &bob::learn::activation::Activation::f, args, kwds);
+        (self, bob::learn::activation::F, args, kwds);
       break;
 
     default:
 
-      PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - %s requires 1 or 2 arguments, but you provided %" PY_FORMAT_SIZE_T "d (see help)", s_call_str, nargs);
+      PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - %s requires 1 to 3 arguments, but you provided %" PY_FORMAT_SIZE_T "d (see help)", s_call_str, nargs);
 
   }
 
@@ -327,7 +796,10 @@ error otherwise.\n\
 .. note::\n\
 \n\
    This method only accepts 64-bit float arrays as input or\n\
-   output.\n\
+   output. Besides numpy arrays, any object exporting the buffer\n\
+   protocol (e.g. :py:class:`memoryview` or :py:class:`array.array`)\n\
+   is accepted without copying. Strided, transposed or\n\
+   Fortran-ordered arrays are traversed in memory order.\n\
 \n\
 ");
 
@@ -340,12 +812,13 @@ static PyObject* PyBobLearnActivation_f_prime(PyBobLearnActivationObject* self,
 
     case 1:
       return PyBobLearnActivation_call1
-        (self, &bob::learn::activation::Activation::f_prime, args, kwds);
+        (self, &bob::learn::activation::Activation::f_prime,
+         bob::learn::activation::F_PRIME, args, kwds);
       break;
 
     case 2:
       return PyBobLearnActivation_call2
-        (self, &bob::learn::activation::Activation::f_prime, args, kwds);
+        (self, bob::learn::activation::F_PRIME, args, kwds);
       break;
 
     default:
@@ -379,7 +852,10 @@ error otherwise.\n\
 .. note::\n\
 \n\
    This method only accepts 64-bit float arrays as input or\n\
-   output.\n\
+   output. Besides numpy arrays, any object exporting the buffer\n\
+   protocol (e.g. :py:class:`memoryview` or :py:class:`array.array`)\n\
+   is accepted without copying. Strided, transposed or\n\
+   Fortran-ordered arrays are traversed in memory order.\n\
 \n\
 ");
 
@@ -392,12 +868,13 @@ static PyObject* PyBobLearnActivation_f_prime_from_f
 
     case 1:
       return PyBobLearnActivation_call1
-        (self, &bob::learn::activation::Activation::f_prime_from_f, args, kwds);
+        (self, &bob::learn::activation::Activation::f_prime_from_f,
+         bob::learn::activation::F_PRIME_FROM_F, args, kwds);
       break;
 
     case 2:
       return PyBobLearnActivation_call2
-        (self, &bob::learn::activation::Activation::f_prime_from_f, args, kwds);
+        (self, bob::learn::activation::F_PRIME_FROM_F, args, kwds);
       break;
 
     default:
@@ -410,39 +887,439 @@ static PyObject* PyBobLearnActivation_f_prime_from_f
 
 }
 
-PyDoc_STRVAR(s_unique_id_str, "unique_identifier");
-PyDoc_STRVAR(s_unique_id_doc,
-"o.unique_identifier() -> str\n\
+PyDoc_STRVAR(s_f_second_str, "f_second");
+PyDoc_STRVAR(s_f_second_doc,
+"o.f_second(z, [res]) -> array | scalar\n\
 \n\
-Returns a unique (string) identifier, used by this class\n\
-in connection with the Activation registry.\n\
+Computes the second derivative of the activated value, given an\n\
+input array or scalar ``z``, placing results in ``res`` (and returning\n\
+it).\n\
 \n\
-");
-
-static PyObject* PyBobLearnActivation_UniqueIdentifier
-(PyBobLearnActivationObject* self) {
-  return Py_BuildValue("s", self->cxx->unique_identifier().c_str());
-}
-
-PyDoc_STRVAR(s_load_str, "load");
-PyDoc_STRVAR(s_load_doc,
-"o.load(f) -> None\n\
+If ``z`` is an array, then you can pass another array in ``res``\n\
+to store the results and, in this case, we won't allocate a new\n\
+one for that purpose. This can be a speed-up in certain scenarios.\n\
+Note this does not work for scalars as it makes little sense to\n\
+avoid scalar allocation at this level.\n\
 \n\
-Loads itself from a :py:class:`bob.io.base.HDF5File`\n\
+If you decide to pass an array in ``res``, note this array should\n\
+have the exact same dimensions as the input array ``z``. It is an\n\
+error otherwise.\n\
+\n\
+.. note::\n\
+\n\
+   Functions that do not implement second derivatives raise a\n\
+   :py:exc:`RuntimeError`.\n\
+\n\
+.. note::\n\
+\n\
+   This method only accepts 64-bit float arrays as input or\n\
+   output. Besides numpy arrays, any object exporting the buffer\n\
+   protocol (e.g. :py:class:`memoryview` or :py:class:`array.array`)\n\
+   is accepted without copying. Strided, transposed or\n\
+   Fortran-ordered arrays are traversed in memory order.\n\
 \n\
 ");
 
-static PyObject* PyBobLearnActivation_Load(PyBobLearnActivationObject* self,
-    PyObject* f) {
+static PyObject* PyBobLearnActivation_f_second(PyBobLearnActivationObject* self,
+  PyObject* args, PyObject* kwds) {
 
-  if (!PyBobIoHDF5File_Check(f)) {
-    PyErr_Format(PyExc_TypeError, "`%s' cannot load itself from `%s', only from an HDF5 file", Py_TYPE(self)->tp_name, Py_TYPE(f)->tp_name);
-    return 0;
-  }
+  Py_ssize_t nargs = (args?PyTuple_Size(args):0) + (kwds?PyDict_Size(kwds):0);
 
-  auto h5f = reinterpret_cast<PyBobIoHDF5FileObject*>(f);
+  switch (nargs) {
 
-  try {
+    case 1:
+      return PyBobLearnActivation_call1
+        (self, &bob::learn::activation::Activation::f_second,
+         bob::learn::activation::F_SECOND, args, kwds);
+      break;
+
+    case 2:
+      return PyBobLearnActivation_call2
+        (self, bob::learn::activation::F_SECOND, args, kwds);
+      break;
+
+    default:
+
+      PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - %s requires 1 or 2 arguments, but you provided %" PY_FORMAT_SIZE_T "d (see help)", s_call_str, nargs);
+
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_f_second_from_f_str, "f_second_from_f");
+PyDoc_STRVAR(s_f_second_from_f_doc,
+"o.f_second_from_f(a, [res]) -> array | scalar\n\
+\n\
+Computes the second derivative of the activated value, given the\n\
+activated value ``a``, placing results in ``res`` (and returning\n\
+it).\n\
+\n\
+If ``a`` is an array, then you can pass another array in ``res``\n\
+to store the results and, in this case, we won't allocate a new\n\
+one for that purpose. This can be a speed-up in certain scenarios.\n\
+Note this does not work for scalars as it makes little sense to\n\
+avoid scalar allocation at this level.\n\
+\n\
+If you decide to pass an array in ``res``, note this array should\n\
+have the exact same dimensions as the input array ``a``. It is an\n\
+error otherwise.\n\
+\n\
+.. note::\n\
+\n\
+   Functions that do not implement second derivatives raise a\n\
+   :py:exc:`RuntimeError`.\n\
+\n\
+.. note::\n\
+\n\
+   This method only accepts 64-bit float arrays as input or\n\
+   output. Besides numpy arrays, any object exporting the buffer\n\
+   protocol (e.g. :py:class:`memoryview` or :py:class:`array.array`)\n\
+   is accepted without copying. Strided, transposed or\n\
+   Fortran-ordered arrays are traversed in memory order.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_f_second_from_f
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+
+  Py_ssize_t nargs = (args?PyTuple_Size(args):0) + (kwds?PyDict_Size(kwds):0);
+
+  switch (nargs) {
+
+    case 1:
+      return PyBobLearnActivation_call1
+        (self, &bob::learn::activation::Activation::f_second_from_f,
+         bob::learn::activation::F_SECOND_FROM_F, args, kwds);
+      break;
+
+    case 2:
+      return PyBobLearnActivation_call2
+        (self, bob::learn::activation::F_SECOND_FROM_F, args, kwds);
+      break;
+
+    default:
+
+      PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - %s requires 1 or 2 arguments, but you provided %" PY_FORMAT_SIZE_T "d (see help)", s_call_str, nargs);
+
+  }
+
+  return 0;
+
+}
+
+/**
+ * Python-side state of an asynchronous call. Only touched with the
+ * interpreter lock held, except for ``error``, which is set by the worker.
+ */
+struct AsyncCall {
+  PyObject* future;
+  PyArrayObject* z;
+  PyArrayObject* res;
+  std::string error;
+};
+
+/**
+ * Completes a batch of asynchronous calls under a single acquisition of the
+ * interpreter lock
+ */
+static void complete_in_python
+(const std::vector<bob::learn::activation::Executor::task_t>& done) {
+  PyGILState_STATE state = PyGILState_Ensure();
+  for (auto it = done.begin(); it != done.end(); ++it) (*it)();
+  PyGILState_Release(state);
+}
+
+static void complete_async_call(boost::shared_ptr<AsyncCall> call) {
+
+  PyObject* running = PyObject_CallMethod(call->future,
+      const_cast<char*>("set_running_or_notify_cancel"), 0);
+
+  if (running && PyObject_IsTrue(running)) {
+    PyObject* r = 0;
+    if (call->error.empty()) {
+      r = PyObject_CallMethod(call->future, const_cast<char*>("set_result"),
+          const_cast<char*>("O"), call->res);
+    }
+    else {
+      PyObject* e = PyObject_CallFunction(PyExc_RuntimeError,
+          const_cast<char*>("s"), call->error.c_str());
+      if (e) {
+        r = PyObject_CallMethod(call->future,
+            const_cast<char*>("set_exception"), const_cast<char*>("O"), e);
+        Py_DECREF(e);
+      }
+    }
+    Py_XDECREF(r);
+  }
+
+  Py_XDECREF(running);
+  if (PyErr_Occurred()) PyErr_WriteUnraisable(call->future);
+
+  Py_DECREF(call->future);
+  Py_DECREF(call->z);
+  Py_DECREF(call->res);
+
+}
+
+static bob::learn::activation::Executor* s_executor = 0;
+static pid_t s_executor_pid = 0; ///< of the process that started s_executor
+
+static PyObject* shutdown_executor(PyObject*, PyObject*) {
+  if (s_executor && s_executor_pid == getpid()) {
+    // pending completions need the interpreter lock
+    Py_BEGIN_ALLOW_THREADS
+    s_executor->shutdown();
+    Py_END_ALLOW_THREADS
+  }
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef s_shutdown_executor = {
+  "_shutdown_executor",
+  (PyCFunction)shutdown_executor,
+  METH_NOARGS,
+  "Completes pending asynchronous calls and stops the background executor"
+};
+
+/**
+ * Returns the executor for asynchronous calls, creating it on first use, and
+ * again in processes forked since
+ */
+static bob::learn::activation::Executor* executor() {
+
+  if (s_executor && s_executor_pid == getpid()) return s_executor;
+
+  if (s_executor) {
+    // forked: the worker thread did not follow, and the state of the
+    // executor, locks included, is unusable, so it is left alone (leaked)
+    s_executor = new bob::learn::activation::Executor(&complete_in_python);
+    s_executor_pid = getpid();
+    return s_executor;
+  }
+
+# if PY_VERSION_HEX < 0x03070000
+  PyEval_InitThreads();
+# endif
+
+  // pending calls must complete before the interpreter goes away
+  PyObject* atexit = PyImport_ImportModule("atexit");
+  if (!atexit) return 0;
+  auto atexit_ = make_safe(atexit);
+  PyObject* shutdown = PyCFunction_New(&s_shutdown_executor, 0);
+  if (!shutdown) return 0;
+  auto shutdown_ = make_safe(shutdown);
+  PyObject* r = PyObject_CallMethod(atexit, const_cast<char*>("register"),
+      const_cast<char*>("O"), shutdown);
+  if (!r) return 0;
+  Py_DECREF(r);
+
+  s_executor = new bob::learn::activation::Executor(&complete_in_python);
+  s_executor_pid = getpid();
+  return s_executor;
+
+}
+
+/**
+ * Returns a new (pending) bob.learn.activation.Future
+ */
+static PyObject* new_future() {
+  PyObject* module = PyImport_ImportModule(BOB_EXT_MODULE_PREFIX);
+  if (!module) return 0;
+  auto module_ = make_safe(module);
+  PyObject* type = PyObject_GetAttrString(module, "Future");
+  if (!type) return 0;
+  auto type_ = make_safe(type);
+  return PyObject_CallObject(type, 0);
+}
+
+static PyObject* PyBobLearnActivation_call_async
+(PyBobLearnActivationObject* self, scalar_method_t method,
+ bob::learn::activation::Method batch, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"z", "res", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* z_object = 0;
+  PyObject* res_object = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist,
+        &z_object, &res_object)) return 0;
+
+  PyObject* future = new_future();
+  if (!future) return 0;
+  auto future_ = make_safe(future);
+
+  if (PyBob_NumberCheck(z_object) && !res_object) {
+    // not worth a trip to the executor
+    PyObject* z_float = PyNumber_Float(z_object);
+    if (!z_float) return 0;
+    auto z_float_ = make_safe(z_float);
+    PyObject* res = 0;
+    try {
+      bob::learn::activation::CallTimer timer(*self->cxx, batch, bob::learn::activation::SCALAR, 1);
+      res = PyFloat_FromDouble(((*self->cxx).*method)(PyFloat_AsDouble(z_float)));
+    }
+    catch (std::exception& e) {
+      PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
+    if (!res) return 0;
+    auto res_ = make_safe(res);
+    PyObject* r = PyObject_CallMethod(future, const_cast<char*>("set_result"),
+        const_cast<char*>("O"), res);
+    if (!r) return 0;
+    Py_DECREF(r);
+    return Py_BuildValue("O", future);
+  }
+
+  if (!is_array(z_object)) {
+    PyErr_Format(PyExc_TypeError, "`%s' is not capable to process input objects of type `%s'", Py_TYPE(self)->tp_name, Py_TYPE(z_object)->tp_name);
+    return 0;
+  }
+
+  PyArrayObject* z = 0;
+  PyArrayObject* res = 0;
+  if (!prepare_arrays(self, z_object, res_object, &z, &res)) return 0;
+
+  bob::learn::activation::Executor* pool = executor();
+  if (!pool) {
+    Py_DECREF(z);
+    Py_DECREF(res);
+    return 0;
+  }
+
+  // the call owns these references until it completes
+  boost::shared_ptr<AsyncCall> call(new AsyncCall);
+  call->future = future;
+  Py_INCREF(future);
+  call->z = z;
+  call->res = res;
+
+  boost::shared_ptr<bob::learn::activation::Activation> activation = self->cxx;
+
+  auto work = [call, activation, batch]() {
+    try {
+      bob::learn::activation::CallTimer timer(*activation, batch, bob::learn::activation::PARALLEL, PyArray_SIZE(call->z));
+      if (!apply(*activation, batch, call->z, call->res))
+        call->error = "unexpected error occurred applying activation to input array (DEBUG ME)";
+    }
+    catch (std::exception& e) {
+      call->error = e.what();
+    }
+    catch (...) {
+      call->error = "unknown exception caught while applying activation";
+    }
+  };
+
+  try {
+    pool->submit(work, boost::bind(&complete_async_call, call));
+  }
+  catch (std::exception& e) {
+    Py_DECREF(call->future);
+    Py_DECREF(call->z);
+    Py_DECREF(call->res);
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+    return 0;
+  }
+
+  return Py_BuildValue("O", future);
+
+}
+
+PyDoc_STRVAR(s_f_async_str, "f_async");
+PyDoc_STRVAR(s_f_async_doc,
+"o.f_async(z, [res]) -> bob.learn.activation.Future\n\
+\n\
+Same as :py:meth:`f`, but computed on a background thread.\n\
+\n\
+Returns immediately with a :py:class:`Future`, which is a\n\
+:py:class:`concurrent.futures.Future` that can also be awaited\n\
+from :py:mod:`asyncio` coroutines. Its result is the output\n\
+array (``res``, if given). Completion is signalled by the\n\
+background thread itself, no polling is involved. Queued calls\n\
+are picked up in batches, so that many small calls share\n\
+thread wake-ups and interpreter lock acquisitions.\n\
+\n\
+Arrays ``z`` and ``res`` must not be modified (or read, for\n\
+``res``) until the future is done. Scalars are computed right\n\
+away and returned in a completed future.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_f_async
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+  return PyBobLearnActivation_call_async(self,
+      &bob::learn::activation::Activation::f,
+      bob::learn::activation::F, args, kwds);
+}
+
+PyDoc_STRVAR(s_f_prime_async_str, "f_prime_async");
+PyDoc_STRVAR(s_f_prime_async_doc,
+"o.f_prime_async(z, [res]) -> bob.learn.activation.Future\n\
+\n\
+Same as :py:meth:`f_prime`, but computed on a background thread.\n\
+See :py:meth:`f_async` for details.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_f_prime_async
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+  return PyBobLearnActivation_call_async(self,
+      &bob::learn::activation::Activation::f_prime,
+      bob::learn::activation::F_PRIME, args, kwds);
+}
+
+PyDoc_STRVAR(s_f_prime_from_f_async_str, "f_prime_from_f_async");
+PyDoc_STRVAR(s_f_prime_from_f_async_doc,
+"o.f_prime_from_f_async(a, [res]) -> bob.learn.activation.Future\n\
+\n\
+Same as :py:meth:`f_prime_from_f`, but computed on a background\n\
+thread. See :py:meth:`f_async` for details.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_f_prime_from_f_async
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+  return PyBobLearnActivation_call_async(self,
+      &bob::learn::activation::Activation::f_prime_from_f,
+      bob::learn::activation::F_PRIME_FROM_F, args, kwds);
+}
+
+PyDoc_STRVAR(s_unique_id_str, "unique_identifier");
+PyDoc_STRVAR(s_unique_id_doc,
+"o.unique_identifier() -> str\n\
+\n\
+Returns a unique (string) identifier, used by this class\n\
+in connection with the Activation registry.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_UniqueIdentifier
+(PyBobLearnActivationObject* self) {
+  return Py_BuildValue("s", self->cxx->unique_identifier().c_str());
+}
+
+PyDoc_STRVAR(s_load_str, "load");
+PyDoc_STRVAR(s_load_doc,
+"o.load(f) -> None\n\
+\n\
+Loads itself from a :py:class:`bob.io.base.HDF5File`\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_Load(PyBobLearnActivationObject* self,
+    PyObject* f) {
+
+  if (!PyBobIoHDF5File_Check(f)) {
+    PyErr_Format(PyExc_TypeError, "`%s' cannot load itself from `%s', only from an HDF5 file", Py_TYPE(self)->tp_name, Py_TYPE(f)->tp_name);
+    return 0;
+  }
+
+  auto h5f = reinterpret_cast<PyBobIoHDF5FileObject*>(f);
+
+  try {
     self->cxx->load(*h5f->f);
   }
   catch (std::exception& e) {
@@ -492,6 +1369,544 @@ static PyObject* PyBobLearnActivation_Save
   Py_RETURN_NONE;
 }
 
+/**
+ * Converts a method name ("f", "f_prime", "f_prime_from_f", "f_second" or
+ * "f_second_from_f") into the corresponding bob::learn::activation::Method
+ */
+static int method_converter(PyObject* o, bob::learn::activation::Method* m) {
+
+  PyObject* str = PyObject_Str(o);
+  if (!str) return 0;
+  auto str_ = make_safe(str);
+
+# if PY_VERSION_HEX >= 0x03000000
+  const char* name = PyUnicode_AsUTF8(str);
+# else
+  const char* name = PyString_AsString(str);
+# endif
+  if (!name) return 0;
+
+  if (std::string(name) == "f") *m = bob::learn::activation::F;
+  else if (std::string(name) == "f_prime") *m = bob::learn::activation::F_PRIME;
+  else if (std::string(name) == "f_prime_from_f") *m = bob::learn::activation::F_PRIME_FROM_F;
+  else if (std::string(name) == "f_second") *m = bob::learn::activation::F_SECOND;
+  else if (std::string(name) == "f_second_from_f") *m = bob::learn::activation::F_SECOND_FROM_F;
+  else {
+    PyErr_Format(PyExc_ValueError, "method must be one of `f', `f_prime', `f_prime_from_f', `f_second' or `f_second_from_f', not `%s'", name);
+    return 0;
+  }
+
+  return 1;
+
+}
+
+PyDoc_STRVAR(s_stream_hdf5_str, "stream_hdf5");
+PyDoc_STRVAR(s_stream_hdf5_doc,
+"o.stream_hdf5(input, input_path, output, output_path, [method='f', [limit=268435456]]) -> None\n\
+\n\
+Applies one of the methods of this activation to a dataset of\n\
+a :py:class:`bob.io.base.HDF5File`, writing results to a new\n\
+dataset of another (or the same) file, without loading the\n\
+whole dataset into memory.\n\
+\n\
+Keyword parameters:\n\
+\n\
+input\n\
+  The :py:class:`bob.io.base.HDF5File` to read from\n\
+\n\
+input_path\n\
+  The path to a 64-bit float, 1, 2, 3 or 4-dimensional dataset\n\
+  inside ``input``\n\
+\n\
+output\n\
+  The :py:class:`bob.io.base.HDF5File` to write to\n\
+\n\
+output_path\n\
+  The path of the dataset to create inside ``output``. It is an\n\
+  error if it already exists.\n\
+\n\
+method\n\
+  One of ``'f'``, ``'f_prime'``, ``'f_prime_from_f'``,\n\
+  ``'f_second'`` or ``'f_second_from_f'``\n\
+\n\
+limit\n\
+  The largest size, in bytes, of non-expandable datasets, which\n\
+  are loaded whole\n\
+\n\
+Expandable datasets (e.g. those created with\n\
+:py:meth:`bob.io.base.HDF5File.append`) are streamed one entry at\n\
+a time, overlapping reading, computing and writing with double\n\
+buffering, so only a few entries are resident at any time. Other\n\
+datasets can only be read and written whole: they are processed in\n\
+a single step if they hold at most ``limit`` bytes, and rejected\n\
+otherwise. Store large matrices as expandable datasets, e.g. by\n\
+appending their rows, to stream them.\n\
+\n\
+.. note::\n\
+\n\
+   The Python interpreter lock is released while streaming. Do\n\
+   not use either file from other threads during this call.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_StreamHDF5
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"input", "input_path", "output", "output_path", "method", "limit", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* input = 0;
+  const char* input_path = 0;
+  PyObject* output = 0;
+  const char* output_path = 0;
+  bob::learn::activation::Method method = bob::learn::activation::F;
+  Py_ssize_t limit = 1 << 28;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OsOs|O&n", kwlist,
+        &input, &input_path, &output, &output_path,
+        &method_converter, &method, &limit)) return 0;
+
+  if (limit < 0) {
+    PyErr_Format(PyExc_ValueError, "`%s' limit of whole datasets must not be negative", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  if (!PyBobIoHDF5File_Check(input) || !PyBobIoHDF5File_Check(output)) {
+    PyErr_Format(PyExc_TypeError, "`%s' can only stream from and to HDF5 files", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  auto in = reinterpret_cast<PyBobIoHDF5FileObject*>(input);
+  auto out = reinterpret_cast<PyBobIoHDF5FileObject*>(output);
+
+  // exceptions must not cross the block that releases the interpreter lock
+  std::string error;
+
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    bob::learn::activation::stream_hdf5(*self->cxx, method,
+        *in->f, input_path, *out->f, output_path, limit);
+  }
+  catch (std::exception& e) {
+    error = e.what();
+  }
+  catch (...) {
+    error = "unknown exception caught";
+  }
+  Py_END_ALLOW_THREADS
+
+  if (!error.empty()) {
+    PyErr_Format(PyExc_RuntimeError, "cannot stream dataset `%s' from file `%s': %s", input_path, in->f->filename().c_str(), error.c_str());
+    return 0;
+  }
+
+  Py_RETURN_NONE;
+}
+
+/**
+ * Tells if ``o`` is a numpy.memmap whose pages may be dropped after use,
+ * i.e., one backed by a shared file mapping (or, for inputs, by a read-only
+ * one). Returns -1 on errors.
+ */
+static int is_releasable_memmap(PyObject* o, bool output) {
+
+  static PyObject* memmap = 0;
+  if (!memmap) {
+    PyObject* numpy = PyImport_ImportModule("numpy");
+    if (!numpy) return -1;
+    memmap = PyObject_GetAttrString(numpy, "memmap");
+    Py_DECREF(numpy);
+    if (!memmap) return -1;
+  }
+
+  int check = PyObject_IsInstance(o, memmap);
+  if (check <= 0) return check;
+
+  PyObject* mode = PyObject_GetAttrString(o, "mode");
+  if (!mode) return -1;
+  auto mode_ = make_safe(mode);
+
+# if PY_VERSION_HEX >= 0x03000000
+  const char* m_ = PyUnicode_Check(mode) ? PyUnicode_AsUTF8(mode) : 0;
+# else
+  const char* m_ = PyString_Check(mode) ? PyString_AsString(mode) : 0;
+# endif
+  if (!m_) return 0;
+  std::string m(m_);
+  if (m == "r+" || m == "w+") return 1;
+  if (m == "r" && !output) return 1;
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_stream_mapped_str, "stream_mapped");
+PyDoc_STRVAR(s_stream_mapped_doc,
+"o.stream_mapped(z, res, [method='f', [tile=0]]) -> array\n\
+\n\
+Applies one of the methods of this activation to ``z``, placing\n\
+results in ``res`` (and returning it), tile by tile. This is\n\
+meant for large inputs and outputs backed by files, such as\n\
+:py:class:`numpy.memmap` arrays.\n\
+\n\
+Keyword parameters:\n\
+\n\
+z\n\
+  The input array\n\
+\n\
+res\n\
+  The output array, with the same shape as ``z``\n\
+\n\
+method\n\
+  One of ``'f'``, ``'f_prime'``, ``'f_prime_from_f'``,\n\
+  ``'f_second'`` or ``'f_second_from_f'``\n\
+\n\
+tile\n\
+  The number of elements per tile. If zero (the default), tiles\n\
+  of 4 MiB are used.\n\
+\n\
+While a tile is computed, the operating system is advised to read\n\
+ahead the next tile of both arrays. When ``z`` or ``res`` is a\n\
+:py:class:`numpy.memmap` opened in mode ``'r'`` (for ``z`` only),\n\
+``'r+'`` or ``'w+'``, pages of finished tiles are then dropped from\n\
+the process, keeping its resident memory bounded. Data of\n\
+``res`` is not lost, it remains in the file cache until written\n\
+back.\n\
+\n\
+Both arrays must be C-contiguous for tiling to take place. Other\n\
+arrays are processed as with the regular methods.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_StreamMapped
+(PyBobLearnActivationObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"z", "res", "method", "tile", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* z_object = 0;
+  PyObject* res_object = 0;
+  bob::learn::activation::Method method = bob::learn::activation::F;
+  Py_ssize_t tile = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|O&n", kwlist,
+        &z_object, &res_object, &method_converter, &method, &tile)) return 0;
+
+  if (tile < 0) {
+    PyErr_Format(PyExc_ValueError, "`%s' tile size must be positive (or zero, for the default)", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  PyArrayObject* z = 0;
+  PyArrayObject* res = 0;
+  if (!prepare_arrays(self, z_object, res_object, &z, &res)) return 0;
+  auto z_ = make_safe(z);
+  auto res_ = make_safe(res);
+
+  if (!PyArray_IS_C_CONTIGUOUS(z) || !PyArray_IS_C_CONTIGUOUS(res)) {
+    if (!checked_apply(self, method, z, res)) return 0;
+    return Py_BuildValue("O", res);
+  }
+
+  int release_input = is_releasable_memmap(z_object, false);
+  if (release_input < 0) return 0;
+  int release_output = is_releasable_memmap(res_object, true);
+  if (release_output < 0) return 0;
+
+  const double* zp = reinterpret_cast<const double*>(PyArray_DATA(z));
+  double* rp = reinterpret_cast<double*>(PyArray_DATA(res));
+  std::size_t n = PyArray_SIZE(z);
+
+  Py_BEGIN_ALLOW_THREADS
+  bob::learn::activation::stream_mapped(*self->cxx, method, zp, rp, n,
+      tile, release_input, release_output);
+  Py_END_ALLOW_THREADS
+
+  return Py_BuildValue("O", res);
+}
+
+PyDoc_STRVAR(s_getstate_str, "__getstate__");
+PyDoc_STRVAR(s_getstate_doc,
+"o.__getstate__() -> bytes\n\
+\n\
+Returns the state of this function as a compact byte string, the\n\
+same returned by :py:func:`dumps` for this function alone. It is\n\
+used for pickling, e.g., to send activation functions to\n\
+:py:mod:`multiprocessing` workers.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_GetState
+(PyBobLearnActivationObject* self) {
+
+  try {
+    std::vector<boost::shared_ptr<bob::learn::activation::Activation> > v(1, self->cxx);
+    std::string data = bob::learn::activation::save_compact(v);
+    return PyBytes_FromStringAndSize(data.data(), data.size());
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot get the state of `%s': unknown exception caught", Py_TYPE(self)->tp_name);
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_reduce_str, "__reduce__");
+PyDoc_STRVAR(s_reduce_doc,
+"o.__reduce__() -> tuple\n\
+\n\
+Pickling support, through the compact state returned by\n\
+:py:meth:`__getstate__`.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_Reduce
+(PyBobLearnActivationObject* self) {
+
+  PyObject* module = PyImport_ImportModule(BOB_EXT_MODULE_PREFIX "." BOB_EXT_MODULE_NAME);
+  if (!module) return 0;
+  auto module_ = make_safe(module);
+
+  PyObject* unpickle = PyObject_GetAttrString(module, "_unpickle");
+  if (!unpickle) return 0;
+  auto unpickle_ = make_safe(unpickle);
+
+  PyObject* state = PyBobLearnActivation_GetState(self);
+  if (!state) return 0;
+
+  return Py_BuildValue("O(N)", unpickle, state);
+
+}
+
+PyDoc_STRVAR(s_copy_str, "__copy__");
+PyDoc_STRVAR(s_copy_doc,
+"o.__copy__() -> Activation\n\
+\n\
+Returns an independent copy of this function.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_Copy
+(PyBobLearnActivationObject* self, PyObject* = 0) {
+
+  try {
+    return PyBobLearnActivation_NewFromActivation(self->cxx->clone());
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot copy `%s': unknown exception caught", Py_TYPE(self)->tp_name);
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_deepcopy_str, "__deepcopy__");
+PyDoc_STRVAR(s_deepcopy_doc,
+"o.__deepcopy__(memo) -> Activation\n\
+\n\
+Returns an independent copy of this function, like\n\
+:py:meth:`__copy__` (activation functions hold no other objects).\n\
+\n\
+");
+
+static const char* const s_counted_methods[] = {"f", "f_prime",
+  "f_prime_from_f", "f_second", "f_second_from_f"};
+static const char* const s_counted_paths[] = {"scalar", "serial", "parallel"};
+
+PyObject* PyBobLearnActivation_BuildCounters
+(const bob::learn::activation::Counters& counters) {
+
+  PyObject* retval = PyDict_New();
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  for (std::size_t m=0; m<bob::learn::activation::COUNTED_METHODS; ++m) {
+    PyObject* paths = 0;
+    for (std::size_t p=0; p<bob::learn::activation::COUNTED_PATHS; ++p) {
+      bob::learn::activation::CallStatistics c = counters.get(
+          (bob::learn::activation::Method)m, (bob::learn::activation::Path)p);
+      if (!c.calls) continue;
+
+      if (!paths) {
+        paths = PyDict_New();
+        if (!paths) return 0;
+        int r = PyDict_SetItemString(retval, s_counted_methods[m], paths);
+        Py_DECREF(paths); //owned by retval
+        if (r < 0) return 0;
+      }
+
+      PyObject* histogram = PyList_New(bob::learn::activation::LATENCY_BUCKETS);
+      if (!histogram) return 0;
+      auto histogram_ = make_safe(histogram);
+      for (std::size_t k=0; k<bob::learn::activation::LATENCY_BUCKETS; ++k) {
+        PyObject* v = PyLong_FromUnsignedLongLong(c.histogram[k]);
+        if (!v) return 0;
+        PyList_SET_ITEM(histogram, k, v);
+      }
+
+      PyObject* entry = Py_BuildValue("{s:K,s:K,s:K,s:K,s:O}",
+          "calls", (unsigned long long)c.calls,
+          "elements", (unsigned long long)c.elements,
+          "bytes", (unsigned long long)c.bytes,
+          "nanoseconds", (unsigned long long)c.nanoseconds,
+          "histogram", histogram);
+      if (!entry) return 0;
+      auto entry_ = make_safe(entry);
+      if (PyDict_SetItemString(paths, s_counted_paths[p], entry) < 0) return 0;
+    }
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyDoc_STRVAR(s_stats_str, "stats");
+PyDoc_STRVAR(s_stats_doc,
+"o.stats() -> dict\n\
+\n\
+Returns the counters of the evaluations of this function, made while\n\
+counting was on (see :py:func:`set_counting`), by method (``'f'``,\n\
+``'f_prime'``, ...) and path: ``'scalar'`` for single values,\n\
+``'serial'`` for arrays evaluated in the calling thread and\n\
+``'parallel'`` for arrays evaluated in other threads, e.g. by\n\
+:py:meth:`f_async`. Only methods and paths used appear.\n\
+\n\
+Each entry holds the number of ``calls``, the ``elements`` computed,\n\
+the ``bytes`` read and written, the total time spent, in\n\
+``nanoseconds``, and a latency ``histogram``, whose entry ``k``\n\
+counts the calls that took from 2^k to 2^(k+1) nanoseconds (the\n\
+last one, also longer ones).\n\
+\n\
+Functions shared by interning (see :py:func:`intern`) share their\n\
+counters; copies start from zero.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_Stats(PyBobLearnActivationObject* self) {
+  return PyBobLearnActivation_BuildCounters(self->cxx->counters());
+}
+
+PyDoc_STRVAR(s_reset_stats_str, "reset_stats");
+PyDoc_STRVAR(s_reset_stats_doc,
+"o.reset_stats() -> None\n\
+\n\
+Sets the counters returned by :py:meth:`stats` to zero\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_ResetStats(PyBobLearnActivationObject* self) {
+  self->cxx->counters().reset();
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(s_set_cache_str, "set_cache");
+PyDoc_STRVAR(s_set_cache_doc,
+"o.set_cache(entries, [bytes=67108864]) -> None\n\
+\n\
+Caches the results of this function for its latest ``entries``\n\
+distinct inputs, keeping at most ``bytes`` bytes of inputs and\n\
+results, or stops caching, if ``entries`` is 0 (the default). Any\n\
+results cached before are dropped.\n\
+\n\
+Only arrays evaluated by :py:meth:`f`, :py:meth:`f_prime`,\n\
+:py:meth:`f_prime_from_f`, :py:meth:`f_second` and\n\
+:py:meth:`f_second_from_f`, without an output array, are cached, and\n\
+only if they hold 64-bit floats, contiguously in C order. Inputs are\n\
+found by a fast hash of their contents, shape and method, then\n\
+compared in full. Results found are returned as **read-only** arrays\n\
+sharing the memory of the cache; copy them to change them. They\n\
+count as serial evaluations in :py:meth:`stats`, and are traced with\n\
+the variant ``cached`` (see :py:func:`set_tracing`).\n\
+\n\
+Functions shared by interning (see :py:func:`intern`) share their\n\
+cache; copies do not cache, unless set to.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_SetCache(PyBobLearnActivationObject* self,
+    PyObject* args, PyObject* kwds) {
+
+  static const char* const_kwlist[] = {"entries", "bytes", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t entries = 0;
+  Py_ssize_t bytes = 1 << 26;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n|n", kwlist, &entries, &bytes)) return 0;
+
+  if (entries < 0 || bytes < 0) {
+    PyErr_Format(PyExc_ValueError, "`%s' cache limits must not be negative", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  boost::shared_ptr<bob::learn::activation::ResultCache> cache;
+  if (entries) cache.reset(new bob::learn::activation::ResultCache(entries, bytes));
+  self->cxx->set_result_cache(cache);
+  Py_RETURN_NONE;
+
+}
+
+PyDoc_STRVAR(s_cache_stats_str, "cache_stats");
+PyDoc_STRVAR(s_cache_stats_doc,
+"o.cache_stats() -> dict | None\n\
+\n\
+Returns the counters of the cache set by :py:meth:`set_cache`, or\n\
+``None`` if there is none: the number of look-ups that found their\n\
+result (``hits``) and of those that did not (``misses``), the\n\
+fraction of hits (``hit_rate``), the misses on inputs hashing like a\n\
+cached one (``collisions``), the results dropped to make room\n\
+(``evictions``), the results cached (``entries``) and their size,\n\
+with that of their inputs (``bytes``), along with the limits set\n\
+(``max_entries`` and ``max_bytes``).\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_CacheStats(PyBobLearnActivationObject* self) {
+
+  boost::shared_ptr<bob::learn::activation::ResultCache> cache =
+    self->cxx->result_cache();
+  if (!cache) Py_RETURN_NONE;
+
+  bob::learn::activation::ResultCacheStatistics st = cache->statistics();
+  uint64_t lookups = st.hits + st.misses;
+
+  return Py_BuildValue("{s:K,s:K,s:d,s:K,s:K,s:n,s:n,s:n,s:n}",
+      "hits", (unsigned long long)st.hits,
+      "misses", (unsigned long long)st.misses,
+      "hit_rate", lookups ? double(st.hits) / lookups : 0.,
+      "collisions", (unsigned long long)st.collisions,
+      "evictions", (unsigned long long)st.evictions,
+      "entries", (Py_ssize_t)st.entries,
+      "bytes", (Py_ssize_t)st.bytes,
+      "max_entries", (Py_ssize_t)cache->max_entries(),
+      "max_bytes", (Py_ssize_t)cache->max_bytes());
+
+}
+
+PyDoc_STRVAR(s_clear_cache_str, "clear_cache");
+PyDoc_STRVAR(s_clear_cache_doc,
+"o.clear_cache() -> None\n\
+\n\
+Drops the results cached (see :py:meth:`set_cache`), keeping the\n\
+counters of :py:meth:`cache_stats`\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivation_ClearCache(PyBobLearnActivationObject* self) {
+  boost::shared_ptr<bob::learn::activation::ResultCache> cache =
+    self->cxx->result_cache();
+  if (cache) cache->clear();
+  Py_RETURN_NONE;
+}
+
 static PyMethodDef PyBobLearnActivation_methods[] = {
   {
     s_call_str,
@@ -511,6 +1926,66 @@ static PyMethodDef PyBobLearnActivation_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     s_f_prime_from_f_doc
   },
+  {
+    s_stats_str,
+    (PyCFunction)PyBobLearnActivation_Stats,
+    METH_NOARGS,
+    s_stats_doc
+  },
+  {
+    s_reset_stats_str,
+    (PyCFunction)PyBobLearnActivation_ResetStats,
+    METH_NOARGS,
+    s_reset_stats_doc
+  },
+  {
+    s_set_cache_str,
+    (PyCFunction)PyBobLearnActivation_SetCache,
+    METH_VARARGS|METH_KEYWORDS,
+    s_set_cache_doc
+  },
+  {
+    s_cache_stats_str,
+    (PyCFunction)PyBobLearnActivation_CacheStats,
+    METH_NOARGS,
+    s_cache_stats_doc
+  },
+  {
+    s_clear_cache_str,
+    (PyCFunction)PyBobLearnActivation_ClearCache,
+    METH_NOARGS,
+    s_clear_cache_doc
+  },
+  {
+    s_f_second_str,
+    (PyCFunction)PyBobLearnActivation_f_second,
+    METH_VARARGS|METH_KEYWORDS,
+    s_f_second_doc
+  },
+  {
+    s_f_second_from_f_str,
+    (PyCFunction)PyBobLearnActivation_f_second_from_f,
+    METH_VARARGS|METH_KEYWORDS,
+    s_f_second_from_f_doc
+  },
+  {
+    s_f_async_str,
+    (PyCFunction)PyBobLearnActivation_f_async,
+    METH_VARARGS|METH_KEYWORDS,
+    s_f_async_doc
+  },
+  {
+    s_f_prime_async_str,
+    (PyCFunction)PyBobLearnActivation_f_prime_async,
+    METH_VARARGS|METH_KEYWORDS,
+    s_f_prime_async_doc
+  },
+  {
+    s_f_prime_from_f_async_str,
+    (PyCFunction)PyBobLearnActivation_f_prime_from_f_async,
+    METH_VARARGS|METH_KEYWORDS,
+    s_f_prime_from_f_async_doc
+  },
   {
     s_unique_id_str,
     (PyCFunction)PyBobLearnActivation_UniqueIdentifier,
@@ -529,6 +2004,42 @@ static PyMethodDef PyBobLearnActivation_methods[] = {
     METH_O,
     s_save_doc
   },
+  {
+    s_stream_hdf5_str,
+    (PyCFunction)PyBobLearnActivation_StreamHDF5,
+    METH_VARARGS|METH_KEYWORDS,
+    s_stream_hdf5_doc
+  },
+  {
+    s_stream_mapped_str,
+    (PyCFunction)PyBobLearnActivation_StreamMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    s_stream_mapped_doc
+  },
+  {
+    s_getstate_str,
+    (PyCFunction)PyBobLearnActivation_GetState,
+    METH_NOARGS,
+    s_getstate_doc
+  },
+  {
+    s_reduce_str,
+    (PyCFunction)PyBobLearnActivation_Reduce,
+    METH_NOARGS,
+    s_reduce_doc
+  },
+  {
+    s_copy_str,
+    (PyCFunction)PyBobLearnActivation_Copy,
+    METH_NOARGS,
+    s_copy_doc
+  },
+  {
+    s_deepcopy_str,
+    (PyCFunction)PyBobLearnActivation_Copy,
+    METH_O,
+    s_deepcopy_doc
+  },
   {0} /* Sentinel */
 };
 
@@ -538,28 +2049,40 @@ int PyBobLearnActivation_Check(PyObject* o) {
 
 static PyObject* PyBobLearnActivation_RichCompare (PyBobLearnActivationObject* self, PyObject* other, int op) {
 
-  if (!PyBobLearnActivation_Check(other)) {
-    PyErr_Format(PyExc_TypeError, "cannot compare `%s' with `%s'",
-        Py_TYPE(self)->tp_name, Py_TYPE(other)->tp_name);
-    return 0;
+  if (!PyBobLearnActivation_Check(other) || (op != Py_EQ && op != Py_NE)) {
+    Py_INCREF(Py_NotImplemented);
+    return Py_NotImplemented;
   }
 
   auto other_ = reinterpret_cast<PyBobLearnActivationObject*>(other);
 
-  switch (op) {
-    case Py_EQ:
-      if (self->cxx->str() == other_->cxx->str()) Py_RETURN_TRUE;
-      Py_RETURN_FALSE;
-      break;
-    case Py_NE:
-      if (self->cxx->str() != other_->cxx->str()) Py_RETURN_TRUE;
-      Py_RETURN_FALSE;
-      break;
-    default:
-      Py_INCREF(Py_NotImplemented);
-      return Py_NotImplemented;
+  if (!self->cxx || !other_->cxx) {
+    PyErr_SetString(PyExc_TypeError, "cannot compare uninitialized activation functions");
+    return 0;
+  }
+
+  bool equal = self->cxx->equals(*other_->cxx);
+  if (equal == (op == Py_EQ)) Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+
+}
+
+#if PY_VERSION_HEX >= 0x03000000
+typedef Py_hash_t hash_t;
+#else
+typedef long hash_t;
+#endif
+
+static hash_t PyBobLearnActivation_Hash (PyBobLearnActivationObject* self) {
+
+  if (!self->cxx) {
+    PyErr_SetString(PyExc_TypeError, "cannot hash an uninitialized activation function");
+    return -1;
   }
 
+  hash_t retval = (hash_t)self->cxx->hash();
+  return (retval == -1) ? -2 : retval;
+
 }
 
 static PyObject* PyBobLearnActivation_Str (PyBobLearnActivationObject* self) {
@@ -580,7 +2103,7 @@ PyTypeObject PyBobLearnActivation_Type = {
     0,                                              /* tp_as_number */
     0,                                              /* tp_as_sequence */
     0,                                              /* tp_as_mapping */
-    0,                                              /* tp_hash */
+    (hashfunc)PyBobLearnActivation_Hash,            /* tp_hash */
     (ternaryfunc)PyBobLearnActivation_call,         /* tp_call */
     (reprfunc)PyBobLearnActivation_Str,             /* tp_str */
     0,                                              /* tp_getattro */
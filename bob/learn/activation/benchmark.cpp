@@ -0,0 +1,337 @@
+/**
+ * @date Sun 18 Oct 2026 10:12:47 CEST
+ *
+ * @brief Micro-benchmarks for the C++ kernels of the built-in activation
+ * functions, driven by bob_learn_activation_benchmark.py
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <Python.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.learn.activation/config.h>
+#include <bob.learn.activation/Activation.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BOB_LEARN_ACTIVATION_HAVE_TSC 1
+#endif
+
+/**
+ * The functions measured, by name
+ */
+static std::vector<std::pair<std::string, boost::shared_ptr<bob::learn::activation::Activation> > > builtin_activations() {
+  std::vector<std::pair<std::string, boost::shared_ptr<bob::learn::activation::Activation> > > retval;
+  retval.push_back(std::make_pair("Identity", boost::make_shared<bob::learn::activation::IdentityActivation>()));
+  retval.push_back(std::make_pair("Linear", boost::make_shared<bob::learn::activation::LinearActivation>(2.)));
+  retval.push_back(std::make_pair("Logistic", boost::make_shared<bob::learn::activation::LogisticActivation>()));
+  retval.push_back(std::make_pair("HyperbolicTangent", boost::make_shared<bob::learn::activation::HyperbolicTangentActivation>()));
+  retval.push_back(std::make_pair("MultipliedHyperbolicTangent", boost::make_shared<bob::learn::activation::MultipliedHyperbolicTangentActivation>(1.7159, 2./3.)));
+  return retval;
+}
+
+static const char* const method_names[] = {"f", "f_prime", "f_prime_from_f"};
+static const bob::learn::activation::Method methods[] = {
+  bob::learn::activation::F,
+  bob::learn::activation::F_PRIME,
+  bob::learn::activation::F_PRIME_FROM_F
+};
+static const std::size_t METHODS = sizeof(methods) / sizeof(methods[0]);
+
+static inline unsigned long long cycles() {
+#ifdef BOB_LEARN_ACTIVATION_HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * An input and an output array of a given shape, whose innermost dimension
+ * is either contiguous or visits every other element of its buffer
+ */
+struct Layout {
+
+  Layout(const std::vector<Py_ssize_t>& shape, bool strided):
+    shape(shape), stride(shape.size())
+  {
+    std::ptrdiff_t step = strided ? 2 : 1;
+    for (std::size_t k=shape.size(); k-->0;) {
+      stride[k] = step;
+      step *= shape[k];
+    }
+    z.resize(step);
+    a.resize(step);
+    // values in the useful range of every function, including f_prime_from_f
+    for (std::size_t k=0; k<z.size(); ++k) z[k] = 0.5 * ((double)(k % 997) / 997. - 0.5);
+  }
+
+  std::vector<Py_ssize_t> shape;
+  std::vector<std::ptrdiff_t> stride; ///< in elements
+  std::vector<double> z;
+  std::vector<double> a;
+
+};
+
+/**
+ * Applies @c m to the entries [begin, end) of the outermost dimension of the
+ * arrays in @c l. Dimensions are not collapsed, as f() does for contiguous
+ * arrays, so that the cost of each call on the innermost dimension shows.
+ */
+static void run(const bob::learn::activation::Activation& activation,
+    bob::learn::activation::Method m, Layout& l, Py_ssize_t begin, Py_ssize_t end) {
+
+  Py_ssize_t n[4] = {1, 1, 1, 1};
+  std::ptrdiff_t s[4] = {0, 0, 0, 0};
+  std::size_t offset = 4 - l.shape.size();
+  for (std::size_t k=0; k<l.shape.size(); ++k) {
+    n[offset+k] = l.shape[k];
+    s[offset+k] = l.stride[k];
+  }
+  if (offset == 3) { // rank 1: split the only dimension
+    const double* z = &l.z[0] + begin*s[3];
+    double* a = &l.a[0] + begin*s[3];
+    activation.batch(m, z, s[3], a, s[3], end - begin);
+    return;
+  }
+  n[offset] = end - begin;
+
+  const double* zp = &l.z[0] + begin*s[offset];
+  double* ap = &l.a[0] + begin*s[offset];
+  for (Py_ssize_t i=0; i<n[0]; ++i)
+    for (Py_ssize_t j=0; j<n[1]; ++j)
+      for (Py_ssize_t k=0; k<n[2]; ++k) {
+        std::ptrdiff_t o = i*s[0] + j*s[1] + k*s[2];
+        activation.batch(m, zp + o, s[3], ap + o, s[3], n[3]);
+      }
+
+}
+
+/**
+ * Measures @c iterations applications of @c m to @c l, split over @c threads
+ * threads along the outermost dimension. Returns the elapsed time, in
+ * seconds, and the elapsed time-stamp counter cycles (zero if unavailable).
+ */
+static std::pair<double, unsigned long long> measure
+(const bob::learn::activation::Activation& activation,
+ bob::learn::activation::Method m, Layout& l, Py_ssize_t threads,
+ Py_ssize_t iterations) {
+
+  Py_ssize_t outer = l.shape[0];
+  threads = std::max<Py_ssize_t>(1, std::min(threads, outer));
+
+  auto start = std::chrono::steady_clock::now();
+  unsigned long long c0 = cycles();
+
+  if (threads == 1) {
+    for (Py_ssize_t k=0; k<iterations; ++k) run(activation, m, l, 0, outer);
+  }
+  else {
+    std::vector<std::thread> workers;
+    for (Py_ssize_t t=0; t<threads; ++t) {
+      Py_ssize_t begin = outer * t / threads;
+      Py_ssize_t end = outer * (t+1) / threads;
+      workers.push_back(std::thread([&activation, m, &l, begin, end, iterations]() {
+        for (Py_ssize_t k=0; k<iterations; ++k) run(activation, m, l, begin, end);
+      }));
+    }
+    for (auto it = workers.begin(); it != workers.end(); ++it) it->join();
+  }
+
+  unsigned long long c1 = cycles();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return std::make_pair(elapsed, c1 - c0);
+
+}
+
+/**
+ * Converts a sequence of positive integers into a vector
+ */
+static bool sequence(PyObject* o, const char* name, std::vector<Py_ssize_t>& v) {
+
+  PyObject* seq = PySequence_Fast(o, "expected a sequence");
+  if (!seq) return false;
+  auto seq_ = make_safe(seq);
+
+  for (Py_ssize_t k=0; k<PySequence_Fast_GET_SIZE(seq); ++k) {
+    Py_ssize_t value = PyNumber_AsSsize_t(PySequence_Fast_GET_ITEM(seq, k), PyExc_OverflowError);
+    if (value == -1 && PyErr_Occurred()) return false;
+    if (value <= 0) {
+      PyErr_Format(PyExc_ValueError, "entries of `%s' must be positive", name);
+      return false;
+    }
+    v.push_back(value);
+  }
+
+  return true;
+
+}
+
+PyDoc_STRVAR(s_kernels_str, "kernels");
+PyDoc_STRVAR(s_kernels_doc,
+"kernels(shape, strided, threads, [repeat=5, [elements=4194304]]) -> list\n\
+\n\
+Measures the batch versions of ``f``, ``f_prime`` and ``f_prime_from_f``\n\
+of each built-in activation function, applied to an array of the given\n\
+``shape`` (rank 1 to 4) from ``threads`` threads. If ``strided`` is\n\
+set, the innermost dimension visits every other element of the array.\n\
+\n\
+Each measurement applies the function until at least ``elements``\n\
+values are computed and keeps the best of ``repeat`` such runs.\n\
+Returns a list of dictionaries with keys ``activation``, ``method``,\n\
+``seconds`` (per application), ``elements_per_second`` and\n\
+``cycles_per_element``, the latter in time-stamp counter cycles, or\n\
+``None`` where the counter is unavailable.\n\
+\n\
+");
+
+static PyObject* kernels(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"shape", "strided", "threads", "repeat", "elements", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* shape_ = 0;
+  PyObject* strided_ = 0;
+  Py_ssize_t threads = 0;
+  Py_ssize_t repeat = 5;
+  Py_ssize_t elements = 1 << 22;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOn|nn", kwlist,
+        &shape_, &strided_, &threads, &repeat, &elements)) return 0;
+
+  std::vector<Py_ssize_t> shape;
+  if (!sequence(shape_, "shape", shape)) return 0;
+  if (shape.size() < 1 || shape.size() > 4) {
+    PyErr_Format(PyExc_ValueError, "`shape' must have 1 to 4 dimensions, not %" PY_FORMAT_SIZE_T "d", (Py_ssize_t)shape.size());
+    return 0;
+  }
+
+  int strided = PyObject_IsTrue(strided_);
+  if (strided < 0) return 0;
+
+  if (threads <= 0 || repeat <= 0) {
+    PyErr_SetString(PyExc_ValueError, "threads and repeat must be positive");
+    return 0;
+  }
+
+  Py_ssize_t size = 1;
+  for (std::size_t k=0; k<shape.size(); ++k) size *= shape[k];
+  Py_ssize_t iterations = std::max<Py_ssize_t>(1, elements / size);
+
+  auto activations = builtin_activations();
+  std::vector<std::pair<double, unsigned long long> > results;
+  std::string error;
+
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    Layout layout(shape, strided);
+    for (auto it = activations.begin(); it != activations.end(); ++it) {
+      for (std::size_t m=0; m<METHODS; ++m) {
+        measure(*it->second, methods[m], layout, threads, 1); //warm-up
+        std::pair<double, unsigned long long> best(std::numeric_limits<double>::infinity(), 0);
+        for (Py_ssize_t r=0; r<repeat; ++r) {
+          auto current = measure(*it->second, methods[m], layout, threads, iterations);
+          if (current.first < best.first) best = current;
+        }
+        results.push_back(best);
+      }
+    }
+  }
+  catch (std::exception& e) {
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return 0;
+  }
+
+  PyObject* retval = PyList_New(0);
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  double computed = (double)size * iterations;
+  for (std::size_t k=0; k<results.size(); ++k) {
+    const std::string& name = activations[k / METHODS].first;
+    PyObject* record;
+#ifdef BOB_LEARN_ACTIVATION_HAVE_TSC
+    record = Py_BuildValue("{s:s,s:s,s:d,s:d,s:d}",
+        "activation", name.c_str(), "method", method_names[k % METHODS],
+        "seconds", results[k].first / iterations,
+        "elements_per_second", computed / results[k].first,
+        "cycles_per_element", results[k].second / computed);
+#else
+    record = Py_BuildValue("{s:s,s:s,s:d,s:d,s:O}",
+        "activation", name.c_str(), "method", method_names[k % METHODS],
+        "seconds", results[k].first / iterations,
+        "elements_per_second", computed / results[k].first,
+        "cycles_per_element", Py_None);
+#endif
+    if (!record) return 0;
+    auto record_ = make_safe(record);
+    if (PyList_Append(retval, record) < 0) return 0;
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+static PyMethodDef module_methods[] = {
+    {
+      s_kernels_str,
+      (PyCFunction)kernels,
+      METH_VARARGS|METH_KEYWORDS,
+      s_kernels_doc
+    },
+    {0}  /* Sentinel */
+};
+
+PyDoc_STRVAR(module_docstr, "micro-benchmarks for the C++ activation kernels");
+
+#if PY_VERSION_HEX >= 0x03000000
+static PyModuleDef module_definition = {
+  PyModuleDef_HEAD_INIT,
+  BOB_EXT_MODULE_NAME,
+  module_docstr,
+  -1,
+  module_methods,
+  0, 0, 0, 0
+};
+#endif
+
+static PyObject* create_module (void) {
+
+# if PY_VERSION_HEX >= 0x03000000
+  PyObject* module = PyModule_Create(&module_definition);
+  auto module_ = make_xsafe(module);
+  const char* ret = "O";
+# else
+  PyObject* module = Py_InitModule3(BOB_EXT_MODULE_NAME, module_methods, module_docstr);
+  const char* ret = "N";
+# endif
+  if (!module) return 0;
+
+#ifdef BOB_LEARN_ACTIVATION_HAVE_TSC
+  if (PyModule_AddIntConstant(module, "have_cycle_counter", 1) < 0) return 0;
+#else
+  if (PyModule_AddIntConstant(module, "have_cycle_counter", 0) < 0) return 0;
+#endif
+
+  return Py_BuildValue(ret, module);
+}
+
+PyMODINIT_FUNC BOB_EXT_ENTRY_NAME (void) {
+# if PY_VERSION_HEX >= 0x03000000
+  return
+# endif
+    create_module();
+}
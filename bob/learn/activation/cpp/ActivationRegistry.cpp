@@ -8,17 +8,201 @@
  */
 
 #include <bob.learn.activation/Activation.h>
+#include <bob.learn.activation/FormulaActivation.h>
 #include <boost/make_shared.hpp>
+#include <boost/format.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/functional/hash.hpp>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <dlfcn.h>
 #include <bob.core/logging.h>
 
+bob::learn::activation::ActivationRegistry::ActivationRegistry():
+  m_snapshot(new Snapshot)
+{
+  const char* path = std::getenv("BOB_LEARN_ACTIVATION_PLUGIN_PATH");
+  if (!path) return;
+  std::istringstream stream(path);
+  std::string directory;
+  while (std::getline(stream, directory, ':')) {
+    if (!directory.empty()) m_plugin_directories.push_back(directory);
+  }
+}
+
 boost::shared_ptr<bob::learn::activation::ActivationRegistry> bob::learn::activation::ActivationRegistry::instance() {
   static boost::shared_ptr<bob::learn::activation::ActivationRegistry> s_instance(new ActivationRegistry());
   return s_instance;
 }
 
+bool bob::learn::activation::Activation::equals(const bob::learn::activation::Activation& other) const {
+  if (this == &other) return true;
+  if (unique_identifier() != other.unique_identifier()) return false;
+  std::vector<double> p = parameters();
+  std::vector<double> q = other.parameters();
+  if (p.size() != q.size()) return false;
+  for (std::size_t k=0; k<p.size(); ++k) if (!same_parameter(p[k], q[k])) return false;
+  return true;
+}
+
+double bob::learn::activation::Activation::f_second_from_f(double) const {
+  boost::format m("activation function %s does not implement second derivatives");
+  m % unique_identifier();
+  throw std::runtime_error(m.str());
+}
+
+std::size_t bob::learn::activation::Activation::hash() const {
+  std::size_t retval = boost::hash_value(unique_identifier());
+  std::vector<double> p = parameters();
+  for (auto it = p.begin(); it != p.end(); ++it) {
+    uint64_t bits;
+    std::memcpy(&bits, &*it, sizeof(bits));
+    boost::hash_combine(retval, bits);
+  }
+  return retval;
+}
+
+boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::Activation::clone() const {
+  auto build = ActivationRegistry::instance()->findBuilder(unique_identifier());
+  return build(unique_identifier(), parameters());
+}
+
+std::vector<boost::shared_ptr<bob::learn::activation::Activation> > bob::learn::activation::clone_activations
+(const std::vector<boost::shared_ptr<bob::learn::activation::Activation> >& activations) {
+  std::unordered_map<const Activation*, boost::shared_ptr<Activation> > copies;
+  std::vector<boost::shared_ptr<Activation> > retval;
+  retval.reserve(activations.size());
+  for (auto it = activations.begin(); it != activations.end(); ++it) {
+    if (!*it) { retval.push_back(*it); continue; }
+    boost::shared_ptr<Activation>& copy = copies[it->get()];
+    if (!copy) copy = (*it)->clone();
+    retval.push_back(copy);
+  }
+  return retval;
+}
+
 boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::load_activation(bob::io::base::HDF5File& f) {
   auto make = ActivationRegistry::instance()->find(f.read<std::string>("id"));
-  return make(f);
+  auto retval = make(f);
+  if (interning()) return intern_activation(retval);
+  return retval;
+}
+
+/**
+ * The table of shared activation instances
+ */
+struct InterningTable {
+
+  std::atomic<bool> enabled;
+  std::mutex mutex;
+  std::unordered_map<std::string, boost::weak_ptr<bob::learn::activation::Activation> > instances;
+  std::size_t sweep; ///< table size at which expired entries are swept
+  std::size_t requests;
+  std::size_t deduplicated;
+
+  InterningTable(): enabled(false), sweep(64), requests(0), deduplicated(0) {}
+
+};
+
+static InterningTable& interning_table() {
+  static InterningTable s_table;
+  return s_table;
+}
+
+/**
+ * Returns the interning key of an activation: its identifier followed by the
+ * bit patterns of its parameters and of its hash, which tells apart functions
+ * that are not fully determined by their parameters (e.g. formulas)
+ */
+static std::string interning_key(const bob::learn::activation::Activation& a) {
+  std::string retval = a.unique_identifier();
+  std::vector<double> parameters = a.parameters();
+  std::size_t hash = a.hash();
+  retval.push_back('\0');
+  if (!parameters.empty()) retval.append(reinterpret_cast<const char*>(&parameters[0]), parameters.size()*sizeof(double));
+  retval.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+  return retval;
+}
+
+/**
+ * Returns the instance equal to @c probe, or the one returned by @c make if
+ * there is none yet
+ */
+template <typename Make>
+static boost::shared_ptr<bob::learn::activation::Activation> intern(
+    const bob::learn::activation::Activation& probe, Make make) {
+
+  std::string key = interning_key(probe);
+
+  InterningTable& table = interning_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  auto it = table.instances.find(key);
+  if (it != table.instances.end()) {
+    boost::shared_ptr<bob::learn::activation::Activation> existing = it->second.lock();
+    // instances already interned (e.g. by their factory) are not counted
+    if (existing.get() == &probe) return existing;
+    ++table.requests;
+    if (existing && existing->equals(probe)) {
+      ++table.deduplicated;
+      return existing;
+    }
+    // hash collision: the probe is returned as is, but not interned
+    if (existing) return make();
+  }
+  else ++table.requests;
+
+  boost::shared_ptr<bob::learn::activation::Activation> retval = make();
+  table.instances[key] = retval;
+
+  if (table.instances.size() >= table.sweep) {
+    for (auto k = table.instances.begin(); k != table.instances.end();) {
+      if (k->second.expired()) k = table.instances.erase(k);
+      else ++k;
+    }
+    table.sweep = std::max<std::size_t>(64, 2*table.instances.size());
+  }
+
+  return retval;
+
+}
+
+bool bob::learn::activation::set_interning(bool enabled) {
+  return interning_table().enabled.exchange(enabled);
+}
+
+bool bob::learn::activation::interning() {
+  return interning_table().enabled.load();
+}
+
+boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::intern_activation(const boost::shared_ptr<bob::learn::activation::Activation>& a) {
+  return intern(*a, [&a]() { return a; });
+}
+
+bob::learn::activation::InterningStatistics bob::learn::activation::interning_statistics() {
+  InterningTable& table = interning_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  InterningStatistics retval;
+  retval.requests = table.requests;
+  retval.deduplicated = table.deduplicated;
+  retval.live = 0;
+  for (auto it = table.instances.begin(); it != table.instances.end(); ++it) {
+    if (!it->second.expired()) ++retval.live;
+  }
+  return retval;
+}
+
+void bob::learn::activation::reset_interning_statistics() {
+  InterningTable& table = interning_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  table.requests = 0;
+  table.deduplicated = 0;
 }
 
 boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::make_deprecated_activation(uint32_t e) {
@@ -38,20 +222,51 @@ boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::ma
 }
 
 
+std::map<std::string, bob::learn::activation::activation_factory_t> bob::learn::activation::ActivationRegistry::getFactories() {
+  auto current = instance()->snapshot();
+  return std::map<std::string, activation_factory_t>(current->factories.begin(), current->factories.end());
+}
+
+boost::shared_ptr<const bob::learn::activation::ActivationRegistry::Snapshot> bob::learn::activation::ActivationRegistry::snapshot() const {
+  return boost::atomic_load(&m_snapshot);
+}
+
 void bob::learn::activation::ActivationRegistry::deregisterFactory(const std::string& id) {
-  s_id2factory.erase(id);
+
+  std::lock_guard<std::mutex> lock(m_writer);
+
+  auto current = snapshot();
+  if (current->factories.find(id) == current->factories.end()) return;
+
+  boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current);
+  next->factories.erase(id);
+  next->builders.erase(id);
+
+  // forgets legacy names resolved to this identifier
+  for (auto it = next->aliases.begin(); it != next->aliases.end();) {
+    if (it->second == id) it = next->aliases.erase(it);
+    else ++it;
+  }
+
+  boost::atomic_store(&m_snapshot, boost::shared_ptr<const Snapshot>(next));
+
 }
 
 void bob::learn::activation::ActivationRegistry::registerActivation(const std::string& id,
     bob::learn::activation::activation_factory_t factory) {
 
-  auto it = s_id2factory.find(id);
+  std::lock_guard<std::mutex> lock(m_writer);
 
-  if (it == s_id2factory.end()) {
-    s_id2factory[id] = factory;
+  auto current = snapshot();
+  auto it = current->factories.find(id);
+
+  if (it == current->factories.end()) {
+    boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current);
+    next->factories[id] = factory;
+    boost::atomic_store(&m_snapshot, boost::shared_ptr<const Snapshot>(next));
   }
   else {
-    if (s_id2factory[id] != factory) {
+    if (it->second != factory) {
       boost::format m("replacing factory for activation functor `%s' with a different one is not allowed at this point");
       m % id;
       throw std::runtime_error(m.str());
@@ -61,37 +276,222 @@ void bob::learn::activation::ActivationRegistry::registerActivation(const std::s
   }
 }
 
+void bob::learn::activation::ActivationRegistry::registerBuilder(const std::string& id,
+    bob::learn::activation::activation_builder_t builder) {
+
+  std::lock_guard<std::mutex> lock(m_writer);
+
+  auto current = snapshot();
+  auto it = current->builders.find(id);
+
+  if (it == current->builders.end()) {
+    boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current);
+    next->builders[id] = builder;
+    boost::atomic_store(&m_snapshot, boost::shared_ptr<const Snapshot>(next));
+  }
+  else if (it->second != builder) {
+    boost::format m("replacing builder for activation functor `%s' with a different one is not allowed at this point");
+    m % id;
+    throw std::runtime_error(m.str());
+  }
+}
+
+bob::learn::activation::activation_builder_t bob::learn::activation::ActivationRegistry::findBuilder
+(const std::string& id) {
+
+  auto current = snapshot();
+  auto it = current->builders.find(id);
+  if (it != current->builders.end()) return it->second;
+
+  loadPlugin(id);
+  current = snapshot();
+  it = current->builders.find(id);
+
+  if (it == current->builders.end()) {
+    boost::format m("activation function %s cannot be built from its parameters - no builder registered");
+    m % id;
+    throw std::runtime_error(m.str());
+  }
+
+  return it->second;
+
+}
+
 bool bob::learn::activation::ActivationRegistry::isRegistered(const std::string& id) {
-  return (s_id2factory.find(id) != s_id2factory.end());
+  auto current = snapshot();
+  return (current->factories.find(id) != current->factories.end());
 }
 
 bob::learn::activation::activation_factory_t bob::learn::activation::ActivationRegistry::find
 (const std::string& id) {
 
-  auto it = s_id2factory.find(id);
+  auto current = snapshot();
 
-  if (it == s_id2factory.end()) {
-    // try to convert the old "machine" name into the new "learn.activation" name
-    auto i = id.find("machine");
-    if (i != std::string::npos){
-      std::string tid = id;
-      tid.replace(i, 7, "learn.activation");
+  auto it = current->factories.find(id);
+  if (it != current->factories.end()) return it->second;
+
+  // legacy identifiers resolved before
+  auto alias = current->aliases.find(id);
+  if (alias != current->aliases.end()) {
+    it = current->factories.find(alias->second);
+    if (it != current->factories.end()) return it->second;
+  }
+
+  // plugins register their factories while being loaded
+  bool plugin = loadPlugin(id);
+  current = snapshot();
+  it = current->factories.find(id);
+  if (it != current->factories.end()) return it->second;
+
+  if (plugin) {
+    boost::format m("plugin library %s did not register activation function %s");
+    m % getPlugins()[id] % id;
+    throw std::runtime_error(m.str());
+  }
 
-      it = s_id2factory.find(tid);
-      if (it != s_id2factory.end()) {
-        bob::core::warn << "Using the old name of the activation function '" << id << "' is deprecated. Please use '" << tid << "' instead!";
+  return resolve(id);
+
+}
+
+bob::learn::activation::activation_factory_t bob::learn::activation::ActivationRegistry::resolve
+(const std::string& id) {
+
+  std::lock_guard<std::mutex> lock(m_writer);
+
+  // another thread may have resolved it in the meanwhile
+  auto current = snapshot();
+  auto alias = current->aliases.find(id);
+  if (alias != current->aliases.end()) {
+    auto it = current->factories.find(alias->second);
+    if (it != current->factories.end()) return it->second;
+  }
+
+  // try to convert the old "machine" name into the new "learn.activation" name
+  auto i = id.find("machine");
+  if (i != std::string::npos){
+    std::string tid = id;
+    tid.replace(i, 7, "learn.activation");
+
+    auto it = current->factories.find(tid);
+    if (it != current->factories.end()) {
+      bob::core::warn << "Using the old name of the activation function '" << id << "' is deprecated. Please use '" << tid << "' instead!";
+      boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current);
+      next->aliases[id] = tid;
+      boost::atomic_store(&m_snapshot, boost::shared_ptr<const Snapshot>(next));
+      return it->second;
+    }
+  }
+
+  boost::format m("unregistered activation function: %s");
+  m % id;
+  throw std::runtime_error(m.str());
+
+}
+
+void bob::learn::activation::ActivationRegistry::addPluginDirectory(const std::string& directory) {
+  std::lock_guard<std::recursive_mutex> lock(m_plugin_mutex);
+  m_plugin_directories.push_back(directory);
+}
+
+std::map<std::string, std::string> bob::learn::activation::ActivationRegistry::getPlugins() {
+  std::lock_guard<std::recursive_mutex> lock(m_plugin_mutex);
+  scanPlugins();
+  return m_plugins;
+}
+
+void bob::learn::activation::ActivationRegistry::scanPlugins() {
+
+  for (auto d = m_plugin_directories.begin(); d != m_plugin_directories.end(); ++d) {
+
+    DIR* directory = opendir(d->c_str());
+    if (!directory) {
+      bob::core::warn << "Cannot read activation plugin directory '" << *d << "': " << std::strerror(errno);
+      continue;
+    }
+
+    std::vector<std::string> manifests;
+    while (struct dirent* entry = readdir(directory)) {
+      std::string name = entry->d_name;
+      if (name.size() > 9 && name.compare(name.size()-9, 9, ".manifest") == 0)
+        manifests.push_back(*d + "/" + name);
+    }
+    closedir(directory);
+    std::sort(manifests.begin(), manifests.end());
+
+    for (auto m = manifests.begin(); m != manifests.end(); ++m) {
+      std::ifstream manifest(m->c_str());
+      std::string line;
+      while (std::getline(manifest, line)) {
+        std::istringstream fields(line);
+        std::string id, library;
+        if (!(fields >> id >> library) || id[0] == '#') continue;
+        if (library[0] != '/') library = *d + "/" + library;
+        // earlier directories (and manifests) take precedence
+        m_plugins.insert(std::make_pair(id, library));
       }
     }
+
   }
 
-  if (it == s_id2factory.end()) {
-    boost::format m("unregistered activation function: %s");
-    m % id;
+  m_plugin_directories.clear();
+
+}
+
+bool bob::learn::activation::ActivationRegistry::loadPlugin(const std::string& id) {
+
+  std::lock_guard<std::recursive_mutex> lock(m_plugin_mutex);
+
+  scanPlugins();
+
+  auto it = m_plugins.find(id);
+  if (it == m_plugins.end()) return false;
+  if (m_libraries.find(it->second) != m_libraries.end()) return true;
+
+  void* handle = dlopen(it->second.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    boost::format m("cannot load plugin library for activation function %s: %s");
+    m % id % dlerror();
     throw std::runtime_error(m.str());
   }
 
-  return it->second;
+  m_libraries[it->second] = handle;
+  return true;
+
+}
+
+/**
+ * Checks the number of parameters given to a builder
+ */
+static void check_parameters(const std::string& id, const std::vector<double>& p,
+    std::size_t expected) {
+  if (p.size() != expected) {
+    boost::format m("activation function %s takes %u parameter(s), but %u were given");
+    m % id % expected % p.size();
+    throw std::runtime_error(m.str());
+  }
+}
+
+/**
+ * Creates activations from their parameters, for the classes below
+ */
+template <typename T> static boost::shared_ptr<T> build(const std::vector<double>& p) {
+  auto retval = boost::make_shared<T>();
+  check_parameters(retval->unique_identifier(), p, 0);
+  return retval;
+}
 
+template <> boost::shared_ptr<bob::learn::activation::LinearActivation> build(const std::vector<double>& p) {
+  check_parameters("bob.learn.activation.Activation.Linear", p, 1);
+  return boost::make_shared<bob::learn::activation::LinearActivation>(p[0]);
+}
+
+template <> boost::shared_ptr<bob::learn::activation::MultipliedHyperbolicTangentActivation> build(const std::vector<double>& p) {
+  check_parameters("bob.learn.activation.Activation.MultipliedHyperbolicTangent", p, 2);
+  return boost::make_shared<bob::learn::activation::MultipliedHyperbolicTangentActivation>(p[0], p[1]);
+}
+
+template <> boost::shared_ptr<bob::learn::activation::FormulaActivation> build(const std::vector<double>&) {
+  throw std::runtime_error("activation function bob.learn.activation.Activation.Formula cannot be built from its parameters alone - save it to HDF5 instead");
 }
 
 /**
@@ -100,14 +500,25 @@ bob::learn::activation::activation_factory_t bob::learn::activation::ActivationR
 template <typename T> struct register_activation {
 
   static boost::shared_ptr<bob::learn::activation::Activation> factory (bob::io::base::HDF5File& f) {
+    if (bob::learn::activation::interning()) {
+      // only allocates if no equal instance exists
+      T probe;
+      probe.load(f);
+      return intern(probe, [&probe]() { return boost::make_shared<T>(probe); });
+    }
     auto retval = boost::make_shared<T>();
     retval->load(f);
     return retval;
   }
 
+  static boost::shared_ptr<bob::learn::activation::Activation> builder (const std::string&, const std::vector<double>& p) {
+    return build<T>(p);
+  }
+
   register_activation() {
     T obj;
     bob::learn::activation::ActivationRegistry::instance()->registerActivation(obj.unique_identifier(), register_activation<T>::factory);
+    bob::learn::activation::ActivationRegistry::instance()->registerBuilder(obj.unique_identifier(), register_activation<T>::builder);
   }
 
 };
@@ -118,5 +529,6 @@ static register_activation<bob::learn::activation::LinearActivation> _linear_act
 static register_activation<bob::learn::activation::HyperbolicTangentActivation> _tanh_act_reg;
 static register_activation<bob::learn::activation::MultipliedHyperbolicTangentActivation> _multanh_act_reg;
 static register_activation<bob::learn::activation::LogisticActivation> _logistic_act_reg;
+static register_activation<bob::learn::activation::FormulaActivation> _formula_act_reg;
 
 
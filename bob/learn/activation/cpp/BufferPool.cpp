@@ -0,0 +1,119 @@
+/**
+ * @date Mon 19 Oct 2026 09:12:40 CEST
+ *
+ * @brief Implementation of the pool of output buffers
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/BufferPool.h>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+std::atomic<bool> bob::learn::activation::detail::pooling(false);
+
+bob::learn::activation::BufferPool::BufferPool(std::size_t limit):
+  m_limit(limit)
+{
+  std::memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+bob::learn::activation::BufferPool::~BufferPool() {
+  clear();
+}
+
+void* bob::learn::activation::BufferPool::acquire(std::size_t bytes) {
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_free.find(bytes);
+    if (it != m_free.end()) {
+      void* retval = it->second;
+      m_free.erase(it);
+      ++m_statistics.hits;
+      --m_statistics.buffers;
+      m_statistics.bytes -= bytes;
+      return retval;
+    }
+    ++m_statistics.misses;
+  }
+
+  bool huge = bytes >= HUGE_BUFFER;
+  void* retval = 0;
+  if (posix_memalign(&retval, huge ? HUGE_BUFFER : 64, std::max<std::size_t>(bytes, 1)))
+    throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+  if (huge && !madvise(retval, bytes, MADV_HUGEPAGE)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_statistics.huge;
+  }
+#endif
+
+  // pages are left untouched, so that the threads evaluating the array are
+  // the first to write them, which places them near those threads
+  return retval;
+
+}
+
+void bob::learn::activation::BufferPool::trim() {
+  while (m_statistics.bytes > m_limit && !m_free.empty()) {
+    auto it = --m_free.end(); // largest first
+    m_statistics.bytes -= it->first;
+    --m_statistics.buffers;
+    ++m_statistics.dropped;
+    std::free(it->second);
+    m_free.erase(it);
+  }
+}
+
+void bob::learn::activation::BufferPool::release(void* buffer, std::size_t bytes) {
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (bytes > m_limit) {
+    ++m_statistics.dropped;
+    std::free(buffer);
+    return;
+  }
+
+  m_free.insert(std::make_pair(bytes, buffer));
+  ++m_statistics.buffers;
+  m_statistics.bytes += bytes;
+  trim();
+
+}
+
+void bob::learn::activation::BufferPool::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& k : m_free) std::free(k.second);
+  m_free.clear();
+  m_statistics.buffers = 0;
+  m_statistics.bytes = 0;
+}
+
+std::size_t bob::learn::activation::BufferPool::set_limit(std::size_t limit) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::size_t retval = m_limit;
+  m_limit = limit;
+  trim();
+  return retval;
+}
+
+bob::learn::activation::BufferPoolStatistics bob::learn::activation::BufferPool::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+bool bob::learn::activation::set_pooling(bool enabled) {
+  return detail::pooling.exchange(enabled);
+}
+
+bob::learn::activation::BufferPool& bob::learn::activation::buffer_pool() {
+  // never destroyed, as arrays may give buffers back until the very end
+  static BufferPool* s_pool = new BufferPool;
+  return *s_pool;
+}
@@ -0,0 +1,250 @@
+/**
+ * @date Thu 15 Oct 2026 09:41:18 CEST
+ *
+ * @brief Implementation of the compact serialization of activations
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Compact.h>
+#include <boost/format.hpp>
+#include <unordered_map>
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+static const char MAGIC[4] = {'B', 'L', 'A', 'C'};
+static const uint32_t VERSION = 1;
+static const std::size_t HEADER_SIZE = 16;
+
+static std::size_t align8(std::size_t offset) {
+  return (offset + 7) & ~std::size_t(7);
+}
+
+std::string bob::learn::activation::save_compact
+(const std::vector<boost::shared_ptr<bob::learn::activation::Activation> >& activations) {
+
+  // interns type identifiers, in order of appearance
+  std::vector<std::string> types;
+  std::unordered_map<std::string, uint32_t> type_index;
+  std::vector<CompactRecord> records(activations.size());
+
+  for (std::size_t k=0; k<activations.size(); ++k) {
+
+    const Activation& a = *activations[k];
+    std::string id = a.unique_identifier();
+    auto it = type_index.find(id);
+    if (it == type_index.end()) {
+      it = type_index.insert(std::make_pair(id, (uint32_t)types.size())).first;
+      types.push_back(id);
+    }
+
+    std::vector<double> parameters = a.parameters();
+    if (parameters.size() > COMPACT_MAX_PARAMETERS) {
+      boost::format m("activation function %s has %u parameters, but at most %u can be stored in compact form");
+      m % id % parameters.size() % COMPACT_MAX_PARAMETERS;
+      throw std::runtime_error(m.str());
+    }
+
+    CompactRecord& r = records[k];
+    std::memset(&r, 0, sizeof(CompactRecord));
+    r.type = it->second;
+    r.n_parameters = parameters.size();
+    std::copy(parameters.begin(), parameters.end(), r.parameters);
+
+  }
+
+  std::string retval(MAGIC, 4);
+  uint32_t header[3] = {VERSION, (uint32_t)types.size(), (uint32_t)records.size()};
+  retval.append(reinterpret_cast<const char*>(header), sizeof(header));
+
+  for (auto it = types.begin(); it != types.end(); ++it) {
+    uint32_t length = it->size();
+    retval.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    retval.append(*it);
+  }
+
+  retval.resize(align8(retval.size()), '\0');
+  if (!records.empty()) retval.append(reinterpret_cast<const char*>(&records[0]), records.size()*sizeof(CompactRecord));
+
+  return retval;
+
+}
+
+/**
+ * Checks the header and the type table of compact data, resolving the
+ * builders of all types. Returns the offset of the first record and sets
+ * @c count to the number of records.
+ */
+static std::size_t parse(const char* data, std::size_t size,
+    std::vector<std::string>& types,
+    std::vector<bob::learn::activation::activation_builder_t>& builders,
+    std::size_t& count) {
+
+  if (size < HEADER_SIZE || std::memcmp(data, MAGIC, 4) != 0) {
+    throw std::runtime_error("data does not hold activation functions in compact form (bad header)");
+  }
+
+  uint32_t header[3];
+  std::memcpy(header, data+4, sizeof(header));
+
+  if (header[0] != VERSION) {
+    boost::format m("unsupported version (%u) of compact activation data - this code reads version %u in the host byte order");
+    m % header[0] % VERSION;
+    throw std::runtime_error(m.str());
+  }
+
+  auto registry = bob::learn::activation::ActivationRegistry::instance();
+
+  std::size_t offset = HEADER_SIZE;
+  types.clear();
+  builders.clear();
+  for (uint32_t k=0; k<header[1]; ++k) {
+    uint32_t length;
+    if (offset + sizeof(length) > size) throw std::runtime_error("compact activation data is truncated (type table)");
+    std::memcpy(&length, data+offset, sizeof(length));
+    offset += sizeof(length);
+    if (offset + length > size) throw std::runtime_error("compact activation data is truncated (type table)");
+    types.push_back(std::string(data+offset, length));
+    builders.push_back(registry->findBuilder(types.back()));
+    offset += length;
+  }
+
+  offset = align8(offset);
+  count = header[2];
+  if (offset + count*sizeof(bob::learn::activation::CompactRecord) > size) {
+    throw std::runtime_error("compact activation data is truncated (records)");
+  }
+
+  return offset;
+
+}
+
+/**
+ * Creates the activation described by the record at @c p
+ */
+static boost::shared_ptr<bob::learn::activation::Activation> build(const char* p,
+    const std::vector<std::string>& types,
+    const std::vector<bob::learn::activation::activation_builder_t>& builders) {
+
+  bob::learn::activation::CompactRecord r;
+  std::memcpy(&r, p, sizeof(r)); //byte strings may be unaligned
+
+  if (r.type >= builders.size() || r.n_parameters > bob::learn::activation::COMPACT_MAX_PARAMETERS) {
+    throw std::runtime_error("compact activation data is corrupted (bad record)");
+  }
+
+  auto retval = builders[r.type](types[r.type], std::vector<double>(r.parameters, r.parameters + r.n_parameters));
+  if (bob::learn::activation::interning()) return bob::learn::activation::intern_activation(retval);
+  return retval;
+
+}
+
+std::vector<boost::shared_ptr<bob::learn::activation::Activation> > bob::learn::activation::load_compact(const void* data, std::size_t size) {
+
+  const char* bytes = reinterpret_cast<const char*>(data);
+  std::vector<std::string> types;
+  std::vector<activation_builder_t> builders;
+  std::size_t count;
+  std::size_t offset = parse(bytes, size, types, builders, count);
+
+  std::vector<boost::shared_ptr<Activation> > retval;
+  retval.reserve(count);
+  for (std::size_t k=0; k<count; ++k) {
+    retval.push_back(build(bytes + offset + k*sizeof(CompactRecord), types, builders));
+  }
+  return retval;
+
+}
+
+void bob::learn::activation::save_bundle(const std::string& filename,
+    const std::vector<boost::shared_ptr<bob::learn::activation::Activation> >& activations) {
+
+  std::string data = save_compact(activations);
+
+  std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(data.data(), data.size());
+  out.close();
+
+  if (!out) {
+    boost::format m("cannot write activations to file `%s'");
+    m % filename;
+    throw std::runtime_error(m.str());
+  }
+
+}
+
+std::vector<boost::shared_ptr<bob::learn::activation::Activation> > bob::learn::activation::load_bundle(const std::string& filename) {
+  return MappedBundle(filename).load();
+}
+
+bob::learn::activation::MappedBundle::MappedBundle(const std::string& filename):
+  m_data(0),
+  m_size(0),
+  m_records(0),
+  m_count(0)
+{
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    boost::format m("cannot open activation bundle `%s': %s");
+    m % filename % std::strerror(errno);
+    throw std::runtime_error(m.str());
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    boost::format m("cannot map activation bundle `%s': empty or unreadable file");
+    m % filename;
+    throw std::runtime_error(m.str());
+  }
+
+  m_size = st.st_size;
+  m_data = ::mmap(0, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); //the mapping stays valid
+
+  if (m_data == MAP_FAILED) {
+    m_data = 0;
+    boost::format m("cannot map activation bundle `%s': %s");
+    m % filename % std::strerror(errno);
+    throw std::runtime_error(m.str());
+  }
+
+  try {
+    const char* bytes = reinterpret_cast<const char*>(m_data);
+    m_records = bytes + parse(bytes, m_size, m_types, m_builders, m_count);
+  }
+  catch (...) {
+    ::munmap(m_data, m_size);
+    throw;
+  }
+
+}
+
+bob::learn::activation::MappedBundle::~MappedBundle() {
+  if (m_data) ::munmap(m_data, m_size);
+}
+
+boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::MappedBundle::load(std::size_t k) const {
+  if (k >= m_count) {
+    boost::format m("activation %u is out of range - the bundle holds %u activations");
+    m % k % m_count;
+    throw std::runtime_error(m.str());
+  }
+  return build(m_records + k*sizeof(CompactRecord), m_types, m_builders);
+}
+
+std::vector<boost::shared_ptr<bob::learn::activation::Activation> > bob::learn::activation::MappedBundle::load() const {
+  std::vector<boost::shared_ptr<Activation> > retval;
+  retval.reserve(m_count);
+  for (std::size_t k=0; k<m_count; ++k) {
+    retval.push_back(build(m_records + k*sizeof(CompactRecord), m_types, m_builders));
+  }
+  return retval;
+}
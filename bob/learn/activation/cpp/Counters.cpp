@@ -0,0 +1,85 @@
+/**
+ * @date Sun 18 Oct 2026 14:26:51 CEST
+ *
+ * @brief Implementation of call counters and latency histograms
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Counters.h>
+
+std::atomic<bool> bob::learn::activation::detail::counting(false);
+
+bob::learn::activation::Counters::Counters() {
+  reset();
+}
+
+void bob::learn::activation::Counters::record(Method m, Path p,
+    std::size_t elements, uint64_t nanoseconds) {
+
+  std::size_t bucket = 0;
+  for (uint64_t ns = nanoseconds >> 1; ns && bucket < LATENCY_BUCKETS-1; ns >>= 1) ++bucket;
+
+  Cell& c = m_cells[m][p];
+  c.calls.fetch_add(1, std::memory_order_relaxed);
+  c.elements.fetch_add(elements, std::memory_order_relaxed);
+  c.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  c.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+}
+
+bob::learn::activation::CallStatistics bob::learn::activation::Counters::get
+(Method m, Path p) const {
+
+  const Cell& c = m_cells[m][p];
+  CallStatistics retval;
+  retval.calls = c.calls.load(std::memory_order_relaxed);
+  retval.elements = c.elements.load(std::memory_order_relaxed);
+  retval.bytes = 2 * sizeof(double) * retval.elements;
+  retval.nanoseconds = c.nanoseconds.load(std::memory_order_relaxed);
+  for (std::size_t k=0; k<LATENCY_BUCKETS; ++k)
+    retval.histogram[k] = c.histogram[k].load(std::memory_order_relaxed);
+  return retval;
+
+}
+
+void bob::learn::activation::Counters::reset() {
+
+  for (std::size_t m=0; m<COUNTED_METHODS; ++m)
+    for (std::size_t p=0; p<COUNTED_PATHS; ++p) {
+      Cell& c = m_cells[m][p];
+      c.calls.store(0, std::memory_order_relaxed);
+      c.elements.store(0, std::memory_order_relaxed);
+      c.nanoseconds.store(0, std::memory_order_relaxed);
+      for (std::size_t k=0; k<LATENCY_BUCKETS; ++k)
+        c.histogram[k].store(0, std::memory_order_relaxed);
+    }
+
+}
+
+bool bob::learn::activation::set_counting(bool enabled) {
+  return detail::counting.exchange(enabled);
+}
+
+bob::learn::activation::Counters& bob::learn::activation::global_counters() {
+  static Counters s_counters;
+  return s_counters;
+}
+
+bob::learn::activation::Counters& bob::learn::activation::Activation::counters() const {
+
+  Counters* retval = m_counters.load(std::memory_order_acquire);
+  if (retval) return *retval;
+
+  // first use: the thread that publishes its counters wins
+  Counters* fresh = new Counters;
+  if (m_counters.compare_exchange_strong(retval, fresh, std::memory_order_acq_rel))
+    return *fresh;
+  delete fresh;
+  return *retval;
+
+}
+
+bob::learn::activation::Activation::~Activation() {
+  delete m_counters.load();
+}
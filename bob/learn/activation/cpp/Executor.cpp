@@ -0,0 +1,77 @@
+/**
+ * @date Tue 13 Oct 2026 09:41:17 CEST
+ *
+ * @brief Implementation of the background executor
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Executor.h>
+#include <stdexcept>
+
+bob::learn::activation::Executor::Executor(const completer_t& completer,
+    std::size_t max_batch):
+  m_completer(completer),
+  m_max_batch(max_batch ? max_batch : 1),
+  m_stop(false),
+  m_worker(&bob::learn::activation::Executor::run, this)
+{
+}
+
+bob::learn::activation::Executor::~Executor() {
+  shutdown();
+}
+
+void bob::learn::activation::Executor::submit(const task_t& work,
+    const task_t& done) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) throw std::runtime_error("cannot submit jobs to an activation executor that was shut down");
+    m_queue.push_back(std::make_pair(work, done));
+  }
+  m_cond.notify_one();
+}
+
+void bob::learn::activation::Executor::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_one();
+  if (m_worker.joinable()) m_worker.join();
+}
+
+std::size_t bob::learn::activation::Executor::pending() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_queue.size();
+}
+
+void bob::learn::activation::Executor::run() {
+
+  std::vector<task_t> work;
+  std::vector<task_t> done;
+
+  while (true) {
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) return; //stopped and drained
+      while (!m_queue.empty() && work.size() < m_max_batch) {
+        work.push_back(m_queue.front().first);
+        done.push_back(m_queue.front().second);
+        m_queue.pop_front();
+      }
+    }
+
+    for (auto it = work.begin(); it != work.end(); ++it) (*it)();
+
+    if (m_completer) m_completer(done);
+    else for (auto it = done.begin(); it != done.end(); ++it) (*it)();
+
+    work.clear();
+    done.clear();
+
+  }
+
+}
@@ -0,0 +1,854 @@
+/**
+ * @date Sat 17 Oct 2026 09:41:12 CEST
+ *
+ * @brief Implementation of activation functions defined by a formula
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/FormulaActivation.h>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * Number of values each bytecode instruction is applied to at once, small
+ * enough for the evaluation stack to stay in the L1 cache
+ */
+static const std::size_t BLOCK = 256;
+
+/**
+ * Number of stack values that are allocated on the (C++) stack. Deeper
+ * programs use the heap.
+ */
+static const std::size_t LOCAL = 4*BLOCK;
+
+namespace {
+
+  /*****************************
+   * Expression trees          *
+   *****************************/
+
+  enum Kind { CONSTANT, VARIABLE, PARAMETER, NEGATE, ADD, SUB, MUL, DIV, POW, FUNCTION };
+
+  enum Function { ABS, SIGN, EXP, LOG, LOG1P, SQRT, TANH, SINH, COSH, SIN, COS, ERF, FUNCTIONS };
+
+  const char* const function_names[] = { "abs", "sign", "exp", "log", "log1p",
+    "sqrt", "tanh", "sinh", "cosh", "sin", "cos", "erf" };
+
+  struct Node;
+  typedef boost::shared_ptr<const Node> node_t;
+
+  /**
+   * A node of an (immutable) expression tree
+   */
+  struct Node {
+    Kind kind;
+    double value; ///< for constants
+    std::size_t index; ///< for parameters
+    Function function; ///< for functions
+    node_t a; ///< first (or only) operand
+    node_t b; ///< second operand
+  };
+
+  double apply(Function f, double x) {
+    switch (f) {
+      case ABS: return std::fabs(x);
+      case SIGN: return (x > 0.) - (x < 0.);
+      case EXP: return std::exp(x);
+      case LOG: return std::log(x);
+      case LOG1P: return std::log1p(x);
+      case SQRT: return std::sqrt(x);
+      case TANH: return std::tanh(x);
+      case SINH: return std::sinh(x);
+      case COSH: return std::cosh(x);
+      case SIN: return std::sin(x);
+      case COS: return std::cos(x);
+      case ERF: return std::erf(x);
+      default: return x;
+    }
+  }
+
+  node_t leaf(Kind kind, double value=0., std::size_t index=0) {
+    auto retval = boost::make_shared<Node>();
+    retval->kind = kind;
+    retval->value = value;
+    retval->index = index;
+    retval->function = FUNCTIONS;
+    return retval;
+  }
+
+  node_t constant(double value) { return leaf(CONSTANT, value); }
+
+  bool is_constant(const node_t& n, double value) {
+    return n->kind == CONSTANT && n->value == value;
+  }
+
+  bool same(const node_t& a, const node_t& b) {
+    if (a == b) return true;
+    if (!a || !b) return false;
+    return a->kind == b->kind && a->value == b->value && a->index == b->index &&
+      a->function == b->function && same(a->a, b->a) && same(a->b, b->b);
+  }
+
+  node_t node(Kind kind, node_t a, node_t b=node_t(), Function function=FUNCTIONS) {
+    auto retval = boost::make_shared<Node>();
+    retval->kind = kind;
+    retval->value = 0.;
+    retval->index = 0;
+    retval->function = function;
+    retval->a = a;
+    retval->b = b;
+    return retval;
+  }
+
+  /*
+   * Builders that fold constants and drop neutral elements, so that
+   * derivatives remain compact
+   */
+
+  node_t make_neg(node_t a) {
+    if (a->kind == CONSTANT) return constant(-a->value);
+    if (a->kind == NEGATE) return a->a;
+    return node(NEGATE, a);
+  }
+
+  node_t make_add(node_t a, node_t b) {
+    if (a->kind == CONSTANT && b->kind == CONSTANT) return constant(a->value + b->value);
+    if (is_constant(a, 0.)) return b;
+    if (is_constant(b, 0.)) return a;
+    if (b->kind == NEGATE) return node(SUB, a, b->a);
+    return node(ADD, a, b);
+  }
+
+  node_t make_sub(node_t a, node_t b) {
+    if (a->kind == CONSTANT && b->kind == CONSTANT) return constant(a->value - b->value);
+    if (is_constant(b, 0.)) return a;
+    if (is_constant(a, 0.)) return make_neg(b);
+    if (same(a, b)) return constant(0.);
+    if (b->kind == NEGATE) return node(ADD, a, b->a);
+    return node(SUB, a, b);
+  }
+
+  node_t make_mul(node_t a, node_t b) {
+    if (a->kind == CONSTANT && b->kind == CONSTANT) return constant(a->value * b->value);
+    if (is_constant(a, 0.) || is_constant(b, 0.)) return constant(0.);
+    if (is_constant(a, 1.)) return b;
+    if (is_constant(b, 1.)) return a;
+    if (is_constant(a, -1.)) return make_neg(b);
+    if (is_constant(b, -1.)) return make_neg(a);
+    if (a->kind == NEGATE) return make_neg(make_mul(a->a, b));
+    if (b->kind == NEGATE) return make_neg(make_mul(a, b->a));
+    if (a->kind == CONSTANT && b->kind == MUL && b->a->kind == CONSTANT)
+      return make_mul(constant(a->value * b->a->value), b->b);
+    return node(MUL, a, b);
+  }
+
+  node_t make_div(node_t a, node_t b) {
+    if (a->kind == CONSTANT && b->kind == CONSTANT) return constant(a->value / b->value);
+    if (is_constant(a, 0.)) return constant(0.);
+    if (is_constant(b, 1.)) return a;
+    return node(DIV, a, b);
+  }
+
+  node_t make_pow(node_t a, node_t b) {
+    if (a->kind == CONSTANT && b->kind == CONSTANT) return constant(std::pow(a->value, b->value));
+    if (is_constant(b, 0.)) return constant(1.);
+    if (is_constant(b, 1.)) return a;
+    return node(POW, a, b);
+  }
+
+  node_t make_function(Function f, node_t a) {
+    if (a->kind == CONSTANT) return constant(apply(f, a->value));
+    return node(FUNCTION, a, node_t(), f);
+  }
+
+  /**
+   * Tells if the expression depends on the variable
+   */
+  bool depends(const node_t& n) {
+    if (n->kind == VARIABLE) return true;
+    return (n->a && depends(n->a)) || (n->b && depends(n->b));
+  }
+
+  /**
+   * Differentiates the expression with respect to the variable
+   */
+  node_t derive(const node_t& n) {
+    switch (n->kind) {
+      case CONSTANT:
+      case PARAMETER:
+        return constant(0.);
+      case VARIABLE:
+        return constant(1.);
+      case NEGATE:
+        return make_neg(derive(n->a));
+      case ADD:
+        return make_add(derive(n->a), derive(n->b));
+      case SUB:
+        return make_sub(derive(n->a), derive(n->b));
+      case MUL:
+        return make_add(make_mul(derive(n->a), n->b), make_mul(n->a, derive(n->b)));
+      case DIV:
+        {
+          node_t da = derive(n->a);
+          if (!depends(n->b)) return make_div(da, n->b);
+          return make_div(make_sub(make_mul(da, n->b), make_mul(n->a, derive(n->b))),
+              make_pow(n->b, constant(2.)));
+        }
+      case POW:
+        {
+          node_t da = derive(n->a);
+          if (!depends(n->b)) // d(a^b) = b * a^(b-1) * da
+            return make_mul(make_mul(n->b, make_pow(n->a, make_sub(n->b, constant(1.)))), da);
+          // d(a^b) = a^b * (db * log(a) + b * da / a)
+          return make_mul(n, make_add(make_mul(derive(n->b), make_function(LOG, n->a)),
+                make_div(make_mul(n->b, da), n->a)));
+        }
+      case FUNCTION:
+        {
+          node_t a = n->a;
+          node_t d;
+          switch (n->function) {
+            case ABS: d = make_function(SIGN, a); break;
+            case SIGN: return constant(0.);
+            case EXP: d = n; break;
+            case LOG: d = make_div(constant(1.), a); break;
+            case LOG1P: d = make_div(constant(1.), make_add(constant(1.), a)); break;
+            case SQRT: d = make_div(constant(.5), n); break;
+            case TANH: d = make_sub(constant(1.), make_pow(n, constant(2.))); break;
+            case SINH: d = make_function(COSH, a); break;
+            case COSH: d = make_function(SINH, a); break;
+            case SIN: d = make_function(COS, a); break;
+            case COS: d = make_neg(make_function(SIN, a)); break;
+            case ERF: d = make_mul(constant(1.1283791670955126),
+                          make_function(EXP, make_neg(make_pow(a, constant(2.))))); break;
+            default: throw std::logic_error("unknown function in formula");
+          }
+          node_t da = derive(a);
+          if (is_constant(da, 1.)) return d;
+          return make_mul(d, da);
+        }
+    }
+    throw std::logic_error("unknown node in formula");
+  }
+
+  /**
+   * Precedence of the top node, for printing
+   */
+  int precedence(const node_t& n) {
+    switch (n->kind) {
+      case ADD: case SUB: return 1;
+      case MUL: case DIV: return 2;
+      case NEGATE: return 3;
+      case POW: return 4;
+      case CONSTANT: return n->value < 0. ? 3 : 5;
+      default: return 5;
+    }
+  }
+
+  std::string print(const node_t& n, const std::string& variable,
+      const std::vector<std::string>& names);
+
+  std::string print(const node_t& n, int min, const std::string& variable,
+      const std::vector<std::string>& names) {
+    std::string retval = print(n, variable, names);
+    if (precedence(n) < min) return "(" + retval + ")";
+    return retval;
+  }
+
+  std::string print(const node_t& n, const std::string& variable,
+      const std::vector<std::string>& names) {
+    static const char* const op[] = { 0, 0, 0, 0, " + ", " - ", " * ", " / ", "^" };
+    switch (n->kind) {
+      case CONSTANT: return (boost::format("%.10g") % n->value).str();
+      case VARIABLE: return variable;
+      case PARAMETER: return names[n->index];
+      case NEGATE: return "-" + print(n->a, 3, variable, names);
+      case FUNCTION: return std::string(function_names[n->function]) + "(" + print(n->a, variable, names) + ")";
+      case POW: return print(n->a, 5, variable, names) + op[n->kind] + print(n->b, 3, variable, names);
+      default:
+        {
+          int p = precedence(n);
+          bool exclusive = (n->kind == SUB || n->kind == DIV);
+          return print(n->a, p, variable, names) + op[n->kind] +
+            print(n->b, exclusive ? p+1 : p, variable, names);
+        }
+    }
+  }
+
+  /*****************************
+   * Parser                    *
+   *****************************/
+
+  /**
+   * Recursive descent parser for formulas:
+   *
+   *   expression := term (('+' | '-') term)*
+   *   term := unary (('*' | '/') unary)*
+   *   unary := ('-' | '+') unary | power
+   *   power := primary (('^' | '**') unary)?
+   *   primary := number | name | function '(' expression ')' | '(' expression ')'
+   */
+  class Parser {
+
+    public:
+
+      Parser(const std::string& text, const std::vector<std::string>& variables,
+          const std::vector<std::string>& names):
+        m_text(text), m_pos(0), m_variables(variables), m_names(names) {}
+
+      node_t parse() {
+        node_t retval = expression();
+        skip();
+        if (m_pos < m_text.size()) error("unexpected `" + m_text.substr(m_pos, 1) + "'");
+        return retval;
+      }
+
+      /**
+       * The name of the variable used, or an empty string
+       */
+      const std::string& variable() const { return m_variable; }
+
+    private:
+
+      void error(const std::string& message) const {
+        boost::format m("cannot parse formula `%s': %s at position %u");
+        m % m_text % message % m_pos;
+        throw std::runtime_error(m.str());
+      }
+
+      void skip() {
+        while (m_pos < m_text.size() && std::isspace((unsigned char)m_text[m_pos])) ++m_pos;
+      }
+
+      bool accept(const char* token) {
+        skip();
+        std::size_t n = std::strlen(token);
+        if (m_text.compare(m_pos, n, token) != 0) return false;
+        m_pos += n;
+        return true;
+      }
+
+      void expect(const char* token) {
+        if (!accept(token)) error(std::string("expected `") + token + "'");
+      }
+
+      node_t expression() {
+        node_t retval = term();
+        while (true) {
+          if (accept("+")) retval = node(ADD, retval, term());
+          else if (accept("-")) retval = node(SUB, retval, term());
+          else return retval;
+        }
+      }
+
+      node_t term() {
+        node_t retval = unary();
+        while (true) {
+          skip();
+          if (m_text.compare(m_pos, 2, "**") == 0) return retval; // power
+          if (accept("*")) retval = node(MUL, retval, unary());
+          else if (accept("/")) retval = node(DIV, retval, unary());
+          else return retval;
+        }
+      }
+
+      node_t unary() {
+        if (accept("-")) return make_neg(unary());
+        if (accept("+")) return unary();
+        return power();
+      }
+
+      node_t power() {
+        node_t retval = primary();
+        if (accept("^") || accept("**")) return node(POW, retval, unary());
+        return retval;
+      }
+
+      node_t primary() {
+
+        skip();
+        if (m_pos >= m_text.size()) error("unexpected end of formula");
+
+        if (accept("(")) {
+          node_t retval = expression();
+          expect(")");
+          return retval;
+        }
+
+        char c = m_text[m_pos];
+
+        if (std::isdigit((unsigned char)c) || c == '.') {
+          const char* start = m_text.c_str() + m_pos;
+          char* end = 0;
+          double value = std::strtod(start, &end);
+          if (end == start) error("invalid number");
+          m_pos += end - start;
+          return constant(value);
+        }
+
+        if (!(std::isalpha((unsigned char)c) || c == '_')) error(std::string("unexpected `") + c + "'");
+
+        std::size_t start = m_pos;
+        while (m_pos < m_text.size() &&
+            (std::isalnum((unsigned char)m_text[m_pos]) || m_text[m_pos] == '_')) ++m_pos;
+        std::string name = m_text.substr(start, m_pos - start);
+
+        if (std::find(m_variables.begin(), m_variables.end(), name) != m_variables.end()) {
+          if (!m_variable.empty() && m_variable != name) {
+            m_pos = start;
+            error("uses both `" + m_variable + "' and `" + name + "' as the input");
+          }
+          m_variable = name;
+          return leaf(VARIABLE);
+        }
+
+        auto parameter = std::find(m_names.begin(), m_names.end(), name);
+        if (parameter != m_names.end()) return leaf(PARAMETER, 0., parameter - m_names.begin());
+
+        for (std::size_t k=0; k<FUNCTIONS; ++k) {
+          if (name != function_names[k]) continue;
+          expect("(");
+          node_t argument = expression();
+          expect(")");
+          return node(FUNCTION, argument, node_t(), (Function)k);
+        }
+
+        if (name == "pi") return constant(M_PI);
+        if (name == "e") return constant(M_E);
+
+        m_pos = start;
+        error("unknown name `" + name + "'");
+        return node_t();
+
+      }
+
+    private:
+
+      const std::string& m_text;
+      std::size_t m_pos;
+      const std::vector<std::string>& m_variables;
+      const std::vector<std::string>& m_names;
+      std::string m_variable;
+
+  };
+
+  /**
+   * Simplifies a parsed tree, folding constants
+   */
+  node_t simplify(const node_t& n) {
+    switch (n->kind) {
+      case NEGATE: return make_neg(simplify(n->a));
+      case ADD: return make_add(simplify(n->a), simplify(n->b));
+      case SUB: return make_sub(simplify(n->a), simplify(n->b));
+      case MUL: return make_mul(simplify(n->a), simplify(n->b));
+      case DIV: return make_div(simplify(n->a), simplify(n->b));
+      case POW: return make_pow(simplify(n->a), simplify(n->b));
+      case FUNCTION: return make_function(n->function, simplify(n->a));
+      default: return n;
+    }
+  }
+
+  /*****************************
+   * Bytecode                  *
+   *****************************/
+
+  /**
+   * Instructions of the stack machine. Each operates on whole blocks: "push"
+   * instructions add a block to the stack, unary ones replace the top block
+   * and binary ones replace the two top blocks by their result. Variants
+   * ending in K take their second operand from the instruction, those
+   * starting with R take it as the first operand.
+   */
+  enum Op {
+    OP_INPUT, OP_CONST,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+    OP_ADDK, OP_SUBK, OP_MULK, OP_DIVK, OP_POWK, OP_SQUARE,
+    OP_RSUBK, OP_RDIVK, OP_RPOWK,
+    OP_NEG,
+    OP_FUNCTION ///< followed by one opcode per Function
+  };
+
+  struct Instruction {
+    int op;
+    double k;
+  };
+
+  struct Program {
+    std::vector<Instruction> code;
+    std::size_t depth; ///< maximum number of blocks on the stack
+  };
+
+  /**
+   * Returns if the node has a fixed value, and which
+   */
+  bool fixed(const node_t& n, const std::vector<double>& values, double& value) {
+    if (n->kind == CONSTANT) { value = n->value; return true; }
+    if (n->kind == PARAMETER) { value = values[n->index]; return true; }
+    return false;
+  }
+
+  void emit(Program& p, std::size_t& sp, int op, double k=0.) {
+    Instruction i = { op, k };
+    p.code.push_back(i);
+    if (op == OP_INPUT || op == OP_CONST) p.depth = std::max(p.depth, ++sp);
+    else if (op >= OP_ADD && op <= OP_POW) --sp;
+  }
+
+  void emit(Program& p, std::size_t& sp, const node_t& n, const std::vector<double>& values) {
+
+    double k;
+    if (fixed(n, values, k)) return emit(p, sp, OP_CONST, k);
+
+    switch (n->kind) {
+      case VARIABLE:
+        return emit(p, sp, OP_INPUT);
+      case NEGATE:
+        emit(p, sp, n->a, values);
+        return emit(p, sp, OP_NEG);
+      case FUNCTION:
+        emit(p, sp, n->a, values);
+        return emit(p, sp, OP_FUNCTION + n->function);
+      default:
+        break;
+    }
+
+    const int offset = n->kind - ADD; // ADD, SUB, MUL, DIV, POW
+
+    if (fixed(n->b, values, k)) {
+      emit(p, sp, n->a, values);
+      if (n->kind == POW && k == 2.) return emit(p, sp, OP_SQUARE);
+      return emit(p, sp, OP_ADDK + offset, k);
+    }
+
+    if (fixed(n->a, values, k)) {
+      emit(p, sp, n->b, values);
+      switch (n->kind) {
+        case ADD: return emit(p, sp, OP_ADDK, k);
+        case MUL: return emit(p, sp, OP_MULK, k);
+        case SUB: return emit(p, sp, OP_RSUBK, k);
+        case DIV: return emit(p, sp, OP_RDIVK, k);
+        default: return emit(p, sp, OP_RPOWK, k);
+      }
+    }
+
+    emit(p, sp, n->a, values);
+    emit(p, sp, n->b, values);
+    emit(p, sp, OP_ADD + offset);
+
+  }
+
+  Program compile(const node_t& n, const std::vector<double>& values) {
+    Program retval;
+    retval.depth = 0;
+    std::size_t sp = 0;
+    emit(retval, sp, n, values);
+    return retval;
+  }
+
+  /**
+   * Evaluates the program for the @c n inputs at @c z (every @c zs), writing
+   * results to @c out (every @c os). Inputs of a block are all read before
+   * its outputs are written, so @c z and @c out may be the same.
+   */
+  void run(const Program& p, const double* z, std::ptrdiff_t zs, double* out,
+      std::ptrdiff_t os, std::size_t n) {
+
+    if (!n) return;
+
+    const std::size_t block = std::min(n, BLOCK);
+    double local[LOCAL];
+    std::vector<double> heap;
+    double* stack = local;
+    if (p.depth * block > LOCAL) {
+      heap.resize(p.depth * block);
+      stack = &heap[0];
+    }
+
+    const Instruction* begin = &p.code[0];
+    const Instruction* end = begin + p.code.size();
+
+    for (std::size_t start=0; start<n; start+=block) {
+
+      const std::size_t m = std::min(block, n - start);
+      const double* zb = z + (std::ptrdiff_t)start * zs;
+      double* x = 0; // top of the stack
+      double* y; // operand under the top, for binary instructions
+
+      for (const Instruction* i=begin; i<end; ++i) {
+        const double k = i->k;
+        switch (i->op) {
+          case OP_INPUT:
+            x = x ? x + block : stack;
+            if (zs == 1) std::copy(zb, zb + m, x);
+            else for (std::size_t j=0; j<m; ++j) x[j] = zb[j*zs];
+            break;
+          case OP_CONST:
+            x = x ? x + block : stack;
+            std::fill(x, x + m, k);
+            break;
+          case OP_ADD: y = x; x -= block; for (std::size_t j=0; j<m; ++j) x[j] += y[j]; break;
+          case OP_SUB: y = x; x -= block; for (std::size_t j=0; j<m; ++j) x[j] -= y[j]; break;
+          case OP_MUL: y = x; x -= block; for (std::size_t j=0; j<m; ++j) x[j] *= y[j]; break;
+          case OP_DIV: y = x; x -= block; for (std::size_t j=0; j<m; ++j) x[j] /= y[j]; break;
+          case OP_POW: y = x; x -= block; for (std::size_t j=0; j<m; ++j) x[j] = std::pow(x[j], y[j]); break;
+          case OP_ADDK: for (std::size_t j=0; j<m; ++j) x[j] += k; break;
+          case OP_SUBK: for (std::size_t j=0; j<m; ++j) x[j] -= k; break;
+          case OP_MULK: for (std::size_t j=0; j<m; ++j) x[j] *= k; break;
+          case OP_DIVK: for (std::size_t j=0; j<m; ++j) x[j] /= k; break;
+          case OP_POWK: for (std::size_t j=0; j<m; ++j) x[j] = std::pow(x[j], k); break;
+          case OP_SQUARE: for (std::size_t j=0; j<m; ++j) x[j] *= x[j]; break;
+          case OP_RSUBK: for (std::size_t j=0; j<m; ++j) x[j] = k - x[j]; break;
+          case OP_RDIVK: for (std::size_t j=0; j<m; ++j) x[j] = k / x[j]; break;
+          case OP_RPOWK: for (std::size_t j=0; j<m; ++j) x[j] = std::pow(k, x[j]); break;
+          case OP_NEG: for (std::size_t j=0; j<m; ++j) x[j] = -x[j]; break;
+          case OP_FUNCTION + ABS: for (std::size_t j=0; j<m; ++j) x[j] = std::fabs(x[j]); break;
+          case OP_FUNCTION + SIGN: for (std::size_t j=0; j<m; ++j) x[j] = (x[j] > 0.) - (x[j] < 0.); break;
+          case OP_FUNCTION + EXP: for (std::size_t j=0; j<m; ++j) x[j] = std::exp(x[j]); break;
+          case OP_FUNCTION + LOG: for (std::size_t j=0; j<m; ++j) x[j] = std::log(x[j]); break;
+          case OP_FUNCTION + LOG1P: for (std::size_t j=0; j<m; ++j) x[j] = std::log1p(x[j]); break;
+          case OP_FUNCTION + SQRT: for (std::size_t j=0; j<m; ++j) x[j] = std::sqrt(x[j]); break;
+          case OP_FUNCTION + TANH: for (std::size_t j=0; j<m; ++j) x[j] = std::tanh(x[j]); break;
+          case OP_FUNCTION + SINH: for (std::size_t j=0; j<m; ++j) x[j] = std::sinh(x[j]); break;
+          case OP_FUNCTION + COSH: for (std::size_t j=0; j<m; ++j) x[j] = std::cosh(x[j]); break;
+          case OP_FUNCTION + SIN: for (std::size_t j=0; j<m; ++j) x[j] = std::sin(x[j]); break;
+          case OP_FUNCTION + COS: for (std::size_t j=0; j<m; ++j) x[j] = std::cos(x[j]); break;
+          case OP_FUNCTION + ERF: for (std::size_t j=0; j<m; ++j) x[j] = std::erf(x[j]); break;
+        }
+      }
+
+      double* o = out + (std::ptrdiff_t)start * os;
+      if (os == 1) std::copy(stack, stack + m, o);
+      else for (std::size_t j=0; j<m; ++j) o[j*os] = stack[j];
+
+    }
+
+  }
+
+}
+
+/**
+ * The parsed, differentiated and compiled formulas of a FormulaActivation
+ */
+struct bob::learn::activation::CompiledFormula {
+
+  std::string formula; ///< as given
+  std::string f_prime_from_f; ///< as given
+  std::vector<std::string> names; ///< of the parameters
+  std::vector<double> values; ///< of the parameters
+  std::string variable; ///< name of the input in @c formula
+
+  node_t f_tree;
+  node_t f_prime_tree;
+  node_t f_second_tree;
+  Program f;
+  Program f_prime;
+  Program f_second;
+  Program f_prime_from_f_program; ///< empty if not given
+
+};
+
+static bool is_reserved(const std::string& name) {
+  if (name == "z" || name == "x" || name == "a" || name == "pi" || name == "e") return true;
+  for (std::size_t k=0; k<FUNCTIONS; ++k) if (name == function_names[k]) return true;
+  return false;
+}
+
+static boost::shared_ptr<const bob::learn::activation::CompiledFormula> compile
+(const std::string& formula, const std::vector<std::string>& names,
+ const std::vector<double>& values, const std::string& f_prime_from_f) {
+
+  if (names.size() != values.size()) {
+    boost::format m("formula `%s' has %u parameter name(s), but %u value(s)");
+    m % formula % names.size() % values.size();
+    throw std::runtime_error(m.str());
+  }
+
+  for (std::size_t k=0; k<names.size(); ++k) {
+    const std::string& name = names[k];
+    bool valid = !name.empty() && !std::isdigit((unsigned char)name[0]);
+    for (std::size_t j=0; valid && j<name.size(); ++j)
+      valid = std::isalnum((unsigned char)name[j]) || name[j] == '_';
+    if (!valid || is_reserved(name) || std::find(names.begin(), names.begin()+k, name) != names.begin()+k) {
+      boost::format m("`%s' cannot name a parameter of formula `%s'");
+      m % name % formula;
+      throw std::runtime_error(m.str());
+    }
+  }
+
+  auto retval = boost::make_shared<bob::learn::activation::CompiledFormula>();
+  retval->formula = formula;
+  retval->f_prime_from_f = f_prime_from_f;
+  retval->names = names;
+  retval->values = values;
+
+  std::vector<std::string> variables;
+  variables.push_back("z");
+  variables.push_back("x");
+  Parser parser(formula, variables, names);
+  retval->f_tree = simplify(parser.parse());
+  retval->variable = parser.variable().empty() ? "z" : parser.variable();
+  retval->f_prime_tree = derive(retval->f_tree);
+  retval->f_second_tree = derive(retval->f_prime_tree);
+  retval->f = compile(retval->f_tree, values);
+  retval->f_prime = compile(retval->f_prime_tree, values);
+  retval->f_second = compile(retval->f_second_tree, values);
+
+  if (!f_prime_from_f.empty()) {
+    std::vector<std::string> variables(1, "a");
+    Parser parser(f_prime_from_f, variables, names);
+    retval->f_prime_from_f_program = compile(simplify(parser.parse()), values);
+  }
+
+  return retval;
+
+}
+
+bob::learn::activation::FormulaActivation::FormulaActivation
+(const std::string& formula, const std::vector<std::string>& names,
+ const std::vector<double>& values, const std::string& f_prime_from_f):
+  m_compiled(compile(formula, names, values, f_prime_from_f))
+{
+}
+
+bob::learn::activation::FormulaActivation::~FormulaActivation() {}
+
+double bob::learn::activation::FormulaActivation::f (double z) const {
+  double a;
+  run(m_compiled->f, &z, 1, &a, 1, 1);
+  return a;
+}
+
+double bob::learn::activation::FormulaActivation::f_prime (double z) const {
+  double d;
+  run(m_compiled->f_prime, &z, 1, &d, 1, 1);
+  return d;
+}
+
+double bob::learn::activation::FormulaActivation::f_second (double z) const {
+  double d;
+  run(m_compiled->f_second, &z, 1, &d, 1, 1);
+  return d;
+}
+
+double bob::learn::activation::FormulaActivation::f_prime_from_f (double a) const {
+  double d;
+  f_prime_from_f_batch(&a, 1, &d, 1, 1);
+  return d;
+}
+
+void bob::learn::activation::FormulaActivation::f_batch (const double* z,
+    std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const {
+  run(m_compiled->f, z, zs, a, as, n);
+}
+
+void bob::learn::activation::FormulaActivation::f_prime_batch (const double* z,
+    std::ptrdiff_t zs, double* d, std::ptrdiff_t ds, std::size_t n) const {
+  run(m_compiled->f_prime, z, zs, d, ds, n);
+}
+
+void bob::learn::activation::FormulaActivation::f_second_batch (const double* z,
+    std::ptrdiff_t zs, double* d, std::ptrdiff_t ds, std::size_t n) const {
+  run(m_compiled->f_second, z, zs, d, ds, n);
+}
+
+void bob::learn::activation::FormulaActivation::f_prime_from_f_batch
+(const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const {
+  if (m_compiled->f_prime_from_f_program.code.empty()) {
+    boost::format m("the derivative of %s cannot be computed from the activated value - give a formula for it in terms of `a'");
+    m % str();
+    throw std::runtime_error(m.str());
+  }
+  run(m_compiled->f_prime_from_f_program, a, as, d, ds, n);
+}
+
+const std::string& bob::learn::activation::FormulaActivation::formula() const {
+  return m_compiled->formula;
+}
+
+std::string bob::learn::activation::FormulaActivation::derivative() const {
+  return print(m_compiled->f_prime_tree, m_compiled->variable, m_compiled->names);
+}
+
+std::string bob::learn::activation::FormulaActivation::second_derivative() const {
+  return print(m_compiled->f_second_tree, m_compiled->variable, m_compiled->names);
+}
+
+const std::string& bob::learn::activation::FormulaActivation::f_prime_from_f_formula() const {
+  return m_compiled->f_prime_from_f;
+}
+
+const std::vector<std::string>& bob::learn::activation::FormulaActivation::names() const {
+  return m_compiled->names;
+}
+
+std::vector<double> bob::learn::activation::FormulaActivation::parameters() const {
+  return m_compiled->values;
+}
+
+void bob::learn::activation::FormulaActivation::save(bob::io::base::HDF5File& f) const {
+  Activation::save(f);
+  f.set("formula", m_compiled->formula);
+  if (!m_compiled->f_prime_from_f.empty()) f.set("f_prime_from_f", m_compiled->f_prime_from_f);
+  if (m_compiled->names.empty()) return;
+  std::string names;
+  for (std::size_t k=0; k<m_compiled->names.size(); ++k) names += (k ? " " : "") + m_compiled->names[k];
+  f.set("names", names);
+  blitz::Array<double,1> values(m_compiled->values.size());
+  std::copy(m_compiled->values.begin(), m_compiled->values.end(), values.data());
+  f.setArray("parameters", values);
+}
+
+void bob::learn::activation::FormulaActivation::load(bob::io::base::HDF5File& f) {
+  std::string formula = f.read<std::string>("formula");
+  std::string f_prime_from_f;
+  if (f.contains("f_prime_from_f")) f_prime_from_f = f.read<std::string>("f_prime_from_f");
+  std::vector<std::string> names;
+  std::vector<double> values;
+  if (f.contains("names")) {
+    std::istringstream stream(f.read<std::string>("names"));
+    std::string name;
+    while (stream >> name) names.push_back(name);
+    blitz::Array<double,1> p = f.readArray<double,1>("parameters");
+    values.assign(p.data(), p.data() + p.numElements());
+  }
+  m_compiled = compile(formula, names, values, f_prime_from_f);
+}
+
+bool bob::learn::activation::FormulaActivation::equals (const Activation& other) const {
+  if (typeid(other) != typeid(*this)) return false;
+  auto& o = *static_cast<const FormulaActivation&>(other).m_compiled;
+  auto& c = *m_compiled;
+  if (o.formula != c.formula || o.f_prime_from_f != c.f_prime_from_f ||
+      o.names != c.names) return false;
+  for (std::size_t k=0; k<c.values.size(); ++k)
+    if (!same_parameter(o.values[k], c.values[k])) return false;
+  return true;
+}
+
+std::size_t bob::learn::activation::FormulaActivation::hash () const {
+  std::size_t retval = Activation::hash();
+  boost::hash_combine(retval, m_compiled->formula);
+  boost::hash_combine(retval, m_compiled->f_prime_from_f);
+  return retval;
+}
+
+boost::shared_ptr<bob::learn::activation::Activation> bob::learn::activation::FormulaActivation::clone() const {
+  return boost::make_shared<FormulaActivation>(*this);
+}
+
+std::string bob::learn::activation::FormulaActivation::str() const {
+  const CompiledFormula& c = *m_compiled;
+  std::string retval = "f(" + c.variable + ") = " + c.formula;
+  for (std::size_t k=0; k<c.names.size(); ++k)
+    retval += (boost::format("%s%s = %.5e") % (k ? ", " : " [") % c.names[k] % c.values[k]).str();
+  return c.names.empty() ? retval : retval + "]";
+}
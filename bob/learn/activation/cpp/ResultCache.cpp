@@ -0,0 +1,187 @@
+/**
+ * @date Mon 19 Oct 2026 14:03:18 CEST
+ *
+ * @brief Implementation of the cache of results of activation functions
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/ResultCache.h>
+#include <cstring>
+#include <utility>
+
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t load64(const unsigned char* p) {
+  uint64_t retval;
+  std::memcpy(&retval, p, sizeof(retval));
+  return retval;
+}
+
+static inline uint64_t mix(uint64_t acc, uint64_t input) {
+  return rotl(acc + input * PRIME2, 31) * PRIME1;
+}
+
+static inline uint64_t merge(uint64_t acc, uint64_t lane) {
+  return (acc ^ mix(0, lane)) * PRIME1 + PRIME4;
+}
+
+uint64_t bob::learn::activation::ResultCache::hash(const void* data,
+    std::size_t bytes, uint64_t seed) {
+
+  // xxHash64: four independent lanes over 32-byte stripes keep the loop
+  // bound by memory bandwidth rather than by the latency of multiplications
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+  const unsigned char* end = p + bytes;
+  uint64_t retval;
+
+  if (bytes >= 32) {
+    uint64_t v1 = seed + PRIME1 + PRIME2;
+    uint64_t v2 = seed + PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = mix(v1, load64(p));
+      v2 = mix(v2, load64(p + 8));
+      v3 = mix(v3, load64(p + 16));
+      v4 = mix(v4, load64(p + 24));
+    }
+    retval = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    retval = merge(retval, v1);
+    retval = merge(retval, v2);
+    retval = merge(retval, v3);
+    retval = merge(retval, v4);
+  }
+  else retval = seed + PRIME5;
+
+  retval += bytes;
+
+  for (; p + 8 <= end; p += 8)
+    retval = rotl(retval ^ mix(0, load64(p)), 27) * PRIME1 + PRIME4;
+  if (p + 4 <= end) {
+    uint32_t k;
+    std::memcpy(&k, p, sizeof(k));
+    retval = rotl(retval ^ (uint64_t(k) * PRIME1), 23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  for (; p < end; ++p)
+    retval = rotl(retval ^ (uint64_t(*p) * PRIME5), 11) * PRIME1;
+
+  retval ^= retval >> 33;
+  retval *= PRIME2;
+  retval ^= retval >> 29;
+  retval *= PRIME3;
+  retval ^= retval >> 32;
+  return retval;
+
+}
+
+/**
+ * Hashes the input, seeded by the method and the shape, so that equal
+ * inputs of different shapes or methods hash differently
+ */
+static uint64_t key(bob::learn::activation::Method m,
+    const std::vector<std::size_t>& shape, const double* z, std::size_t n) {
+  uint64_t seed = bob::learn::activation::ResultCache::hash(shape.data(),
+      shape.size()*sizeof(std::size_t), static_cast<uint64_t>(m));
+  return bob::learn::activation::ResultCache::hash(z, n*sizeof(double), seed);
+}
+
+bob::learn::activation::ResultCache::ResultCache(std::size_t entries,
+    std::size_t bytes):
+  m_max_entries(entries),
+  m_max_bytes(bytes)
+{
+  std::memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+boost::shared_array<double> bob::learn::activation::ResultCache::find(Method m,
+    const std::vector<std::size_t>& shape, const double* z, std::size_t n,
+    uint64_t& hash) {
+
+  hash = key(m, shape, z, n);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_index.find(hash);
+  if (it == m_index.end()) {
+    ++m_statistics.misses;
+    return boost::shared_array<double>();
+  }
+
+  const Entry& entry = *it->second;
+  if (entry.method != m || entry.shape != shape || entry.input.size() != n ||
+      (n && std::memcmp(&entry.input[0], z, n*sizeof(double)))) {
+    ++m_statistics.collisions;
+    ++m_statistics.misses;
+    return boost::shared_array<double>();
+  }
+
+  ++m_statistics.hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return entry.result;
+
+}
+
+void bob::learn::activation::ResultCache::erase(list_type::iterator it) {
+  m_statistics.bytes -= 2*it->input.size()*sizeof(double);
+  --m_statistics.entries;
+  m_index.erase(it->hash);
+  m_entries.erase(it);
+}
+
+void bob::learn::activation::ResultCache::insert(Method m,
+    const std::vector<std::size_t>& shape, const double* z, std::size_t n,
+    uint64_t hash, const double* result) {
+
+  std::size_t bytes = 2*n*sizeof(double);
+  if (!m_max_entries || bytes > m_max_bytes) return;
+
+  // copies outside of the lock
+  Entry entry;
+  entry.hash = hash;
+  entry.method = m;
+  entry.shape = shape;
+  entry.input.assign(z, z+n);
+  entry.result.reset(new double[n]);
+  std::memcpy(entry.result.get(), result, n*sizeof(double));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // replaces a colliding entry, or one inserted by another thread since
+  auto it = m_index.find(hash);
+  if (it != m_index.end()) erase(it->second);
+
+  while (!m_entries.empty() && (m_statistics.entries >= m_max_entries ||
+        m_statistics.bytes + bytes > m_max_bytes)) {
+    erase(--m_entries.end());
+    ++m_statistics.evictions;
+  }
+
+  m_entries.push_front(std::move(entry));
+  m_index[hash] = m_entries.begin();
+  ++m_statistics.entries;
+  m_statistics.bytes += bytes;
+
+}
+
+void bob::learn::activation::ResultCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_statistics.entries = 0;
+  m_statistics.bytes = 0;
+}
+
+bob::learn::activation::ResultCacheStatistics bob::learn::activation::ResultCache::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
@@ -0,0 +1,129 @@
+/**
+ * @date Wed 14 Oct 2026 11:20:05 CEST
+ *
+ * @brief Implementation of activation statistics
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Statistics.h>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * Number of values activated and accumulated at once, small enough for the
+ * outputs to be still in the L1 cache when accumulated
+ */
+static const std::size_t BLOCK = 512;
+
+bob::learn::activation::Statistics::Statistics(std::size_t bins,
+    double lower, double upper):
+  m_lower(lower),
+  m_upper(upper),
+  m_histogram(bins)
+{
+  if (bins == 0) throw std::runtime_error("statistics need at least one histogram bin");
+  if (!(lower < upper)) {
+    boost::format m("the lower bound of the histogram (%g) must be smaller than its upper bound (%g)");
+    m % lower % upper;
+    throw std::runtime_error(m.str());
+  }
+  reset();
+}
+
+void bob::learn::activation::Statistics::reset() {
+  m_count = 0;
+  m_mean = 0.;
+  m_m2 = 0.;
+  m_min = std::numeric_limits<double>::infinity();
+  m_max = -std::numeric_limits<double>::infinity();
+  m_saturated = 0;
+  std::fill(m_histogram.begin(), m_histogram.end(), 0);
+}
+
+/**
+ * Merges a partial (count, mean, m2) into a running one
+ */
+static void merge_moments(std::size_t& count, double& mean, double& m2,
+    std::size_t n, double n_mean, double n_m2) {
+  if (!n) return;
+  std::size_t total = count + n;
+  double delta = n_mean - mean;
+  mean += delta * n / total;
+  m2 += n_m2 + delta * delta * ((double)count * n / total);
+  count = total;
+}
+
+void bob::learn::activation::Statistics::accumulate(const double* a,
+    std::ptrdiff_t as, std::size_t n, double sat_lower, double sat_upper) {
+
+  const std::size_t last = m_histogram.size() - 1;
+  const double scale = m_histogram.size() / (m_upper - m_lower);
+
+  for (std::size_t start=0; start<n; start+=BLOCK) {
+
+    std::size_t length = std::min(BLOCK, n-start);
+    const double* block = a + start*as;
+
+    // first pass: sum, extrema, saturation and histogram
+    double sum = 0.;
+    const double* p = block;
+    for (std::size_t k=0; k<length; ++k, p+=as) {
+      double v = *p;
+      sum += v;
+      if (v < m_min) m_min = v;
+      if (v > m_max) m_max = v;
+      if (v < sat_lower || v > sat_upper) ++m_saturated;
+      std::size_t bin = 0;
+      if (v >= m_upper) bin = last;
+      else if (v >= m_lower) bin = std::min(last, (std::size_t)((v - m_lower) * scale));
+      ++m_histogram[bin];
+    }
+
+    // second pass, over the cached block: deviations from the block mean
+    double block_mean = sum / length;
+    double block_m2 = 0.;
+    p = block;
+    for (std::size_t k=0; k<length; ++k, p+=as) {
+      double d = *p - block_mean;
+      block_m2 += d * d;
+    }
+
+    merge_moments(m_count, m_mean, m_m2, length, block_mean, block_m2);
+
+  }
+
+}
+
+void bob::learn::activation::Statistics::merge(const Statistics& other) {
+
+  if (other.m_histogram.size() != m_histogram.size() ||
+      other.m_lower != m_lower || other.m_upper != m_upper) {
+    throw std::runtime_error("cannot merge activation statistics with different histogram configurations");
+  }
+
+  merge_moments(m_count, m_mean, m_m2, other.m_count, other.m_mean, other.m_m2);
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  m_saturated += other.m_saturated;
+  for (std::size_t k=0; k<m_histogram.size(); ++k) m_histogram[k] += other.m_histogram[k];
+
+}
+
+void bob::learn::activation::f_batch_with_statistics
+(const bob::learn::activation::Activation& activation,
+ const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as,
+ std::size_t n, bob::learn::activation::Statistics& stats) {
+
+  double sat_lower, sat_upper;
+  activation.saturation(sat_lower, sat_upper);
+
+  for (std::size_t start=0; start<n; start+=BLOCK) {
+    std::size_t length = std::min(BLOCK, n-start);
+    activation.f_batch(z + start*zs, zs, a + start*as, as, length);
+    stats.accumulate(a + start*as, as, length, sat_lower, sat_upper);
+  }
+
+}
@@ -0,0 +1,186 @@
+/**
+ * @date Mon 12 Oct 2026 10:12:44 CEST
+ *
+ * @brief Implementation of out-of-core activation streaming
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Stream.h>
+#include <bob.learn.activation/Counters.h>
+#include <bob.learn.activation/Trace.h>
+#include <boost/format.hpp>
+#include <future>
+#include <algorithm>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/**
+ * Entries smaller than this are computed in the calling thread, as handing
+ * them over to a helper thread costs more than it overlaps
+ */
+static const std::size_t ASYNC_THRESHOLD = 1 << 16;
+
+/**
+ * Default tile size for stream_mapped(), in elements (4 MiB of doubles)
+ */
+static const std::size_t DEFAULT_TILE = (1 << 22) / sizeof(double);
+
+template <int N> static void stream_hdf5_entries
+(const bob::learn::activation::Activation& activation,
+ bob::learn::activation::Method m,
+ bob::io::base::HDF5File& in, const std::string& in_path,
+ bob::io::base::HDF5File& out, const std::string& out_path,
+ std::size_t size, bool expandable) {
+
+  blitz::Array<double,N> input[2];
+  blitz::Array<double,N> output[2];
+
+  input[0].reference(in.readArray<double,N>(in_path, 0));
+  input[1].resize(input[0].shape());
+  output[0].resize(input[0].shape());
+  output[1].resize(input[0].shape());
+
+  for (std::size_t pos=0; pos<size; ++pos) {
+
+    const blitz::Array<double,N>& z = input[pos%2];
+    blitz::Array<double,N>& a = output[pos%2];
+
+    bool async = z.numElements() >= ASYNC_THRESHOLD;
+    auto compute = [&activation, m, &z, &a, async]() {
+      bob::learn::activation::CallTimer timer(activation, m,
+          async ? bob::learn::activation::PARALLEL : bob::learn::activation::SERIAL,
+          z.numElements());
+      bob::learn::activation::TraceSpan span(activation, m, "hdf5", N,
+          z.shape().data());
+      activation.batch(m, z.data(), 1, a.data(), 1, z.numElements());
+    };
+
+    std::future<void> job;
+    if (async) job = std::async(std::launch::async, compute);
+    else compute();
+
+    // overlaps I/O with the computation above
+    if (pos+1 < size) in.readArray(in_path, pos+1, input[(pos+1)%2]);
+    if (pos > 0) out.appendArray(out_path, output[(pos-1)%2]);
+
+    if (job.valid()) job.get();
+
+  }
+
+  if (expandable) out.appendArray(out_path, output[(size-1)%2]);
+  else out.setArray(out_path, output[(size-1)%2]);
+
+}
+
+void bob::learn::activation::stream_hdf5
+(const bob::learn::activation::Activation& activation,
+ bob::learn::activation::Method m,
+ bob::io::base::HDF5File& in, const std::string& in_path,
+ bob::io::base::HDF5File& out, const std::string& out_path,
+ std::size_t limit) {
+
+  if (out.contains(out_path)) {
+    boost::format s("output dataset `%s' already exists at file `%s'");
+    s % out_path % out.filename();
+    throw std::runtime_error(s.str());
+  }
+
+  const bob::io::base::HDF5Descriptor& d = in.describe(in_path)[0];
+
+  if (d.size == 0) return;
+
+  if (!d.expandable && d.type.shape().product() * sizeof(double) > limit) {
+    boost::format s("dataset `%s' at file `%s' is not expandable and holds %lu bytes, more than the %lu bytes it may be loaded whole with - store it as an expandable dataset (e.g. by appending its rows) to stream it entry by entry, or raise the limit");
+    s % in_path % in.filename() % (d.type.shape().product() * sizeof(double)) % limit;
+    throw std::runtime_error(s.str());
+  }
+
+  switch (d.type.shape().n()) {
+    case 1:
+      stream_hdf5_entries<1>(activation, m, in, in_path, out, out_path, d.size, d.expandable);
+      break;
+    case 2:
+      stream_hdf5_entries<2>(activation, m, in, in_path, out, out_path, d.size, d.expandable);
+      break;
+    case 3:
+      stream_hdf5_entries<3>(activation, m, in, in_path, out, out_path, d.size, d.expandable);
+      break;
+    case 4:
+      stream_hdf5_entries<4>(activation, m, in, in_path, out, out_path, d.size, d.expandable);
+      break;
+    default:
+      {
+        boost::format s("dataset `%s' at file `%s' has %d dimensions, but only 1, 2, 3 or 4-dimensional datasets can be streamed");
+        s % in_path % in.filename() % d.type.shape().n();
+        throw std::runtime_error(s.str());
+      }
+  }
+
+}
+
+/**
+ * Issues @c advice for all pages touching [begin, end)
+ */
+static void advise_outer(const void* begin, const void* end, int advice) {
+  static const uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t b = reinterpret_cast<uintptr_t>(begin) & ~(page-1);
+  uintptr_t e = reinterpret_cast<uintptr_t>(end);
+  if (e > b) madvise(reinterpret_cast<void*>(b), e - b, advice);
+}
+
+/**
+ * Issues @c advice for all pages fully inside [begin, end) and returns the
+ * end of the last page advised
+ */
+static const void* advise_inner(const void* begin, const void* end, int advice) {
+  static const uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t b = (reinterpret_cast<uintptr_t>(begin) + page - 1) & ~(page-1);
+  uintptr_t e = reinterpret_cast<uintptr_t>(end) & ~(page-1);
+  if (e <= b) return begin;
+  madvise(reinterpret_cast<void*>(b), e - b, advice);
+  return reinterpret_cast<const void*>(e);
+}
+
+void bob::learn::activation::stream_mapped
+(const bob::learn::activation::Activation& activation,
+ bob::learn::activation::Method m,
+ const double* z, double* a, std::size_t n, std::size_t tile,
+ bool release_input, bool release_output) {
+
+  if (!tile) tile = DEFAULT_TILE;
+
+  // everything before these was already released
+  const void* z_released = z;
+  const void* a_released = a;
+
+  advise_outer(z, z + std::min(tile, n), MADV_WILLNEED);
+  advise_outer(a, a + std::min(tile, n), MADV_WILLNEED);
+
+  for (std::size_t start=0; start<n; start+=tile) {
+
+    std::size_t length = std::min(tile, n-start);
+    std::size_t next = start + length;
+
+    // reads ahead the next tile while this one is computed
+    if (next < n) {
+      std::size_t next_length = std::min(tile, n-next);
+      advise_outer(z + next, z + next + next_length, MADV_WILLNEED);
+      advise_outer(a + next, a + next + next_length, MADV_WILLNEED);
+    }
+
+    {
+      bob::learn::activation::CallTimer timer(activation, m, bob::learn::activation::SERIAL, length);
+      bob::learn::activation::TraceSpan span(activation, m, "mapped", 1, &length);
+      activation.batch(m, z + start, 1, a + start, 1, length);
+    }
+
+    if (release_input)
+      z_released = advise_inner(z_released, z + next, MADV_DONTNEED);
+    if (release_output)
+      a_released = advise_inner(a_released, a + next, MADV_DONTNEED);
+
+  }
+
+}
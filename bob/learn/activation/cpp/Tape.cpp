@@ -0,0 +1,130 @@
+/**
+ * @date Sun 18 Oct 2026 21:15:32 CEST
+ *
+ * @brief Implementation of the tape of forward activations
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Tape.h>
+#include <bob.learn.activation/Counters.h>
+#include <bob.learn.activation/Trace.h>
+#include <boost/format.hpp>
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ * Size of the first block of a tape created without a capacity
+ */
+static const std::size_t MINIMUM_BLOCK = 1 << 12;
+
+/**
+ * Number of derivatives computed at once by the backward pass, on the stack
+ */
+static const std::size_t BACKWARD_BLOCK = 256;
+
+bob::learn::activation::Tape::Tape(std::size_t capacity):
+  m_allocations(0)
+{
+  if (capacity) allocate(capacity);
+}
+
+void bob::learn::activation::Tape::allocate(std::size_t size) {
+  Block block;
+  block.data.reset(new double[size]);
+  block.size = size;
+  block.used = 0;
+  m_blocks.push_back(block);
+  ++m_allocations;
+}
+
+double* bob::learn::activation::Tape::push
+(const boost::shared_ptr<Activation>& activation, std::size_t n) {
+
+  if (m_blocks.empty() || m_blocks.back().size - m_blocks.back().used < n) {
+    // grows geometrically, as the first iteration discovers its needs
+    allocate(std::max(std::max(n, capacity()), MINIMUM_BLOCK));
+  }
+
+  Block& block = m_blocks.back();
+  Record record;
+  record.activation = activation;
+  record.block = m_blocks.size() - 1;
+  record.data = block.data.get() + block.used;
+  record.n = n;
+  m_records.push_back(record);
+  block.used += n;
+
+  return record.data;
+
+}
+
+void bob::learn::activation::Tape::pop() {
+  if (m_records.empty()) return;
+  const Record& record = m_records.back();
+  m_blocks[record.block].used -= record.n;
+  m_records.pop_back();
+}
+
+void bob::learn::activation::Tape::rewind() {
+
+  m_records.clear();
+
+  if (m_blocks.size() > 1) {
+    std::size_t needed = used();
+    m_blocks.clear();
+    if (needed) allocate(needed);
+  }
+  else if (m_blocks.size()) {
+    m_blocks.back().used = 0;
+  }
+
+}
+
+void bob::learn::activation::Tape::backward(std::size_t k, const double* delta,
+    double* res, std::size_t n) const {
+
+  if (k >= m_records.size()) {
+    boost::format m("tape has no layer %lu (it has %lu)");
+    m % k % m_records.size();
+    throw std::out_of_range(m.str());
+  }
+
+  const Record& record = m_records[k];
+  if (n != record.n) {
+    boost::format m("gradients of layer %lu should have %lu values, not %lu");
+    m % k % record.n % n;
+    throw std::length_error(m.str());
+  }
+
+  backward(*record.activation, record.data, delta, res, n);
+
+}
+
+void bob::learn::activation::Tape::backward(const Activation& activation,
+    const double* f, const double* delta, double* res, std::size_t n) {
+
+  CallTimer timer(activation, F_PRIME_FROM_F, SERIAL, n);
+  TraceSpan span(activation, F_PRIME_FROM_F, "tape", 1, &n);
+
+  double derivative[BACKWARD_BLOCK];
+  for (std::size_t start=0; start<n; start+=BACKWARD_BLOCK) {
+    std::size_t length = std::min(BACKWARD_BLOCK, n-start);
+    activation.f_prime_from_f_batch(f + start, 1, derivative, 1, length);
+    for (std::size_t i=0; i<length; ++i)
+      res[start+i] = delta[start+i] * derivative[i];
+  }
+
+}
+
+std::size_t bob::learn::activation::Tape::capacity() const {
+  std::size_t retval = 0;
+  for (auto& block : m_blocks) retval += block.size;
+  return retval;
+}
+
+std::size_t bob::learn::activation::Tape::used() const {
+  std::size_t retval = 0;
+  for (auto& block : m_blocks) retval += block.used;
+  return retval;
+}
@@ -0,0 +1,208 @@
+/**
+ * @date Sun 18 Oct 2026 16:02:13 CEST
+ *
+ * @brief Implementation of the tracing of activation kernels
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Trace.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <vector>
+#include <cstdio>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+std::atomic<bool> bob::learn::activation::detail::tracing(false);
+
+namespace {
+
+  /**
+   * A slot of a ring, guarded by a sequence number: odd while the event is
+   * written, then twice the event index plus 2, so readers can detect
+   * events overwritten while they were copied
+   */
+  struct Slot {
+    std::atomic<uint64_t> sequence;
+    bob::learn::activation::TraceEvent event;
+  };
+
+  /**
+   * The events of a thread. Only its thread writes to it, without locks.
+   */
+  struct Ring {
+    Ring(): head(0), cleared(0) {
+      for (std::size_t k=0; k<bob::learn::activation::TRACE_CAPACITY; ++k)
+        slots[k].sequence.store(0, std::memory_order_relaxed);
+    }
+    Slot slots[bob::learn::activation::TRACE_CAPACITY];
+    std::atomic<uint64_t> head; ///< index of the next event
+    std::atomic<uint64_t> cleared; ///< index of the first event to dump
+  };
+
+  /**
+   * All rings ever created. The rings of finished threads are kept, with
+   * their events, and handed to new threads, so that short-lived threads
+   * (e.g. of std::async) do not accumulate rings.
+   */
+  std::mutex s_mutex;
+  std::vector<Ring*> s_rings;
+  std::vector<Ring*> s_free;
+
+  struct ThreadState {
+
+    ThreadState(): ring(0), id(0) {}
+
+    ~ThreadState() {
+      if (!ring) return;
+      std::lock_guard<std::mutex> lock(s_mutex);
+      s_free.push_back(ring);
+    }
+
+    Ring* get() {
+      if (ring) return ring;
+#ifdef __linux__
+      id = syscall(SYS_gettid);
+#else
+      id = std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+      std::lock_guard<std::mutex> lock(s_mutex);
+      if (s_free.size()) {
+        ring = s_free.back();
+        s_free.pop_back();
+      }
+      else {
+        ring = new Ring;
+        s_rings.push_back(ring);
+      }
+      return ring;
+    }
+
+    Ring* ring;
+    uint64_t id;
+
+  };
+
+  thread_local ThreadState t_state;
+
+  const char* method_name(bob::learn::activation::Method m) {
+    switch (m) {
+      case bob::learn::activation::F: return "f";
+      case bob::learn::activation::F_PRIME: return "f_prime";
+      case bob::learn::activation::F_PRIME_FROM_F: return "f_prime_from_f";
+      case bob::learn::activation::F_SECOND: return "f_second";
+      case bob::learn::activation::F_SECOND_FROM_F: return "f_second_from_f";
+    }
+    return "unknown";
+  }
+
+  void write_string(std::ostream& os, const char* s) {
+    os << '"';
+    for (; *s; ++s) {
+      if (*s == '"' || *s == '\\') os << '\\' << *s;
+      else if ((unsigned char)*s < 0x20) os << ' ';
+      else os << *s;
+    }
+    os << '"';
+  }
+
+  /**
+   * Writes nanoseconds as the microseconds of the Chrome trace format
+   */
+  void write_microseconds(std::ostream& os, uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03u",
+        (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+    os << buffer;
+  }
+
+}
+
+void bob::learn::activation::detail::record_trace(const TraceEvent& event) {
+
+  Ring* ring = t_state.get();
+  uint64_t index = ring->head.load(std::memory_order_relaxed);
+  Slot& slot = ring->slots[index % TRACE_CAPACITY];
+
+  slot.sequence.store(2*index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.event = event;
+  slot.event.thread = t_state.id;
+  slot.sequence.store(2*index + 2, std::memory_order_release);
+  ring->head.store(index + 1, std::memory_order_release);
+
+}
+
+bool bob::learn::activation::set_tracing(bool enabled) {
+  return detail::tracing.exchange(enabled);
+}
+
+uint64_t bob::learn::activation::trace_clock() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::size_t bob::learn::activation::dump_trace(std::ostream& os) {
+
+  std::vector<TraceEvent> events;
+
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto ring : s_rings) {
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+      uint64_t start = ring->cleared.load(std::memory_order_relaxed);
+      if (head > TRACE_CAPACITY && head - TRACE_CAPACITY > start)
+        start = head - TRACE_CAPACITY;
+      for (uint64_t index=start; index<head; ++index) {
+        const Slot& slot = ring->slots[index % TRACE_CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != 2*index + 2) continue;
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != 2*index + 2) continue;
+        events.push_back(event);
+      }
+    }
+  }
+
+  std::sort(events.begin(), events.end(),
+      [](const TraceEvent& a, const TraceEvent& b) { return a.begin < b.begin; });
+
+  long pid = getpid();
+
+  os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  for (std::size_t k=0; k<events.size(); ++k) {
+    const TraceEvent& e = events[k];
+    if (k) os << ',';
+    os << "\n{\"name\": ";
+    write_string(os, e.activation);
+    os << ", \"cat\": \"bob.learn.activation\", \"ph\": \"X\", \"ts\": ";
+    write_microseconds(os, e.begin);
+    os << ", \"dur\": ";
+    write_microseconds(os, e.end - e.begin);
+    os << ", \"pid\": " << pid << ", \"tid\": " << e.thread;
+    os << ", \"args\": {\"method\": \"" << method_name(e.method) << "\"";
+    os << ", \"variant\": ";
+    write_string(os, e.variant);
+    os << ", \"dtype\": ";
+    write_string(os, e.dtype);
+    os << ", \"shape\": [";
+    for (std::size_t d=0; d<e.ndim; ++d) os << (d ? ", " : "") << e.shape[d];
+    os << "]}}";
+  }
+  os << "\n]}\n";
+
+  return events.size();
+
+}
+
+void bob::learn::activation::clear_trace() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  for (auto ring : s_rings)
+    ring->cleared.store(ring->head.load(std::memory_order_acquire),
+        std::memory_order_relaxed);
+}
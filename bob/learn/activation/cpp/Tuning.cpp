@@ -0,0 +1,119 @@
+/**
+ * @date Sun 18 Oct 2026 18:40:05 CEST
+ *
+ * @brief Implementation of the tuned parallel evaluation of large arrays
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.activation/Tuning.h>
+#include <stdexcept>
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+std::atomic<std::size_t> bob::learn::activation::detail::parallel_threshold
+  (std::numeric_limits<std::size_t>::max());
+
+static std::mutex s_mutex;
+static std::map<std::string, bob::learn::activation::Tuning> s_tunings;
+
+/**
+ * Updates the smallest threshold of parallel tunings - to be called with the
+ * lock held
+ */
+static void update_parallel_threshold() {
+  std::size_t threshold = std::numeric_limits<std::size_t>::max();
+  for (auto& k : s_tunings)
+    if (k.second.threads > 1) threshold = std::min(threshold, k.second.threshold);
+  bob::learn::activation::detail::parallel_threshold.store(threshold);
+}
+
+bob::learn::activation::Tuning bob::learn::activation::default_tuning() {
+  Tuning retval;
+  retval.threads = 1;
+  retval.threshold = 1 << 16;
+  retval.chunk = 1 << 14;
+  return retval;
+}
+
+bob::learn::activation::Tuning bob::learn::activation::get_tuning
+(const std::string& unique_identifier) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  auto it = s_tunings.find(unique_identifier);
+  if (it == s_tunings.end()) return default_tuning();
+  return it->second;
+}
+
+void bob::learn::activation::set_tuning(const std::string& unique_identifier,
+    const Tuning& tuning) {
+  if (!tuning.threads) throw std::invalid_argument("tuned number of threads must be positive");
+  if (!tuning.chunk) throw std::invalid_argument("tuned chunk size must be positive");
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_tunings[unique_identifier] = tuning;
+  update_parallel_threshold();
+}
+
+void bob::learn::activation::reset_tuning(const std::string& unique_identifier) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if (unique_identifier.empty()) s_tunings.clear();
+  else s_tunings.erase(unique_identifier);
+  update_parallel_threshold();
+}
+
+std::map<std::string, bob::learn::activation::Tuning> bob::learn::activation::tunings() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_tunings;
+}
+
+void bob::learn::activation::parallel_batch(const Activation& activation,
+    Method m, const double* z, double* a, std::size_t n, const Tuning& tuning,
+    Statistics* stats) {
+
+  std::size_t chunk = std::max<std::size_t>(tuning.chunk, 1);
+  std::size_t threads = std::min(tuning.threads, (n + chunk - 1) / chunk);
+
+  // one empty accumulator per thread, configured like stats
+  std::vector<Statistics> partials;
+  if (stats) {
+    partials.assign(threads, *stats);
+    for (auto& partial : partials) partial.reset();
+  }
+
+  std::atomic<std::size_t> next(0);
+  auto work = [&activation, m, z, a, n, chunk, &next](Statistics* partial) {
+    for (;;) {
+      std::size_t start = next.fetch_add(chunk);
+      if (start >= n) return;
+      std::size_t length = std::min(chunk, n-start);
+      try {
+        if (partial) f_batch_with_statistics(activation, z + start, 1, a + start, 1, length, *partial);
+        else activation.batch(m, z + start, 1, a + start, 1, length);
+      }
+      catch (...) {
+        next.store(n); // stops the other threads early
+        throw;
+      }
+    }
+  };
+
+  std::vector<std::future<void> > helpers;
+  for (std::size_t k=1; k<threads; ++k)
+    helpers.push_back(std::async(std::launch::async, work, stats ? &partials[k] : 0));
+
+  std::exception_ptr error;
+  try { work(stats ? &partials[0] : 0); }
+  catch (...) { error = std::current_exception(); }
+
+  for (auto& helper : helpers) {
+    try { helper.get(); }
+    catch (...) { if (!error) error = std::current_exception(); }
+  }
+
+  if (error) std::rethrow_exception(error);
+
+  for (auto& partial : partials) stats->merge(partial);
+
+}
@@ -0,0 +1,541 @@
+/**
+ * @date Fri 16 Oct 2026 10:02:37 CEST
+ *
+ * @brief Activation functions implemented by vectorized Python callables
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOB_LEARN_ACTIVATION_MODULE
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.learn.activation/api.h>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <map>
+
+/**
+ * Returns the contents of a Python string object
+ */
+static std::string to_string(PyObject* o) {
+  PyObject* str = PyObject_Str(o);
+  if (!str) { PyErr_Clear(); return "<unprintable object>"; }
+  auto str_ = make_safe(str);
+# if PY_VERSION_HEX >= 0x03000000
+  const char* c = PyUnicode_AsUTF8(str);
+  if (!c) { PyErr_Clear(); return "<unprintable object>"; }
+  return c;
+# else
+  return PyString_AsString(str);
+# endif
+}
+
+/**
+ * Converts the pending Python exception into a message, clearing it
+ */
+static std::string fetch_error() {
+  PyObject *type, *value, *traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+  PyErr_NormalizeException(&type, &value, &traceback);
+  std::string retval = type ? reinterpret_cast<PyTypeObject*>(type)->tp_name : "error";
+  if (value) retval += ": " + to_string(value);
+  Py_XDECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(traceback);
+  return retval;
+}
+
+/**
+ * Identifier of functions not registered for loading
+ */
+static const char* s_default_id = "bob.learn.activation.Activation.Custom";
+
+/**
+ * An activation function implemented by Python callables. Each callable
+ * receives a 1D 64-bit float numpy array holding a whole run of values and
+ * returns the results for all of them, so Python is entered once per run,
+ * not once per element. The GIL is acquired as needed, so these functions
+ * can be used from any thread.
+ */
+class PythonActivation: public bob::learn::activation::Activation {
+
+  public: // api
+
+    /**
+     * Builds a new function. New references are taken to the callables;
+     * @c f_prime may be 0, in which case derivatives are computed from the
+     * activated values.
+     */
+    PythonActivation(PyObject* f, PyObject* f_prime_from_f, PyObject* f_prime,
+        const std::string& id, const std::vector<double>& parameters):
+      m_f(f), m_f_prime_from_f(f_prime_from_f), m_f_prime(f_prime),
+      m_id(id), m_parameters(parameters)
+    {
+      Py_INCREF(m_f);
+      Py_INCREF(m_f_prime_from_f);
+      Py_XINCREF(m_f_prime);
+    }
+
+    PythonActivation(const PythonActivation& other):
+      bob::learn::activation::Activation(other),
+      m_f(other.m_f), m_f_prime_from_f(other.m_f_prime_from_f),
+      m_f_prime(other.m_f_prime), m_id(other.m_id),
+      m_parameters(other.m_parameters)
+    {
+      PyGILState_STATE state = PyGILState_Ensure();
+      Py_INCREF(m_f);
+      Py_INCREF(m_f_prime_from_f);
+      Py_XINCREF(m_f_prime);
+      PyGILState_Release(state);
+    }
+
+    virtual ~PythonActivation() {
+      if (!Py_IsInitialized()) return; //leaked at interpreter shutdown
+      PyGILState_STATE state = PyGILState_Ensure();
+      Py_DECREF(m_f);
+      Py_DECREF(m_f_prime_from_f);
+      Py_XDECREF(m_f_prime);
+      PyGILState_Release(state);
+    }
+
+    virtual double f (double z) const
+    { double a; f_batch(&z, 1, &a, 1, 1); return a; }
+
+    virtual double f_prime (double z) const
+    { double d; f_prime_batch(&z, 1, &d, 1, 1); return d; }
+
+    virtual double f_prime_from_f (double a) const
+    { double d; f_prime_from_f_batch(&a, 1, &d, 1, 1); return d; }
+
+    virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+    { call(m_f, z, zs, a, as, n); }
+
+    virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* d, std::ptrdiff_t ds, std::size_t n) const {
+      if (m_f_prime) return call(m_f_prime, z, zs, d, ds, n);
+      call(m_f, z, zs, d, ds, n);
+      call(m_f_prime_from_f, d, ds, d, ds, n);
+    }
+
+    virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+    { call(m_f_prime_from_f, a, as, d, ds, n); }
+
+    virtual std::vector<double> parameters() const { return m_parameters; }
+
+    virtual bool equals (const Activation& other) const {
+      if (typeid(other) != typeid(*this)) return false;
+      auto& o = static_cast<const PythonActivation&>(other);
+      if (o.m_id != m_id || o.m_parameters.size() != m_parameters.size()) return false;
+      for (std::size_t k=0; k<m_parameters.size(); ++k)
+        if (!same_parameter(o.m_parameters[k], m_parameters[k])) return false;
+      // anonymous functions are only the same if implemented the same way
+      if (m_id != s_default_id) return true;
+      return o.m_f == m_f && o.m_f_prime_from_f == m_f_prime_from_f && o.m_f_prime == m_f_prime;
+    }
+
+    virtual boost::shared_ptr<Activation> clone() const
+    { return boost::make_shared<PythonActivation>(*this); }
+
+    virtual void save(bob::io::base::HDF5File& f) const {
+      Activation::save(f);
+      if (m_parameters.empty()) return;
+      blitz::Array<double,1> p(m_parameters.size());
+      std::copy(m_parameters.begin(), m_parameters.end(), p.data());
+      f.setArray("parameters", p);
+    }
+
+    virtual void load(bob::io::base::HDF5File& /*f*/) {
+      throw std::runtime_error("activation functions implemented in Python cannot be reloaded in place - use load_activation() after registering their type");
+    }
+
+    virtual std::string unique_identifier() const { return m_id; }
+
+    virtual std::string str() const {
+      std::string retval = "f(z) = " + m_id + "(";
+      for (std::size_t k=0; k<m_parameters.size(); ++k)
+        retval += (boost::format(k ? ", %.5e" : "%.5e") % m_parameters[k]).str();
+      return retval + ")";
+    }
+
+    /**
+     * Visits the callables, for Python's garbage collector
+     */
+    int traverse(visitproc visit, void* arg) const {
+      Py_VISIT(m_f);
+      Py_VISIT(m_f_prime_from_f);
+      Py_VISIT(m_f_prime);
+      return 0;
+    }
+
+  private: // helpers
+
+    /**
+     * Calls @c callable with a copy of the @c n inputs at @c in (every @c is
+     * elements), writing its results to @c out (every @c os elements)
+     */
+    void call(PyObject* callable, const double* in, std::ptrdiff_t is,
+        double* out, std::ptrdiff_t os, std::size_t n) const {
+
+      if (!n) return;
+
+      PyGILState_STATE state = PyGILState_Ensure();
+      std::string error;
+
+      npy_intp size = n;
+      PyObject* input = PyArray_SimpleNew(1, &size, NPY_FLOAT64);
+      PyObject* result = 0;
+      PyObject* output = 0;
+
+      if (input) {
+        double* p = reinterpret_cast<double*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(input)));
+        for (std::size_t k=0; k<n; ++k, in+=is) p[k] = *in;
+        result = PyObject_CallFunctionObjArgs(callable, input, NULL);
+      }
+
+      if (result) {
+        output = PyArray_FromAny(result, PyArray_DescrFromType(NPY_FLOAT64),
+            0, 1, NPY_ARRAY_ALIGNED | NPY_ARRAY_FORCECAST, 0);
+      }
+
+      if (output) {
+        PyArrayObject* o = reinterpret_cast<PyArrayObject*>(output);
+        if ((std::size_t)PyArray_SIZE(o) != n) {
+          error = (boost::format("activation function %s returned %d values for %u inputs") % m_id % PyArray_SIZE(o) % n).str();
+        }
+        else if (PyArray_NDIM(o) == 0) {
+          *out = *reinterpret_cast<double*>(PyArray_DATA(o));
+        }
+        else {
+          for (std::size_t k=0; k<n; ++k, out+=os)
+            *out = *reinterpret_cast<double*>(PyArray_GETPTR1(o, k));
+        }
+      }
+
+      if (PyErr_Occurred()) error = fetch_error();
+
+      Py_XDECREF(output);
+      Py_XDECREF(result);
+      Py_XDECREF(input);
+      PyGILState_Release(state);
+
+      if (!error.empty()) throw std::runtime_error(error);
+
+    }
+
+  private: // representation
+
+    PyObject* m_f; ///< computes f(z)
+    PyObject* m_f_prime_from_f; ///< computes f'(z) from f(z)
+    PyObject* m_f_prime; ///< computes f'(z), or 0
+    std::string m_id; ///< unique identifier
+    std::vector<double> m_parameters; ///< parameters, for saving
+
+};
+
+/**
+ * Constructors registered by Python for each unique identifier, protected by
+ * the GIL
+ */
+static std::map<std::string, PyObject*> s_constructors;
+
+/**
+ * Creates an activation from its type and parameters, calling the Python
+ * constructor registered for the type
+ */
+static boost::shared_ptr<bob::learn::activation::Activation> build_python
+(const std::string& id, const std::vector<double>& parameters) {
+
+  PyGILState_STATE state = PyGILState_Ensure();
+  std::string error;
+  boost::shared_ptr<bob::learn::activation::Activation> retval;
+
+  auto it = s_constructors.find(id);
+
+  if (it == s_constructors.end()) {
+    error = (boost::format("no Python constructor registered for activation function %s") % id).str();
+  }
+  else {
+    PyObject* args = PyTuple_New(parameters.size());
+    for (std::size_t k=0; args && k<parameters.size(); ++k) {
+      PyTuple_SET_ITEM(args, k, PyFloat_FromDouble(parameters[k]));
+    }
+    PyObject* result = args ? PyObject_Call(it->second, args, 0) : 0;
+    if (result && !PyBobLearnActivation_Check(result)) {
+      error = (boost::format("the constructor registered for activation function %s returned an object of type `%s', which is not an activation function") % id % Py_TYPE(result)->tp_name).str();
+    }
+    else if (result) {
+      retval = reinterpret_cast<PyBobLearnActivationObject*>(result)->cxx;
+    }
+    Py_XDECREF(result);
+    Py_XDECREF(args);
+  }
+
+  if (PyErr_Occurred()) error = fetch_error();
+  PyGILState_Release(state);
+
+  if (!error.empty()) throw std::runtime_error(error);
+  return retval;
+
+}
+
+static boost::shared_ptr<bob::learn::activation::Activation> python_factory
+(bob::io::base::HDF5File& f) {
+
+  std::string id = f.read<std::string>("id");
+  std::vector<double> parameters;
+  if (f.contains("parameters")) {
+    blitz::Array<double,1> p = f.readArray<double,1>("parameters");
+    parameters.assign(p.data(), p.data() + p.numElements());
+  }
+  return build_python(id, parameters);
+
+}
+
+/*******************************
+ * Bindings for the Python type *
+ *******************************/
+
+typedef struct {
+  PyBobLearnActivationObject parent;
+  boost::shared_ptr<PythonActivation> cxx;
+} PyBobLearnCustomActivationObject;
+
+PyDoc_STRVAR(s_customactivation_str, BOB_EXT_MODULE_PREFIX ".Custom");
+
+PyDoc_STRVAR(s_customactivation_doc,
+"Custom(f, f_prime_from_f, [f_prime=None, [identifier='bob.learn.activation.Activation.Custom', [parameters=()]]]) -> new Custom\n\
+\n\
+An activation function implemented in Python, usable wherever\n\
+C++ activation functions are, e.g. by C++ machines.\n\
+\n\
+``f`` and ``f_prime_from_f`` (and, optionally, ``f_prime``) are\n\
+callables that receive a 1D 64-bit float numpy array and return\n\
+an array (or sequence) of the same size with the activated values\n\
+(or derivatives). They are called once per contiguous run of\n\
+values, not once per element, so they should be vectorized. If\n\
+``f_prime`` is not given, derivatives are computed from the\n\
+activated values.\n\
+\n\
+To save and load functions of this type, give them a unique\n\
+``identifier`` and the ``parameters`` (a sequence of floats) that\n\
+determine them, then register a constructor for that identifier\n\
+with :py:meth:`Custom.register`. Functions with the same\n\
+identifier and parameters are expected to be the same, and\n\
+compare equal.\n\
+\n\
+");
+
+static int PyBobLearnCustomActivation_init
+(PyBobLearnCustomActivationObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"f", "f_prime_from_f", "f_prime",
+    "identifier", "parameters", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* f = 0;
+  PyObject* f_prime_from_f = 0;
+  PyObject* f_prime = Py_None;
+  const char* id = s_default_id;
+  PyObject* parameters = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|OsO", kwlist,
+        &f, &f_prime_from_f, &f_prime, &id, &parameters)) return -1;
+
+  if (!PyCallable_Check(f) || !PyCallable_Check(f_prime_from_f) ||
+      (f_prime != Py_None && !PyCallable_Check(f_prime))) {
+    PyErr_Format(PyExc_TypeError, "`%s' requires callables for `f', `f_prime_from_f' and `f_prime'", Py_TYPE(self)->tp_name);
+    return -1;
+  }
+
+  std::vector<double> p;
+  if (parameters) {
+    PyObject* sequence = PySequence_Fast(parameters, "`parameters' must be a sequence of floats");
+    if (!sequence) return -1;
+    auto sequence_ = make_safe(sequence);
+    for (Py_ssize_t k=0; k<PySequence_Fast_GET_SIZE(sequence); ++k) {
+      double v = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(sequence, k));
+      if (PyErr_Occurred()) return -1;
+      p.push_back(v);
+    }
+  }
+
+  try {
+    self->cxx.reset(new PythonActivation(f, f_prime_from_f,
+          f_prime == Py_None ? 0 : f_prime, id, p));
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot create new object of type `%s' - unknown exception thrown", s_customactivation_str);
+  }
+
+  self->parent.cxx = self->cxx;
+
+  if (PyErr_Occurred()) return -1;
+
+  return 0;
+
+}
+
+static int PyBobLearnCustomActivation_traverse
+(PyBobLearnCustomActivationObject* self, visitproc visit, void* arg) {
+
+  // the callables only belong to this object if no C++ code shares the
+  // function (this object holds two references to it)
+  if (self->cxx && self->cxx.use_count() == 2) return self->cxx->traverse(visit, arg);
+  return 0;
+
+}
+
+static int PyBobLearnCustomActivation_clear
+(PyBobLearnCustomActivationObject* self) {
+
+  self->parent.cxx.reset();
+  self->cxx.reset();
+  return 0;
+
+}
+
+static void PyBobLearnCustomActivation_delete
+(PyBobLearnCustomActivationObject* self) {
+
+  PyObject_GC_UnTrack(self);
+  self->parent.cxx.reset();
+  self->cxx.reset();
+  Py_TYPE(&self->parent)->tp_free((PyObject*)self);
+
+}
+
+PyDoc_STRVAR(s_register_str, "register");
+PyDoc_STRVAR(s_register_doc,
+"Custom.register(identifier, [constructor]) -> None\n\
+\n\
+Registers ``constructor`` as the way to create activation\n\
+functions with the unique identifier ``identifier``, given their\n\
+parameters, so that they can be loaded from HDF5 files, compact\n\
+bundles or pickles. ``constructor`` is called with the parameters\n\
+as positional arguments and must return an activation function.\n\
+It defaults to the class this method is called on, so subclasses\n\
+of :py:class:`Custom` may register themselves.\n\
+\n\
+");
+
+static PyObject* PyBobLearnCustomActivation_register
+(PyObject* cls, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"identifier", "constructor", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* id = 0;
+  PyObject* constructor = cls;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|O", kwlist,
+        &id, &constructor)) return 0;
+
+  if (!PyCallable_Check(constructor)) {
+    PyErr_Format(PyExc_TypeError, "the constructor for activation function %s must be callable", id);
+    return 0;
+  }
+
+  try {
+    auto registry = bob::learn::activation::ActivationRegistry::instance();
+    registry->registerActivation(id, python_factory);
+    registry->registerBuilder(id, build_python);
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+    return 0;
+  }
+
+  Py_INCREF(constructor);
+  auto it = s_constructors.find(id);
+  if (it != s_constructors.end()) {
+    Py_DECREF(it->second);
+    it->second = constructor;
+  }
+  else s_constructors[id] = constructor;
+
+  Py_RETURN_NONE;
+
+}
+
+static PyMethodDef PyBobLearnCustomActivation_methods[] = {
+  {
+    s_register_str,
+    (PyCFunction)PyBobLearnCustomActivation_register,
+    METH_VARARGS|METH_KEYWORDS|METH_CLASS,
+    s_register_doc
+  },
+  {0} /* Sentinel */
+};
+
+PyDoc_STRVAR(s_parameters_str, "parameters");
+PyDoc_STRVAR(s_parameters_doc,
+"The parameters of this function, as a tuple of floats (read-only)"
+);
+
+static PyObject* PyBobLearnCustomActivation_parameters
+(PyBobLearnCustomActivationObject* self) {
+
+  std::vector<double> p = self->cxx->parameters();
+  PyObject* retval = PyTuple_New(p.size());
+  if (!retval) return 0;
+  for (std::size_t k=0; k<p.size(); ++k) PyTuple_SET_ITEM(retval, k, PyFloat_FromDouble(p[k]));
+  return retval;
+
+}
+
+static PyGetSetDef PyBobLearnCustomActivation_getseters[] = {
+    {
+      s_parameters_str,
+      (getter)PyBobLearnCustomActivation_parameters,
+      0,
+      s_parameters_doc,
+      0
+    },
+    {0}  /* Sentinel */
+};
+
+PyTypeObject PyBobLearnCustomActivation_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    s_customactivation_str,                             /*tp_name*/
+    sizeof(PyBobLearnCustomActivationObject),           /*tp_basicsize*/
+    0,                                                  /*tp_itemsize*/
+    (destructor)PyBobLearnCustomActivation_delete,      /*tp_dealloc*/
+    0,                                                  /*tp_print*/
+    0,                                                  /*tp_getattr*/
+    0,                                                  /*tp_setattr*/
+    0,                                                  /*tp_compare*/
+    0,                                                  /*tp_repr*/
+    0,                                                  /*tp_as_number*/
+    0,                                                  /*tp_as_sequence*/
+    0,                                                  /*tp_as_mapping*/
+    0,                                                  /*tp_hash */
+    0,                                                  /*tp_call*/
+    0,                                                  /*tp_str*/
+    0,                                                  /*tp_getattro*/
+    0,                                                  /*tp_setattro*/
+    0,                                                  /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    s_customactivation_doc,                             /* tp_doc */
+    (traverseproc)PyBobLearnCustomActivation_traverse,  /* tp_traverse */
+    (inquiry)PyBobLearnCustomActivation_clear,          /* tp_clear */
+    0,                                                  /* tp_richcompare */
+    0,		                                              /* tp_weaklistoffset */
+    0,		                                              /* tp_iter */
+    0,		                                              /* tp_iternext */
+    PyBobLearnCustomActivation_methods,                 /* tp_methods */
+    0,                                                  /* tp_members */
+    PyBobLearnCustomActivation_getseters,               /* tp_getset */
+    0,                                                  /* tp_base */
+    0,                                                  /* tp_dict */
+    0,                                                  /* tp_descr_get */
+    0,                                                  /* tp_descr_set */
+    0,                                                  /* tp_dictoffset */
+    (initproc)PyBobLearnCustomActivation_init,          /* tp_init */
+    0,                                                  /* tp_alloc */
+    0,                                                  /* tp_new */
+};
@@ -0,0 +1,303 @@
+/**
+ * @date Sat 17 Oct 2026 09:41:12 CEST
+ *
+ * @brief Bindings for activation functions defined by a formula
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOB_LEARN_ACTIVATION_MODULE
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.learn.activation/api.h>
+
+PyDoc_STRVAR(s_formulaactivation_str, BOB_EXT_MODULE_PREFIX ".Formula");
+
+PyDoc_STRVAR(s_formulaactivation_doc,
+"Formula(formula, [parameters=None, [f_prime_from_f=None]]) -> new Formula\n\
+\n\
+Computes the activation function given by ``formula``, e.g.\n\
+``'z / (1 + abs(z))'``, without writing a new C++ class.\n\
+\n\
+The input is named ``z`` (or ``x``). Formulas may use numbers,\n\
+``pi``, ``e``, the operators ``+``, ``-``, ``*``, ``/`` and ``^``\n\
+(or ``**``), parentheses, the functions ``abs``, ``sign``, ``exp``,\n\
+``log``, ``log1p``, ``sqrt``, ``tanh``, ``sinh``, ``cosh``, ``sin``,\n\
+``cos`` and ``erf`` and the parameters named by the keys of the\n\
+dictionary ``parameters``, which take the corresponding values.\n\
+\n\
+The formula is compiled once to a bytecode that is evaluated over\n\
+blocks of values, and :py:meth:`Activation.f_prime` is computed\n\
+from its symbolic derivative (see :py:attr:`derivative`). As the\n\
+derivative cannot, in general, be computed from the activated\n\
+value alone, :py:meth:`Activation.f_prime_from_f` requires a\n\
+formula for it in terms of the activated value ``a``, given as\n\
+``f_prime_from_f`` - e.g. ``'1 - a^2'`` for ``'tanh(z)'``.\n\
+\n\
+Formulas are saved to and loaded from HDF5 files like the other\n\
+activation functions, but cannot be stored with :py:func:`dumps`\n\
+or :py:func:`save_bundle`, which only record parameter values.\n\
+\n\
+");
+
+static int PyBobLearnFormulaActivation_init
+(PyBobLearnFormulaActivationObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"formula", "parameters", "f_prime_from_f", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* formula = 0;
+  PyObject* parameters = 0;
+  const char* f_prime_from_f = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|Oz", kwlist,
+        &formula, &parameters, &f_prime_from_f)) return -1;
+
+  std::vector<std::string> names;
+  std::vector<double> values;
+
+  if (parameters && parameters != Py_None) {
+
+    if (!PyDict_Check(parameters)) {
+      PyErr_Format(PyExc_TypeError, "`%s' requires a dictionary mapping parameter names to values, not `%s'", Py_TYPE(self)->tp_name, Py_TYPE(parameters)->tp_name);
+      return -1;
+    }
+
+    // sorted, so the order of parameters() does not depend on the dictionary
+    PyObject* keys = PyDict_Keys(parameters);
+    if (!keys) return -1;
+    auto keys_ = make_safe(keys);
+    if (PyList_Sort(keys) < 0) return -1;
+
+    for (Py_ssize_t k=0; k<PyList_GET_SIZE(keys); ++k) {
+      PyObject* key = PyList_GET_ITEM(keys, k);
+      const char* name = 0;
+      if (!PyArg_Parse(key, "s", &name)) return -1;
+      double value = PyFloat_AsDouble(PyDict_GetItem(parameters, key));
+      if (PyErr_Occurred()) return -1;
+      names.push_back(name);
+      values.push_back(value);
+    }
+
+  }
+
+  try {
+    self->cxx.reset(new bob::learn::activation::FormulaActivation(formula,
+          names, values, f_prime_from_f ? f_prime_from_f : ""));
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot create new object of type `%s' - unknown exception thrown", s_formulaactivation_str);
+  }
+
+  self->parent.cxx = self->cxx;
+
+  if (PyErr_Occurred()) return -1;
+
+  return 0;
+
+}
+
+static void PyBobLearnFormulaActivation_delete
+(PyBobLearnFormulaActivationObject* self) {
+
+  self->parent.cxx.reset();
+  self->cxx.reset();
+  Py_TYPE(&self->parent)->tp_free((PyObject*)self);
+
+}
+
+PyDoc_STRVAR(s_formula_str, "formula");
+PyDoc_STRVAR(s_formula_doc,
+"The formula of this function, as given (read-only)"
+);
+
+static PyObject* PyBobLearnFormulaActivation_formula
+(PyBobLearnFormulaActivationObject* self) {
+
+  return Py_BuildValue("s", self->cxx->formula().c_str());
+
+}
+
+PyDoc_STRVAR(s_derivative_str, "derivative");
+PyDoc_STRVAR(s_derivative_doc,
+"The symbolic derivative of the formula, used by\n\
+:py:meth:`Activation.f_prime` (read-only)"
+);
+
+static PyObject* PyBobLearnFormulaActivation_derivative
+(PyBobLearnFormulaActivationObject* self) {
+
+  return Py_BuildValue("s", self->cxx->derivative().c_str());
+
+}
+
+PyDoc_STRVAR(s_second_derivative_str, "second_derivative");
+PyDoc_STRVAR(s_second_derivative_doc,
+"The symbolic second derivative of the formula, used by\n\
+:py:meth:`Activation.f_second` (read-only)"
+);
+
+static PyObject* PyBobLearnFormulaActivation_second_derivative
+(PyBobLearnFormulaActivationObject* self) {
+
+  return Py_BuildValue("s", self->cxx->second_derivative().c_str());
+
+}
+
+PyDoc_STRVAR(s_f_prime_from_f_str, "f_prime_from_f_formula");
+PyDoc_STRVAR(s_f_prime_from_f_doc,
+"The formula of the derivative in terms of the activated value\n\
+``a``, or ``None`` (read-only)"
+);
+
+static PyObject* PyBobLearnFormulaActivation_f_prime_from_f
+(PyBobLearnFormulaActivationObject* self) {
+
+  const std::string& retval = self->cxx->f_prime_from_f_formula();
+  if (retval.empty()) Py_RETURN_NONE;
+  return Py_BuildValue("s", retval.c_str());
+
+}
+
+PyDoc_STRVAR(s_parameters_str, "parameters");
+PyDoc_STRVAR(s_parameters_doc,
+"A new dictionary with the values of the parameters, by name\n\
+(read-only)"
+);
+
+static PyObject* PyBobLearnFormulaActivation_parameters
+(PyBobLearnFormulaActivationObject* self) {
+
+  const std::vector<std::string>& names = self->cxx->names();
+  std::vector<double> values = self->cxx->parameters();
+
+  PyObject* retval = PyDict_New();
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  for (std::size_t k=0; k<names.size(); ++k) {
+    PyObject* value = PyFloat_FromDouble(values[k]);
+    if (!value) return 0;
+    auto value_ = make_safe(value);
+    if (PyDict_SetItemString(retval, names[k].c_str(), value) < 0) return 0;
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+static PyGetSetDef PyBobLearnFormulaActivation_getseters[] = {
+    {
+      s_formula_str,
+      (getter)PyBobLearnFormulaActivation_formula,
+      0,
+      s_formula_doc,
+      0
+    },
+    {
+      s_derivative_str,
+      (getter)PyBobLearnFormulaActivation_derivative,
+      0,
+      s_derivative_doc,
+      0
+    },
+    {
+      s_second_derivative_str,
+      (getter)PyBobLearnFormulaActivation_second_derivative,
+      0,
+      s_second_derivative_doc,
+      0
+    },
+    {
+      s_f_prime_from_f_str,
+      (getter)PyBobLearnFormulaActivation_f_prime_from_f,
+      0,
+      s_f_prime_from_f_doc,
+      0
+    },
+    {
+      s_parameters_str,
+      (getter)PyBobLearnFormulaActivation_parameters,
+      0,
+      s_parameters_doc,
+      0
+    },
+    {0}  /* Sentinel */
+};
+
+PyDoc_STRVAR(s_reduce_str, "__reduce__");
+PyDoc_STRVAR(s_reduce_doc,
+"o.__reduce__() -> tuple\n\
+\n\
+Pickling support: formulas are pickled as the arguments of their\n\
+constructor, since they cannot be stored in compact form.\n\
+\n\
+");
+
+static PyObject* PyBobLearnFormulaActivation_Reduce
+(PyBobLearnFormulaActivationObject* self) {
+
+  PyObject* parameters = PyBobLearnFormulaActivation_parameters(self);
+  if (!parameters) return 0;
+  PyObject* f_prime_from_f = PyBobLearnFormulaActivation_f_prime_from_f(self);
+  if (!f_prime_from_f) { Py_DECREF(parameters); return 0; }
+
+  return Py_BuildValue("O(sNN)", Py_TYPE(self), self->cxx->formula().c_str(),
+      parameters, f_prime_from_f);
+
+}
+
+static PyMethodDef PyBobLearnFormulaActivation_methods[] = {
+  {
+    s_reduce_str,
+    (PyCFunction)PyBobLearnFormulaActivation_Reduce,
+    METH_NOARGS,
+    s_reduce_doc
+  },
+  {0} /* Sentinel */
+};
+
+PyTypeObject PyBobLearnFormulaActivation_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    s_formulaactivation_str,                            /*tp_name*/
+    sizeof(PyBobLearnFormulaActivationObject),          /*tp_basicsize*/
+    0,                                                  /*tp_itemsize*/
+    (destructor)PyBobLearnFormulaActivation_delete,     /*tp_dealloc*/
+    0,                                                  /*tp_print*/
+    0,                                                  /*tp_getattr*/
+    0,                                                  /*tp_setattr*/
+    0,                                                  /*tp_compare*/
+    0,                                                  /*tp_repr*/
+    0,                                                  /*tp_as_number*/
+    0,                                                  /*tp_as_sequence*/
+    0,                                                  /*tp_as_mapping*/
+    0,                                                  /*tp_hash */
+    0,                                                  /*tp_call*/
+    0,                                                  /*tp_str*/
+    0,                                                  /*tp_getattro*/
+    0,                                                  /*tp_setattro*/
+    0,                                                  /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,           /*tp_flags*/
+    s_formulaactivation_doc,                            /* tp_doc */
+    0,		                                              /* tp_traverse */
+    0,		                                              /* tp_clear */
+    0,                                                  /* tp_richcompare */
+    0,		                                              /* tp_weaklistoffset */
+    0,		                                              /* tp_iter */
+    0,		                                              /* tp_iternext */
+    PyBobLearnFormulaActivation_methods,                /* tp_methods */
+    0,                                                  /* tp_members */
+    PyBobLearnFormulaActivation_getseters,              /* tp_getset */
+    0,                                                  /* tp_base */
+    0,                                                  /* tp_dict */
+    0,                                                  /* tp_descr_get */
+    0,                                                  /* tp_descr_set */
+    0,                                                  /* tp_dictoffset */
+    (initproc)PyBobLearnFormulaActivation_init,         /* tp_init */
+    0,                                                  /* tp_alloc */
+    0,                                                  /* tp_new */
+};
@@ -11,10 +11,36 @@
 #define BOB_LEARN_ACTIVATION_ACTIVATION_H
 
 #include <string>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <typeinfo>
+#include <cmath>
+#include <limits>
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 #include <bob.io.base/HDF5File.h>
 
 namespace bob { namespace learn { namespace activation {
+
+  class Counters;
+  class ResultCache;
+
+  /**
+   * Identifies one of the evaluation methods of an Activation
+   */
+  enum Method {
+    F = 0, ///< Activation::f()
+    F_PRIME, ///< Activation::f_prime()
+    F_PRIME_FROM_F, ///< Activation::f_prime_from_f()
+    F_SECOND, ///< Activation::f_second()
+    F_SECOND_FROM_F ///< Activation::f_second_from_f()
+  };
+
   /**
    * Base class for activation functions. All activation functions must derive
    * from this one.
@@ -23,6 +49,17 @@ namespace bob { namespace learn { namespace activation {
 
     public: // api
 
+      Activation(): m_counters(0) {}
+
+      /**
+       * Copies do not share the counters() nor the result_cache() of the
+       * original
+       */
+      Activation(const Activation&): m_counters(0) {}
+      Activation& operator= (const Activation&) { return *this; }
+
+      virtual ~Activation();
+
       /**
        * Computes activated value, given an input.
        */
@@ -40,6 +77,102 @@ namespace bob { namespace learn { namespace activation {
        */
       virtual double f_prime_from_f (double a) const =0;
 
+      /**
+       * Computes the second derivative of the current activation - i.e., the
+       * same input as for f().
+       */
+      virtual double f_second (double z) const { return f_second_from_f(f(z)); }
+
+      /**
+       * Computes the second derivative, given the activated value. The
+       * default implementation throws std::runtime_error: derived classes
+       * that support second derivatives must override this (or f_second()).
+       */
+      virtual double f_second_from_f (double a) const;
+
+      /**
+       * Computes activated values for a run of @c n inputs read from @c z
+       * every @c zs elements, writing results to @c a every @c as elements.
+       * Derived classes should override this to avoid one virtual call per
+       * element.
+       */
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = f(*z); }
+
+      /**
+       * Computes the derivative for a run of @c n inputs - see f_batch()
+       */
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = f_prime(*z); }
+
+      /**
+       * Computes the derivative for a run of @c n activated values - see
+       * f_batch()
+       */
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = f_prime_from_f(*a); }
+
+      /**
+       * Computes the second derivative for a run of @c n inputs - see
+       * f_batch()
+       */
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = f_second(*z); }
+
+      /**
+       * Computes the second derivative for a run of @c n activated values -
+       * see f_batch()
+       */
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = f_second_from_f(*a); }
+
+      /**
+       * Calls the batch version of the method @c m - see f_batch(). Not
+       * counted, see Counters.h.
+       */
+      void batch (Method m, const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const {
+        switch (m) {
+          case F: f_batch(z, zs, a, as, n); break;
+          case F_PRIME: f_prime_batch(z, zs, a, as, n); break;
+          case F_PRIME_FROM_F: f_prime_from_f_batch(z, zs, a, as, n); break;
+          case F_SECOND: f_second_batch(z, zs, a, as, n); break;
+          case F_SECOND_FROM_F: f_second_from_f_batch(z, zs, a, as, n); break;
+        }
+      }
+
+      /**
+       * Returns, in @c lower and @c upper, the activated values beyond which
+       * this function is considered saturated, i.e., its derivative nearly
+       * vanishes. Functions that do not saturate return infinities.
+       */
+      virtual void saturation (double& lower, double& upper) const
+      { lower = -std::numeric_limits<double>::infinity(); upper = std::numeric_limits<double>::infinity(); }
+
+      /**
+       * Returns the parameters of this function, in a fixed order. Together
+       * with unique_identifier(), they fully determine the function.
+       */
+      virtual std::vector<double> parameters() const { return std::vector<double>(); }
+
+      /**
+       * Tells if @c other is the same function: same type and identical
+       * parameters(), compared bit by bit. The default implementation
+       * compares unique_identifier() and parameters().
+       */
+      virtual bool equals (const Activation& other) const;
+
+      /**
+       * Returns a hash of the type and parameters, consistent with equals()
+       */
+      virtual std::size_t hash () const;
+
+      /**
+       * Returns a new, independent copy of this function. The default
+       * implementation uses the builder registered for unique_identifier()
+       * with the current parameters().
+       */
+      virtual boost::shared_ptr<Activation> clone() const;
+
       /**
        * Saves itself to an HDF5File
        */
@@ -61,6 +194,38 @@ namespace bob { namespace learn { namespace activation {
        */
       virtual std::string str() const =0;
 
+      /**
+       * Returns the counters of the evaluations of this instance, created on
+       * first use - see Counters.h. Instances shared by interning share
+       * their counters.
+       */
+      Counters& counters() const;
+
+      /**
+       * Returns the cache of the results of this instance, empty unless set
+       * - see ResultCache.h
+       */
+      const boost::shared_ptr<ResultCache>& result_cache() const { return m_cache; }
+
+      /**
+       * Sets the cache of the results of this instance, or removes it, if
+       * empty. Not to be called while the instance is evaluated.
+       */
+      void set_result_cache(const boost::shared_ptr<ResultCache>& cache) { m_cache = cache; }
+
+    protected: // helpers
+
+      /**
+       * Compares two parameters bit by bit, as equals() does
+       */
+      static bool same_parameter (double a, double b)
+      { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+    private: // representation
+
+      mutable std::atomic<Counters*> m_counters; ///< null until first used
+      boost::shared_ptr<ResultCache> m_cache; ///< empty if not caching
+
   };
 
   /**
@@ -68,11 +233,68 @@ namespace bob { namespace learn { namespace activation {
    */
   typedef boost::shared_ptr<Activation> (*activation_factory_t) (bob::io::base::HDF5File& f);
 
+  /**
+   * Generic interface for Activation object builders, which create an
+   * Activation given its Activation::unique_identifier() and
+   * Activation::parameters(). Throws if the parameters are not acceptable.
+   */
+  typedef boost::shared_ptr<Activation> (*activation_builder_t) (const std::string& unique_identifier, const std::vector<double>& parameters);
+
   /**
    * Loads an activation function from file using the new API
    */
   boost::shared_ptr<Activation> load_activation(bob::io::base::HDF5File& f);
 
+  /**
+   * Turns interning of activations loaded with load_activation() on or off,
+   * returning the previous setting. While on, activations with the same
+   * identifier and parameters share a single instance, which must not be
+   * modified afterwards (e.g. with Activation::load()). Off by default.
+   */
+  bool set_interning(bool enabled);
+
+  /**
+   * Tells if load_activation() currently interns what it loads
+   */
+  bool interning();
+
+  /**
+   * Returns the shared instance with the same identifier and parameters as
+   * @c a, making @c a that instance if there is none yet. Instances are
+   * only held weakly: they are released once no longer used.
+   */
+  boost::shared_ptr<Activation> intern_activation(const boost::shared_ptr<Activation>& a);
+
+  /**
+   * Counters of the interning table
+   */
+  struct InterningStatistics {
+    std::size_t requests; ///< instances looked up
+    std::size_t deduplicated; ///< look-ups that returned an existing instance
+    std::size_t live; ///< shared instances still in use
+  };
+
+  /**
+   * Returns the current interning counters
+   */
+  InterningStatistics interning_statistics();
+
+  /**
+   * Resets the look-up counters of interning_statistics() to zero
+   */
+  void reset_interning_statistics();
+
+  /**
+   * Returns independent copies of @c activations, made with
+   * Activation::clone() (which, by default, uses the builder registered for
+   * each type). Activations that appear several times, e.g. shared by
+   * several layers, are copied once and the copies are shared the same way.
+   * Threads that evaluate activations concurrently should each work on their
+   * own copies, made from that thread, so that neither reference counts nor
+   * the copies themselves are shared between cores.
+   */
+  std::vector<boost::shared_ptr<Activation> > clone_activations(const std::vector<boost::shared_ptr<Activation> >& activations);
+
   /**
    * Loads an activation function using the old API
    *
@@ -92,6 +314,20 @@ namespace bob { namespace learn { namespace activation {
       virtual double f (double z) const { return z; }
       virtual double f_prime (double z) const { return 1.; }
       virtual double f_prime_from_f (double a) const { return 1.; }
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = *z; }
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as) *a = 1.; }
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, d+=ds) *d = 1.; }
+      virtual double f_second (double z) const { return 0.; }
+      virtual double f_second_from_f (double a) const { return 0.; }
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as) *a = 0.; }
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, d+=ds) *d = 0.; }
+      virtual bool equals (const Activation& other) const { return typeid(other) == typeid(*this); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<IdentityActivation>(*this); }
       virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.Identity"; }
       virtual std::string str() const { return "f(z) = z"; }
 
@@ -109,9 +345,25 @@ namespace bob { namespace learn { namespace activation {
       virtual double f (double z) const { return m_C * z; }
       virtual double f_prime (double z) const { return m_C; }
       virtual double f_prime_from_f (double a) const { return m_C; }
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = m_C * *z; }
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as) *a = m_C; }
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, d+=ds) *d = m_C; }
+      virtual double f_second (double z) const { return 0.; }
+      virtual double f_second_from_f (double a) const { return 0.; }
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as) *a = 0.; }
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, d+=ds) *d = 0.; }
       double C() const { return m_C; }
+      virtual std::vector<double> parameters() const { return std::vector<double>(1, m_C); }
       virtual void save(bob::io::base::HDF5File& f) const { Activation::save(f); f.set("C", m_C); }
       virtual void load(bob::io::base::HDF5File& f) { m_C = f.read<double>("C"); }
+      virtual bool equals (const Activation& other) const
+      { return typeid(other) == typeid(*this) && same_parameter(static_cast<const LinearActivation&>(other).m_C, m_C); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<LinearActivation>(*this); }
       virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.Linear"; }
       virtual std::string str() const { return (boost::format("f(z) = %.5e * z") % m_C).str(); }
 
@@ -131,6 +383,20 @@ namespace bob { namespace learn { namespace activation {
       virtual ~HyperbolicTangentActivation() {}
       virtual double f (double z) const { return std::tanh(z); }
       virtual double f_prime_from_f (double a) const { return (1. - (a*a)); }
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = std::tanh(*z); }
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double t = std::tanh(*z); *a = 1. - t*t; } }
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = 1. - (*a)*(*a); }
+      virtual double f_second_from_f (double a) const { return -2. * a * (1. - a*a); }
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double t = std::tanh(*z); *a = -2. * t * (1. - t*t); } }
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = -2. * *a * (1. - (*a)*(*a)); }
+      virtual void saturation (double& lower, double& upper) const { lower = -.99; upper = .99; }
+      virtual bool equals (const Activation& other) const { return typeid(other) == typeid(*this); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<HyperbolicTangentActivation>(*this); }
       virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.HyperbolicTangent"; }
       virtual std::string str() const { return "f(z) = tanh(z)"; }
 
@@ -147,10 +413,26 @@ namespace bob { namespace learn { namespace activation {
       virtual ~MultipliedHyperbolicTangentActivation() {}
       virtual double f (double z) const { return m_C * std::tanh(m_M * z); }
       virtual double f_prime_from_f (double a) const { return m_C * m_M * (1. - std::pow(a/m_C,2)); }
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = m_C * std::tanh(m_M * *z); }
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double t = std::tanh(m_M * *z); *a = m_C * m_M * (1. - t*t); } }
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) { double t = *a / m_C; *d = m_C * m_M * (1. - t*t); } }
+      virtual double f_second_from_f (double a) const { double t = a / m_C; return -2. * m_C * m_M * m_M * t * (1. - t*t); }
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double t = std::tanh(m_M * *z); *a = -2. * m_C * m_M * m_M * t * (1. - t*t); } }
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) { double t = *a / m_C; *d = -2. * m_C * m_M * m_M * t * (1. - t*t); } }
+      virtual void saturation (double& lower, double& upper) const { upper = .99 * std::fabs(m_C); lower = -upper; }
       double C() const { return m_C; }
       double M() const { return m_M; }
-      virtual void save(bob::io::base::HDF5File& f) const { Activation::save(f); f.set("C", m_C); f.set("M", m_C); }
+      virtual std::vector<double> parameters() const { std::vector<double> p(2); p[0] = m_C; p[1] = m_M; return p; }
+      virtual void save(bob::io::base::HDF5File& f) const { Activation::save(f); f.set("C", m_C); f.set("M", m_M); }
       virtual void load(bob::io::base::HDF5File& f) {m_C = f.read<double>("C"); m_M = f.read<double>("M"); }
+      virtual bool equals (const Activation& other) const
+      { if (typeid(other) != typeid(*this)) return false; auto& o = static_cast<const MultipliedHyperbolicTangentActivation&>(other); return same_parameter(o.m_C, m_C) && same_parameter(o.m_M, m_M); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<MultipliedHyperbolicTangentActivation>(*this); }
       virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.MultipliedHyperbolicTangent"; }
       virtual std::string str() const { return (boost::format("f(z) = %.5e * tanh(%.5e * z)") % m_C % m_M).str(); }
 
@@ -171,6 +453,20 @@ namespace bob { namespace learn { namespace activation {
       virtual ~LogisticActivation() {}
       virtual double f (double z) const { return 1. / ( 1. + std::exp(-z) ); }
       virtual double f_prime_from_f (double a) const { return a * (1. - a); }
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) *a = 1. / ( 1. + std::exp(-*z) ); }
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double l = 1. / ( 1. + std::exp(-*z) ); *a = l * (1. - l); } }
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = *a * (1. - *a); }
+      virtual double f_second_from_f (double a) const { return a * (1. - a) * (1. - 2.*a); }
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, z+=zs, a+=as) { double l = 1. / ( 1. + std::exp(-*z) ); *a = l * (1. - l) * (1. - 2.*l); } }
+      virtual void f_second_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const
+      { for (std::size_t k=0; k<n; ++k, a+=as, d+=ds) *d = *a * (1. - *a) * (1. - 2. * *a); }
+      virtual void saturation (double& lower, double& upper) const { lower = .01; upper = .99; }
+      virtual bool equals (const Activation& other) const { return typeid(other) == typeid(*this); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<LogisticActivation>(*this); }
       virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.Logistic"; }
       virtual std::string str() const { return "f(z) = 1./(1. + e^-z)"; }
 
@@ -180,6 +476,24 @@ namespace bob { namespace learn { namespace activation {
   /**
    * The ActivationRegistry holds registered loaders for different types of
    * Activation functions.
+   *
+   * The registry is safe to use from multiple threads. Readers work on an
+   * immutable, hash-indexed snapshot of the registered factories, which
+   * they acquire without locking; writers are serialized and publish a new
+   * snapshot (read-copy-update). Identifiers that use the legacy "machine"
+   * name are resolved once and remembered, so the deprecation warning is
+   * only issued once per identifier.
+   *
+   * Activations may also come from plugins: shared libraries that register
+   * their factories and builders from static objects, like the ones in
+   * ActivationRegistry.cpp do. Plugin directories (added with
+   * addPluginDirectory() or listed, separated by colons, in the environment
+   * variable BOB_LEARN_ACTIVATION_PLUGIN_PATH) contain manifests, files
+   * named *.manifest with one "<unique identifier> <library>" pair per line
+   * (libraries are relative to the manifest, lines starting with # are
+   * ignored). Manifests are only read, and libraries only loaded, when an
+   * identifier that is not registered is first requested, so plugins cost
+   * nothing to processes that do not use them.
    */
   class ActivationRegistry {
 
@@ -190,11 +504,10 @@ namespace bob { namespace learn { namespace activation {
        */
       static boost::shared_ptr<ActivationRegistry> instance();
 
-      static const std::map<std::string, activation_factory_t>& getFactories ()
-      {
-        boost::shared_ptr<ActivationRegistry> ptr = instance();
-        return ptr->s_id2factory;
-      }
+      /**
+       * Returns a copy of the currently registered factories
+       */
+      static std::map<std::string, activation_factory_t> getFactories ();
 
     public: //object access
 
@@ -207,14 +520,74 @@ namespace bob { namespace learn { namespace activation {
 
       bool isRegistered(const std::string& unique_identifier);
 
+      /**
+       * Registers a builder, used to create activations of the given type
+       * from their parameters, e.g. when loading compact records
+       */
+      void registerBuilder(const std::string& unique_identifier,
+          activation_builder_t builder);
+
+      /**
+       * Returns the builder for the given type, throwing if there is none
+       */
+      activation_builder_t findBuilder(const std::string& unique_identifier);
+
+      /**
+       * Adds a directory of plugin manifests, read the next time an
+       * unregistered identifier is requested
+       */
+      void addPluginDirectory(const std::string& directory);
+
+      /**
+       * Returns the libraries of all known plugins, by identifier. Reads
+       * pending plugin directories, but loads no library.
+       */
+      std::map<std::string, std::string> getPlugins();
+
     private:
 
-      ActivationRegistry (): s_id2factory() {}
+      /**
+       * An immutable state of the registry
+       */
+      struct Snapshot {
+        std::unordered_map<std::string, activation_factory_t> factories;
+        std::unordered_map<std::string, activation_builder_t> builders;
+        std::unordered_map<std::string, std::string> aliases; ///< legacy to current identifiers
+      };
+
+      ActivationRegistry ();
 
       // Not implemented
       ActivationRegistry (const ActivationRegistry&);
 
-      std::map<std::string, activation_factory_t> s_id2factory;
+      /**
+       * Returns the current state, without locking
+       */
+      boost::shared_ptr<const Snapshot> snapshot() const;
+
+      /**
+       * Resolves and remembers a legacy identifier (writer side)
+       */
+      activation_factory_t resolve(const std::string& unique_identifier);
+
+      /**
+       * Reads the manifests of pending plugin directories (plugin side)
+       */
+      void scanPlugins();
+
+      /**
+       * Loads the plugin library providing the given identifier, if it was
+       * not loaded yet. Returns if there is such a library.
+       */
+      bool loadPlugin(const std::string& unique_identifier);
+
+      boost::shared_ptr<const Snapshot> m_snapshot; ///< accessed atomically
+      std::mutex m_writer; ///< serializes writers
+
+      std::recursive_mutex m_plugin_mutex; ///< plugins may request others while loading
+      std::vector<std::string> m_plugin_directories; ///< pending
+      std::map<std::string, std::string> m_plugins; ///< libraries, by identifier
+      std::map<std::string, void*> m_libraries; ///< loaded, never closed
 
   };
 
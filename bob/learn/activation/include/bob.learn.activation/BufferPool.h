@@ -0,0 +1,116 @@
+/**
+ * @date Mon 19 Oct 2026 09:12:40 CEST
+ *
+ * @brief A pool recycling the memory of output arrays
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_BUFFERPOOL_H
+#define BOB_LEARN_ACTIVATION_BUFFERPOOL_H
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Counters of a BufferPool
+   */
+  struct BufferPoolStatistics {
+    uint64_t hits; ///< buffers handed out from the pool
+    uint64_t misses; ///< buffers allocated
+    uint64_t huge; ///< buffers allocated with transparent huge pages
+    uint64_t dropped; ///< buffers freed on release, as the pool was full
+    std::size_t buffers; ///< buffers currently pooled
+    std::size_t bytes; ///< bytes currently pooled
+  };
+
+  /**
+   * Keeps released buffers, by size, to hand them out again instead of
+   * allocating new ones, so that loops over arrays of repeating shapes stop
+   * allocating and faulting in memory after their first iteration.
+   *
+   * Buffers of HUGE_BUFFER bytes or more are aligned to and advised to use
+   * transparent huge pages, where available. New buffers are not touched, so
+   * that their pages are placed, on NUMA machines, by the threads that first
+   * write them, i.e. those evaluating the array (see parallel_batch()).
+   */
+  class BufferPool {
+
+    public: //api
+
+      /**
+       * Size from which buffers are backed by huge pages
+       */
+      static const std::size_t HUGE_BUFFER = 1 << 21;
+
+      /**
+       * Creates a pool keeping at most @c limit bytes
+       */
+      BufferPool(std::size_t limit=1 << 28);
+
+      /**
+       * Frees all buffers pooled
+       */
+      ~BufferPool();
+
+      /**
+       * Returns a buffer of @c bytes bytes, aligned to 64 bytes. Throws
+       * std::bad_alloc on failure.
+       */
+      void* acquire(std::size_t bytes);
+
+      /**
+       * Gives back a buffer acquired from this pool, which keeps it unless it
+       * would then exceed its limit
+       */
+      void release(void* buffer, std::size_t bytes);
+
+      /**
+       * Frees all buffers pooled
+       */
+      void clear();
+
+      /**
+       * Sets the maximum number of bytes pooled, freeing buffers if needed,
+       * and returns the previous limit
+       */
+      std::size_t set_limit(std::size_t limit);
+
+      BufferPoolStatistics statistics() const;
+
+    private: //representation
+
+      void trim(); ///< frees buffers above the limit, with the lock held
+
+      mutable std::mutex m_mutex;
+      std::multimap<std::size_t, void*> m_free; ///< buffers, by size
+      std::size_t m_limit;
+      BufferPoolStatistics m_statistics;
+
+  };
+
+  namespace detail { extern std::atomic<bool> pooling; }
+
+  /**
+   * Turns pooling of output arrays on or off, returning the previous
+   * setting. Off by default.
+   */
+  bool set_pooling(bool enabled);
+
+  /**
+   * Tells if output arrays are pooled
+   */
+  inline bool pooling() { return detail::pooling.load(std::memory_order_relaxed); }
+
+  /**
+   * The pool of output arrays
+   */
+  BufferPool& buffer_pool();
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_BUFFERPOOL_H */
@@ -0,0 +1,117 @@
+/**
+ * @date Thu 15 Oct 2026 09:41:18 CEST
+ *
+ * @brief Compact binary serialization of activation functions
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_COMPACT_H
+#define BOB_LEARN_ACTIVATION_COMPACT_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Maximum number of parameters an activation may have to be stored in
+   * compact form
+   */
+  const std::size_t COMPACT_MAX_PARAMETERS = 3;
+
+  /**
+   * One activation function in compact form: a fixed-size record holding the
+   * index of its unique identifier in the table of types that precedes the
+   * records, and its parameters inline.
+   */
+  struct CompactRecord {
+    uint32_t type; ///< index in the type table
+    uint32_t n_parameters; ///< number of parameters used
+    double parameters[COMPACT_MAX_PARAMETERS]; ///< Activation::parameters()
+  };
+
+  /**
+   * Serializes @c activations into a compact byte string, in the host byte
+   * order. It starts with a 16-byte header (magic, format version, number of
+   * types and of records), followed by the table of unique identifiers used
+   * (each stored once, as a 32-bit length and the characters), then by one
+   * CompactRecord per activation, at an 8-byte aligned offset.
+   *
+   * Throws if an activation has more than COMPACT_MAX_PARAMETERS parameters.
+   */
+  std::string save_compact(const std::vector<boost::shared_ptr<Activation> >& activations);
+
+  /**
+   * Creates activations from @c size bytes of compact data, as produced by
+   * save_compact(), using the builders of the ActivationRegistry. Builders are
+   * looked up once per type. Results are interned if interning() is on.
+   */
+  std::vector<boost::shared_ptr<Activation> > load_compact(const void* data, std::size_t size);
+
+  /**
+   * Writes @c activations in compact form to the file @c filename
+   */
+  void save_bundle(const std::string& filename,
+      const std::vector<boost::shared_ptr<Activation> >& activations);
+
+  /**
+   * Loads all activations in the compact file @c filename
+   */
+  std::vector<boost::shared_ptr<Activation> > load_bundle(const std::string& filename);
+
+  /**
+   * A read-only, memory-mapped file of activations in compact form, from
+   * which individual activations can be created on demand.
+   */
+  class MappedBundle {
+
+    public: //api
+
+      /**
+       * Maps the file @c filename into memory and checks its header
+       */
+      explicit MappedBundle(const std::string& filename);
+
+      /**
+       * Unmaps the file
+       */
+      ~MappedBundle();
+
+      /**
+       * Returns the number of activations in the bundle
+       */
+      std::size_t size() const { return m_count; }
+
+      /**
+       * Creates the activation @c k of the bundle
+       */
+      boost::shared_ptr<Activation> load(std::size_t k) const;
+
+      /**
+       * Creates all activations of the bundle
+       */
+      std::vector<boost::shared_ptr<Activation> > load() const;
+
+    private: //not implemented
+
+      MappedBundle(const MappedBundle&);
+      MappedBundle& operator= (const MappedBundle&);
+
+    private: //representation
+
+      void* m_data; ///< mapped file
+      std::size_t m_size; ///< size of the mapping, in bytes
+      const char* m_records; ///< first record
+      std::size_t m_count; ///< number of records
+      std::vector<std::string> m_types; ///< identifier of each type
+      std::vector<activation_builder_t> m_builders; ///< builder of each type
+
+  };
+
+} } }
+
+#endif /* BOB_LEARN_ACTIVATION_COMPACT_H */
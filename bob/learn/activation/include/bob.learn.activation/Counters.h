@@ -0,0 +1,177 @@
+/**
+ * @date Sun 18 Oct 2026 14:26:51 CEST
+ *
+ * @brief Call counters and latency histograms of activation evaluations
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_COUNTERS_H
+#define BOB_LEARN_ACTIVATION_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <bob.learn.activation/Activation.h>
+
+/**
+ * Set to 0 to compile instrumentation out of the evaluation paths
+ */
+#ifndef BOB_LEARN_ACTIVATION_WITH_COUNTERS
+#define BOB_LEARN_ACTIVATION_WITH_COUNTERS 1
+#endif
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Identifies how an evaluation was carried out
+   */
+  enum Path {
+    SCALAR = 0, ///< a single value
+    SERIAL, ///< an array, in the calling thread
+    PARALLEL ///< an array, in a helper or background thread
+  };
+
+  static const std::size_t COUNTED_METHODS = F_SECOND_FROM_F + 1;
+  static const std::size_t COUNTED_PATHS = PARALLEL + 1;
+
+  /**
+   * Number of latency histogram buckets: bucket @c k counts the evaluations
+   * that took [2^k, 2^(k+1)) nanoseconds, the last one also longer ones
+   */
+  static const std::size_t LATENCY_BUCKETS = 32;
+
+  /**
+   * A copy of the counters of one method and path
+   */
+  struct CallStatistics {
+    uint64_t calls; ///< evaluations
+    uint64_t elements; ///< values computed
+    uint64_t bytes; ///< moved: values read and written
+    uint64_t nanoseconds; ///< spent, in total
+    uint64_t histogram[LATENCY_BUCKETS]; ///< of latencies
+  };
+
+  /**
+   * Counts evaluations, values and time spent, with a histogram of
+   * latencies, by method and path. Counters are updated with relaxed
+   * atomic operations, so they may be shared between threads.
+   *
+   * Only the entry points of this library are counted: the Python bindings,
+   * the evaluation of streams and datasets (Stream.h) and Tape::backward().
+   * The C++ evaluation methods of Activation, f() to f_second_from_f(), their
+   * batch versions and Activation::batch(), are not, since the entry points
+   * call them on every value or chunk of the calls they already count. C++
+   * code calling them directly should wrap its calls in a CallTimer.
+   */
+  class Counters {
+
+    public: //api
+
+      Counters();
+
+      /**
+       * Records an evaluation of @c elements values
+       */
+      void record(Method m, Path p, std::size_t elements, uint64_t nanoseconds);
+
+      /**
+       * Returns the current counters of method @c m and path @c p
+       */
+      CallStatistics get(Method m, Path p) const;
+
+      /**
+       * Sets all counters to zero
+       */
+      void reset();
+
+    private: //representation
+
+      struct Cell {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> elements;
+        std::atomic<uint64_t> nanoseconds;
+        std::atomic<uint64_t> histogram[LATENCY_BUCKETS];
+      };
+
+      Cell m_cells[COUNTED_METHODS][COUNTED_PATHS];
+
+  };
+
+  namespace detail { extern std::atomic<bool> counting; }
+
+  /**
+   * Turns counting of evaluations on or off, returning the previous setting.
+   * Off by default.
+   */
+  bool set_counting(bool enabled);
+
+  /**
+   * Tells if evaluations are currently counted
+   */
+  inline bool counting() { return detail::counting.load(std::memory_order_relaxed); }
+
+  /**
+   * The counters of all evaluations, of all activation functions
+   */
+  Counters& global_counters();
+
+  /**
+   * Times an evaluation, from construction to destruction, and records it to
+   * the counters of the activation function (see Activation::counters())
+   * and to the global ones, if counting is on. Costs a test of a flag if
+   * counting is off and nothing if compiled out.
+   */
+  class CallTimer {
+
+    public: //api
+
+#if BOB_LEARN_ACTIVATION_WITH_COUNTERS
+
+      CallTimer(const Activation& activation, Method m, Path p, std::size_t elements):
+        m_activation(counting() ? &activation : 0), m_method(m), m_path(p),
+        m_elements(elements)
+      {
+        if (m_activation) m_start = std::chrono::steady_clock::now();
+      }
+
+      ~CallTimer() {
+        if (!m_activation) return;
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+          (std::chrono::steady_clock::now() - m_start).count();
+        m_activation->counters().record(m_method, m_path, m_elements, ns);
+        global_counters().record(m_method, m_path, m_elements, ns);
+      }
+
+      /**
+       * Records nothing, e.g. if the evaluation timed turned out to be
+       * carried out, and counted, elsewhere
+       */
+      void dismiss() { m_activation = 0; }
+
+    private: //representation
+
+      const Activation* m_activation; ///< null if not counting
+      Method m_method;
+      Path m_path;
+      std::size_t m_elements;
+      std::chrono::steady_clock::time_point m_start;
+
+#else
+
+      CallTimer(const Activation&, Method, Path, std::size_t) {}
+
+      void dismiss() {}
+
+#endif
+
+    private: //not implemented
+
+      CallTimer(const CallTimer&);
+      CallTimer& operator= (const CallTimer&);
+
+  };
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_COUNTERS_H */
@@ -0,0 +1,84 @@
+/**
+ * @date Tue 13 Oct 2026 09:41:17 CEST
+ *
+ * @brief A background executor for activation jobs
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_EXECUTOR_H
+#define BOB_LEARN_ACTIVATION_EXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/function.hpp>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Runs jobs submitted from any thread on a background worker thread.
+   *
+   * Each job has a @c work part and a @c done part. The worker drains all
+   * queued jobs at once (up to a maximum batch size), runs their @c work
+   * parts and then hands all their @c done parts, in submission order, to a
+   * single call of the completion function. Many small jobs therefore cost a
+   * single wake-up and a single completion call per batch. Completion
+   * functions may use this to, e.g., acquire a lock once per batch.
+   */
+  class Executor {
+
+    public: //types
+
+      typedef boost::function<void ()> task_t;
+      typedef boost::function<void (const std::vector<task_t>&)> completer_t;
+
+    public: //api
+
+      /**
+       * Starts the worker thread. If @c completer is empty, @c done parts
+       * are called one after the other.
+       */
+      Executor(const completer_t& completer=completer_t(), std::size_t max_batch=256);
+
+      /**
+       * Finishes all queued jobs and stops the worker
+       */
+      ~Executor();
+
+      /**
+       * Queues a new job. Throws if the executor was shut down. Neither
+       * @c work nor @c done may throw.
+       */
+      void submit(const task_t& work, const task_t& done);
+
+      /**
+       * Finishes all queued jobs and joins the worker. Further submissions
+       * throw. Calling this more than once is harmless.
+       */
+      void shutdown();
+
+      /**
+       * Number of jobs queued, but not yet picked up by the worker
+       */
+      std::size_t pending() const;
+
+    private: //representation
+
+      void run();
+
+      completer_t m_completer;
+      std::size_t m_max_batch;
+      std::deque<std::pair<task_t, task_t> > m_queue;
+      mutable std::mutex m_mutex;
+      std::condition_variable m_cond;
+      bool m_stop;
+      std::thread m_worker;
+
+  };
+
+} } }
+
+#endif /* BOB_LEARN_ACTIVATION_EXECUTOR_H */
@@ -0,0 +1,110 @@
+/**
+ * @date Sat 17 Oct 2026 09:41:12 CEST
+ *
+ * @brief Activation functions defined by a formula, evaluated by a small
+ * vectorized bytecode interpreter
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_FORMULAACTIVATION_H
+#define BOB_LEARN_ACTIVATION_FORMULAACTIVATION_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * A formula compiled for evaluation - see FormulaActivation
+   */
+  struct CompiledFormula;
+
+  /**
+   * Implements the activation function given by a formula of the input,
+   * e.g. "z / (1 + abs(z))". The input is named @c z (or @c x) and formulas
+   * may use numbers, named parameters, @c pi, @c e, the operators +, -, *, /
+   * and ^ (or **), parentheses and the functions abs, sign, exp, log, log1p,
+   * sqrt, tanh, sinh, cosh, sin, cos and erf.
+   *
+   * Formulas are parsed once into an expression tree, which is differentiated
+   * symbolically to obtain f_prime() and f_second(). All are compiled to a stack-based
+   * bytecode whose instructions operate on blocks of values, so that the
+   * cost of interpreting each instruction is amortized over the block.
+   *
+   * The derivative cannot, in general, be computed from the activated value
+   * alone. To support f_prime_from_f(), give a formula for it in terms of
+   * the activated value @c a, e.g. "1 - a^2" for "tanh(z)".
+   */
+  class FormulaActivation: public Activation {
+
+    public: // api
+
+      /**
+       * Builds a new function from @c formula, where the parameters named
+       * @c names take the corresponding @c values, and the (optional)
+       * derivative @c f_prime_from_f. Throws std::runtime_error if either
+       * formula cannot be parsed.
+       */
+      FormulaActivation(const std::string& formula="z",
+          const std::vector<std::string>& names=std::vector<std::string>(),
+          const std::vector<double>& values=std::vector<double>(),
+          const std::string& f_prime_from_f="");
+
+      virtual ~FormulaActivation();
+
+      virtual double f (double z) const;
+      virtual double f_prime (double z) const;
+      virtual double f_second (double z) const;
+      virtual double f_prime_from_f (double a) const;
+      virtual void f_batch (const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as, std::size_t n) const;
+      virtual void f_prime_batch (const double* z, std::ptrdiff_t zs, double* d, std::ptrdiff_t ds, std::size_t n) const;
+      virtual void f_second_batch (const double* z, std::ptrdiff_t zs, double* d, std::ptrdiff_t ds, std::size_t n) const;
+      virtual void f_prime_from_f_batch (const double* a, std::ptrdiff_t as, double* d, std::ptrdiff_t ds, std::size_t n) const;
+
+      /**
+       * The formula, as given
+       */
+      const std::string& formula() const;
+
+      /**
+       * The symbolic derivative of the formula, simplified
+       */
+      std::string derivative() const;
+
+      /**
+       * The symbolic second derivative of the formula, simplified
+       */
+      std::string second_derivative() const;
+
+      /**
+       * The formula of the derivative in terms of the activated value, as
+       * given, or an empty string
+       */
+      const std::string& f_prime_from_f_formula() const;
+
+      /**
+       * The names of the parameters, in the order of parameters()
+       */
+      const std::vector<std::string>& names() const;
+
+      virtual std::vector<double> parameters() const;
+      virtual void save(bob::io::base::HDF5File& f) const;
+      virtual void load(bob::io::base::HDF5File& f);
+      virtual bool equals (const Activation& other) const;
+      virtual std::size_t hash () const;
+      virtual boost::shared_ptr<Activation> clone() const;
+      virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.Formula"; }
+      virtual std::string str() const;
+
+    private: // representation
+
+      boost::shared_ptr<const CompiledFormula> m_compiled; ///< immutable, shared by copies
+
+  };
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_FORMULAACTIVATION_H */
@@ -0,0 +1,109 @@
+/**
+ * @date Mon 19 Oct 2026 14:03:18 CEST
+ *
+ * @brief A bounded cache of the results of activation functions, by input
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_RESULTCACHE_H
+#define BOB_LEARN_ACTIVATION_RESULTCACHE_H
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <boost/shared_array.hpp>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Counters of a ResultCache
+   */
+  struct ResultCacheStatistics {
+    uint64_t hits; ///< look-ups that found their result
+    uint64_t misses; ///< look-ups that did not
+    uint64_t collisions; ///< misses of inputs with the hash of a cached one
+    uint64_t evictions; ///< results dropped to make room
+    std::size_t entries; ///< results cached
+    std::size_t bytes; ///< of inputs and results cached
+  };
+
+  /**
+   * Keeps the results of the latest evaluations of arrays, by method, shape
+   * and contents of the input, up to a number of entries and of bytes,
+   * dropping the least recently used ones first.
+   *
+   * Inputs are looked up by a 64-bit hash of their contents, computed at
+   * about memory bandwidth, and compared in full on a match, so that hash
+   * collisions never return wrong results. Cached inputs are therefore
+   * copied, and count against the limit of bytes along with the results.
+   */
+  class ResultCache {
+
+    public: //api
+
+      /**
+       * Creates a cache of at most @c entries results and @c bytes bytes
+       */
+      ResultCache(std::size_t entries, std::size_t bytes);
+
+      /**
+       * Returns the result cached for method @c m of the @c n contiguous
+       * values of @c z, which have the given shape, or an empty array. Sets
+       * @c hash, to be passed to insert() on a miss.
+       */
+      boost::shared_array<double> find(Method m, const std::vector<std::size_t>& shape,
+          const double* z, std::size_t n, uint64_t& hash);
+
+      /**
+       * Caches @c result, the result of method @c m for the @c n values of
+       * @c z, whose @c hash was computed by find(), evicting older results
+       * if needed. Results larger than the cache are ignored.
+       */
+      void insert(Method m, const std::vector<std::size_t>& shape,
+          const double* z, std::size_t n, uint64_t hash, const double* result);
+
+      /**
+       * Drops all results cached
+       */
+      void clear();
+
+      ResultCacheStatistics statistics() const;
+
+      std::size_t max_entries() const { return m_max_entries; }
+      std::size_t max_bytes() const { return m_max_bytes; }
+
+      /**
+       * A fast, non-cryptographic, 64-bit hash of @c bytes bytes at @c data
+       */
+      static uint64_t hash(const void* data, std::size_t bytes, uint64_t seed=0);
+
+    private: //representation
+
+      struct Entry {
+        uint64_t hash;
+        Method method;
+        std::vector<std::size_t> shape;
+        std::vector<double> input;
+        boost::shared_array<double> result;
+      };
+
+      typedef std::list<Entry> list_type;
+
+      void erase(list_type::iterator it); ///< with the lock held
+
+      std::size_t m_max_entries;
+      std::size_t m_max_bytes;
+      list_type m_entries; ///< most recently used first
+      std::unordered_map<uint64_t, list_type::iterator> m_index;
+      ResultCacheStatistics m_statistics;
+      mutable std::mutex m_mutex;
+
+  };
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_RESULTCACHE_H */
@@ -0,0 +1,91 @@
+/**
+ * @date Wed 14 Oct 2026 11:20:05 CEST
+ *
+ * @brief Statistics of activated values, computed in the forward pass
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_STATISTICS_H
+#define BOB_LEARN_ACTIVATION_STATISTICS_H
+
+#include <vector>
+#include <stdint.h>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Accumulates the count, mean, variance, minimum, maximum, fraction of
+   * saturated values and a fixed-bin histogram of activated values.
+   *
+   * Values are accumulated in blocks, whose partial results are merged with
+   * the running ones (Chan et al.), which keeps the variance numerically
+   * stable. Accumulators filled by different threads can be merged the same
+   * way, with merge().
+   */
+  class Statistics {
+
+    public: //api
+
+      /**
+       * Builds a new accumulator, with @c bins histogram bins evenly
+       * covering [@c lower, @c upper). Values outside that range are counted
+       * in the first or last bin.
+       */
+      Statistics(std::size_t bins=100, double lower=-1., double upper=1.);
+
+      /**
+       * Forgets all values accumulated so far
+       */
+      void reset();
+
+      /**
+       * Accumulates @c n values read from @c a every @c as elements. Values
+       * below @c sat_lower or above @c sat_upper are counted as saturated.
+       */
+      void accumulate(const double* a, std::ptrdiff_t as, std::size_t n,
+          double sat_lower, double sat_upper);
+
+      /**
+       * Merges values accumulated by @c other into this accumulator. Both
+       * must have the same histogram configuration.
+       */
+      void merge(const Statistics& other);
+
+      std::size_t count() const { return m_count; }
+      double mean() const { return m_mean; }
+      double variance() const { return m_count ? m_m2 / m_count : 0.; }
+      double min() const { return m_min; }
+      double max() const { return m_max; }
+      std::size_t saturated() const { return m_saturated; }
+      const std::vector<uint64_t>& histogram() const { return m_histogram; }
+      double lower() const { return m_lower; }
+      double upper() const { return m_upper; }
+
+    private: //representation
+
+      std::size_t m_count; ///< number of values
+      double m_mean; ///< running mean
+      double m_m2; ///< sum of squared deviations from the mean
+      double m_min; ///< smallest value
+      double m_max; ///< largest value
+      std::size_t m_saturated; ///< number of saturated values
+      double m_lower; ///< lower bound of the histogram
+      double m_upper; ///< upper bound of the histogram
+      std::vector<uint64_t> m_histogram; ///< bin counts
+
+  };
+
+  /**
+   * Computes @c activation.f() like Activation::f_batch(), accumulating
+   * statistics of the activated values into @c stats in the same pass: the
+   * run is processed in blocks that are accumulated while still in cache.
+   */
+  void f_batch_with_statistics(const Activation& activation,
+      const double* z, std::ptrdiff_t zs, double* a, std::ptrdiff_t as,
+      std::size_t n, Statistics& stats);
+
+} } }
+
+#endif /* BOB_LEARN_ACTIVATION_STATISTICS_H */
@@ -0,0 +1,61 @@
+/**
+ * @date Mon 12 Oct 2026 10:12:44 CEST
+ *
+ * @brief Out-of-core application of activation functions
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_STREAM_H
+#define BOB_LEARN_ACTIVATION_STREAM_H
+
+#include <string>
+#include <bob.io.base/HDF5File.h>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Applies the method @c m of @c activation to the 64-bit float dataset
+   * @c in_path of @c in, writing the results to a new dataset @c out_path in
+   * @c out.
+   *
+   * Expandable (list) datasets are streamed one entry at a time, which is the
+   * chunking unit of bob::io::base::HDF5File. Entries are double buffered:
+   * while one entry is computed in a helper thread, the next one is read and
+   * the previous result is written, so that at most two input and two output
+   * entries are ever resident. Non-expandable datasets can only be read and
+   * written whole by bob::io::base::HDF5File: they are processed in a single
+   * step if they hold at most @c limit bytes, and rejected (with
+   * std::runtime_error) otherwise, rather than loaded whole.
+   *
+   * Both files are only accessed from the calling thread. The output dataset
+   * must not exist yet.
+   */
+  void stream_hdf5(const Activation& activation, Method m,
+      bob::io::base::HDF5File& in, const std::string& in_path,
+      bob::io::base::HDF5File& out, const std::string& out_path,
+      std::size_t limit=1 << 28);
+
+  /**
+   * Applies the method @c m of @c activation to @c n contiguous values at
+   * @c z, writing results to @c a, in tiles of @c tile elements (or a default
+   * of a few megabytes if @c tile is zero). Meant for inputs and outputs
+   * backed by memory-mapped files.
+   *
+   * While one tile is computed, the kernel is advised (@c MADV_WILLNEED) to
+   * read ahead the next tile of both arrays. If @c release_input (resp.
+   * @c release_output) is set, pages of finished tiles are dropped from the
+   * process (@c MADV_DONTNEED), keeping the resident set bounded.
+   *
+   * @warning Only release memory that is backed by a shared file mapping or
+   * by a private mapping that was never written to. Released pages of
+   * anonymous memory (e.g. heap arrays) read back as zeros.
+   */
+  void stream_mapped(const Activation& activation, Method m,
+      const double* z, double* a, std::size_t n, std::size_t tile,
+      bool release_input, bool release_output);
+
+} } }
+
+#endif /* BOB_LEARN_ACTIVATION_STREAM_H */
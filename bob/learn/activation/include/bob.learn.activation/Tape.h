@@ -0,0 +1,140 @@
+/**
+ * @date Sun 18 Oct 2026 21:15:32 CEST
+ *
+ * @brief A tape of forward activations, kept in a reusable arena
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_TAPE_H
+#define BOB_LEARN_ACTIVATION_TAPE_H
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+#include <bob.learn.activation/Activation.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Records the outputs of the activation functions of a sequence of layers,
+   * during the forward pass of an iteration, so that the backward pass can
+   * multiply gradients by their derivatives (see Activation::f_prime_from_f).
+   *
+   * Outputs are placed one after the other in an arena. During the first
+   * iteration, the arena grows by blocks, which never move. When the tape is
+   * rewound for the next iteration, blocks are merged into a single one that
+   * fits all the outputs of the previous iteration, so that later iterations
+   * of the same size allocate nothing. Blocks are shared, so that views of
+   * outputs may outlive the tape or a merge.
+   */
+  class Tape {
+
+    public: //api
+
+      /**
+       * Creates a tape whose arena holds @c capacity values at first
+       */
+      Tape(std::size_t capacity=0);
+
+      /**
+       * Reserves room for the @c n outputs of @c activation and returns it,
+       * recording it as the next layer
+       */
+      double* push(const boost::shared_ptr<Activation>& activation, std::size_t n);
+
+      /**
+       * Forgets the last layer recorded, e.g. if computing it failed
+       */
+      void pop();
+
+      /**
+       * Forgets all layers, for a new iteration, merging blocks if the arena
+       * grew
+       */
+      void rewind();
+
+      /**
+       * Multiplies the @c n gradients @c delta of the outputs of layer @c k
+       * by the derivative of its activation function, writing the results to
+       * @c res, which may be @c delta. Throws std::out_of_range if there is
+       * no such layer and std::length_error if the sizes differ.
+       */
+      void backward(std::size_t k, const double* delta, double* res, std::size_t n) const;
+
+      /**
+       * Multiplies the @c n gradients @c delta of the outputs @c f of
+       * @c activation by its derivative at them, writing the results to
+       * @c res, which may be @c delta. Touches no tape, so that callers may
+       * run it on copies of activation(), block() and data() while the tape
+       * changes.
+       */
+      static void backward(const Activation& activation, const double* f,
+          const double* delta, double* res, std::size_t n);
+
+      /**
+       * Number of layers recorded in this iteration
+       */
+      std::size_t size() const { return m_records.size(); }
+
+      /**
+       * The activation function of layer @c k
+       */
+      const boost::shared_ptr<Activation>& activation(std::size_t k) const { return m_records.at(k).activation; }
+
+      /**
+       * The outputs of layer @c k
+       */
+      double* data(std::size_t k) const { return m_records.at(k).data; }
+
+      /**
+       * The number of outputs of layer @c k
+       */
+      std::size_t length(std::size_t k) const { return m_records.at(k).n; }
+
+      /**
+       * The block of the arena holding the outputs of layer @c k
+       */
+      const boost::shared_array<double>& block(std::size_t k) const { return m_blocks[m_records.at(k).block].data; }
+
+      /**
+       * Number of values the arena holds
+       */
+      std::size_t capacity() const;
+
+      /**
+       * Number of values recorded in this iteration
+       */
+      std::size_t used() const;
+
+      /**
+       * Number of blocks allocated since the tape was created
+       */
+      std::size_t allocations() const { return m_allocations; }
+
+    private: //representation
+
+      struct Block {
+        boost::shared_array<double> data;
+        std::size_t size;
+        std::size_t used;
+      };
+
+      struct Record {
+        boost::shared_ptr<Activation> activation;
+        std::size_t block;
+        double* data;
+        std::size_t n;
+      };
+
+      void allocate(std::size_t size);
+
+      std::vector<Block> m_blocks;
+      std::vector<Record> m_records;
+      std::size_t m_allocations;
+
+  };
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_TAPE_H */
@@ -0,0 +1,149 @@
+/**
+ * @date Sun 18 Oct 2026 16:02:13 CEST
+ *
+ * @brief Tracing of activation kernels, exported in the Chrome trace format
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_TRACE_H
+#define BOB_LEARN_ACTIVATION_TRACE_H
+
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include <bob.learn.activation/Activation.h>
+
+/**
+ * Set to 0 to compile tracing out of the evaluation paths
+ */
+#ifndef BOB_LEARN_ACTIVATION_WITH_TRACING
+#define BOB_LEARN_ACTIVATION_WITH_TRACING 1
+#endif
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * Number of events kept per thread: older ones are overwritten
+   */
+  static const std::size_t TRACE_CAPACITY = 8192;
+
+  static const std::size_t TRACE_NAME_LENGTH = 64;
+  static const std::size_t TRACE_MAX_DIMENSIONS = 4;
+
+  /**
+   * An array-level evaluation, from begin to end
+   */
+  struct TraceEvent {
+    char activation[TRACE_NAME_LENGTH]; ///< unique identifier, truncated
+    Method method;
+    const char* variant; ///< the kernel variant, a static string
+    const char* dtype; ///< a static string
+    std::size_t ndim;
+    int64_t shape[TRACE_MAX_DIMENSIONS];
+    uint64_t thread; ///< system thread identifier
+    uint64_t begin; ///< nanoseconds, see trace_clock()
+    uint64_t end; ///< nanoseconds, see trace_clock()
+  };
+
+  namespace detail {
+    extern std::atomic<bool> tracing;
+    void record_trace(const TraceEvent& event);
+  }
+
+  /**
+   * Turns tracing on or off, returning the previous setting. Off by default.
+   */
+  bool set_tracing(bool enabled);
+
+  /**
+   * Tells if evaluations are currently traced
+   */
+  inline bool tracing() { return detail::tracing.load(std::memory_order_relaxed); }
+
+  /**
+   * The clock of trace events, in nanoseconds. On POSIX systems, it is the
+   * monotonic clock (e.g. Python's time.monotonic()).
+   */
+  uint64_t trace_clock();
+
+  /**
+   * Writes the events recorded by all threads since the last clear_trace()
+   * (at most TRACE_CAPACITY per thread) as a Chrome trace JSON document,
+   * readable by Perfetto or chrome://tracing. Returns the number of events
+   * written. May be called while tracing: events being overwritten are
+   * skipped.
+   */
+  std::size_t dump_trace(std::ostream& os);
+
+  /**
+   * Discards the events recorded so far
+   */
+  void clear_trace();
+
+  /**
+   * Records an evaluation, from construction to destruction, if tracing is
+   * on. Costs a test of a flag if tracing is off and nothing if compiled out.
+   */
+  class TraceSpan {
+
+    public: //api
+
+#if BOB_LEARN_ACTIVATION_WITH_TRACING
+
+      template <typename T>
+      TraceSpan(const Activation& activation, Method m, const char* variant,
+          std::size_t ndim, const T* shape, const char* dtype="float64"):
+        m_on(tracing())
+      {
+        if (!m_on) return;
+        std::string id = activation.unique_identifier();
+        std::size_t length = std::min(id.size(), TRACE_NAME_LENGTH-1);
+        id.copy(m_event.activation, length);
+        m_event.activation[length] = 0;
+        m_event.method = m;
+        m_event.variant = variant;
+        m_event.dtype = dtype;
+        m_event.ndim = std::min(ndim, TRACE_MAX_DIMENSIONS);
+        for (std::size_t k=0; k<m_event.ndim; ++k) m_event.shape[k] = shape[k];
+        m_event.begin = trace_clock();
+      }
+
+      ~TraceSpan() {
+        if (!m_on) return;
+        m_event.end = trace_clock();
+        detail::record_trace(m_event);
+      }
+
+      /**
+       * Records nothing - see CallTimer::dismiss()
+       */
+      void dismiss() { m_on = false; }
+
+    private: //representation
+
+      bool m_on;
+      TraceEvent m_event;
+
+#else
+
+      template <typename T>
+      TraceSpan(const Activation&, Method, const char*, std::size_t,
+          const T*, const char* =0) {}
+
+      void dismiss() {}
+
+#endif
+
+    private: //not implemented
+
+      TraceSpan(const TraceSpan&);
+      TraceSpan& operator= (const TraceSpan&);
+
+  };
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_TRACE_H */
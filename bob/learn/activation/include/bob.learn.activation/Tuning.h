@@ -0,0 +1,83 @@
+/**
+ * @date Sun 18 Oct 2026 18:40:05 CEST
+ *
+ * @brief Tuned parallel evaluation of large arrays
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_ACTIVATION_TUNING_H
+#define BOB_LEARN_ACTIVATION_TUNING_H
+
+#include <map>
+#include <atomic>
+#include <string>
+#include <bob.learn.activation/Activation.h>
+#include <bob.learn.activation/Statistics.h>
+
+namespace bob { namespace learn { namespace activation {
+
+  /**
+   * How contiguous arrays are evaluated by an activation function
+   */
+  struct Tuning {
+    std::size_t threads; ///< evaluating arrays, 1 to evaluate them serially
+    std::size_t threshold; ///< minimum number of elements evaluated in parallel
+    std::size_t chunk; ///< number of elements threads take at once
+  };
+
+  /**
+   * The tuning of functions without one: serial evaluation
+   */
+  Tuning default_tuning();
+
+  /**
+   * Returns the tuning of the functions with the given unique identifier
+   * (see Activation::unique_identifier()), or default_tuning()
+   */
+  Tuning get_tuning(const std::string& unique_identifier);
+
+  /**
+   * Sets the tuning of the functions with the given unique identifier. Throws
+   * std::invalid_argument if the number of threads or the chunk size is zero.
+   */
+  void set_tuning(const std::string& unique_identifier, const Tuning& tuning);
+
+  /**
+   * Forgets the tuning of the functions with the given unique identifier, or
+   * of all functions, if it is empty
+   */
+  void reset_tuning(const std::string& unique_identifier="");
+
+  /**
+   * All tunings set, by unique identifier
+   */
+  std::map<std::string, Tuning> tunings();
+
+  namespace detail { extern std::atomic<std::size_t> parallel_threshold; }
+
+  /**
+   * Tells if arrays of @c n elements may be evaluated in parallel by some
+   * function, i.e., if it is worth looking up their tuning
+   */
+  inline bool may_parallelize(std::size_t n) {
+    return n >= detail::parallel_threshold.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Applies the method @c m of @c activation to the @c n contiguous values
+   * of @c z, writing the results to @c a, in chunks of @c tuning.chunk
+   * elements handed out to the calling thread and @c tuning.threads - 1
+   * helper threads. Exceptions are rethrown after all threads are done.
+   *
+   * If @c stats is set, @c m must be F: each thread accumulates the values
+   * it computes into its own Statistics, merged into @c stats once all
+   * threads are done.
+   */
+  void parallel_batch(const Activation& activation, Method m,
+      const double* z, double* a, std::size_t n, const Tuning& tuning,
+      Statistics* stats=0);
+
+}}}
+
+#endif /* BOB_LEARN_ACTIVATION_TUNING_H */
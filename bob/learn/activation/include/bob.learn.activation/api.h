@@ -11,6 +11,10 @@
 #include <Python.h>
 #include <bob.learn.activation/config.h>
 #include <bob.learn.activation/Activation.h>
+#include <bob.learn.activation/Statistics.h>
+#include <bob.learn.activation/FormulaActivation.h>
+#include <bob.learn.activation/Counters.h>
+#include <bob.learn.activation/Tape.h>
 
 #define BOB_LEARN_ACTIVATION_MODULE_PREFIX bob.learn.activation
 #define BOB_LEARN_ACTIVATION_MODULE_NAME _library
@@ -169,6 +173,60 @@ typedef struct {
 
   extern PyBobLearnMultipliedHyperbolicTangentActivation_Type_TYPE PyBobLearnMultipliedHyperbolicTangentActivation_Type;
 
+  /*************************************************
+   * Bindings for bob.learn.activation.Statistics *
+   *************************************************/
+
+  typedef struct {
+    PyObject_HEAD
+    boost::shared_ptr<bob::learn::activation::Statistics> cxx;
+  } PyBobLearnActivationStatisticsObject;
+
+  extern PyTypeObject PyBobLearnActivationStatistics_Type;
+
+  /*********************************************
+   * Bindings for bob.learn.activation.Custom *
+   *********************************************/
+
+  extern PyTypeObject PyBobLearnCustomActivation_Type;
+
+  /**********************************************
+   * Bindings for bob.learn.activation.Formula *
+   **********************************************/
+
+  typedef struct {
+    PyBobLearnActivationObject parent;
+    boost::shared_ptr<bob::learn::activation::FormulaActivation> cxx;
+  } PyBobLearnFormulaActivationObject;
+
+  extern PyTypeObject PyBobLearnFormulaActivation_Type;
+
+  /*******************************************
+   * Bindings for bob.learn.activation.Tape *
+   *******************************************/
+
+  typedef struct {
+    PyObject_HEAD
+    boost::shared_ptr<bob::learn::activation::Tape> cxx;
+    PyObject* views; ///< list of the views of the outputs of each layer
+  } PyBobLearnActivationTapeObject;
+
+  extern PyTypeObject PyBobLearnActivationTape_Type;
+
+  /**
+   * Applies a method of an activation to an input numpy array, writing to an
+   * output numpy array of the same shape, both of 64-bit floats, as
+   * Activation.f() and friends do. Returns 0 with an exception set on errors.
+   */
+  int PyBobLearnActivation_Apply(PyBobLearnActivationObject* self,
+      bob::learn::activation::Method method, PyObject* z, PyObject* res);
+
+  /**************************************************
+   * Counters of evaluations, see Activation.stats() *
+   **************************************************/
+
+  PyObject* PyBobLearnActivation_BuildCounters(const bob::learn::activation::Counters& counters);
+
 #else
 
   /* This section is used in modules that use `bob.learn.activation's' C-API */
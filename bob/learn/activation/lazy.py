@@ -0,0 +1,156 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Mon 19 Oct 2026 11:27:51 CEST
+
+"""Activated arrays computed on demand"""
+
+from __future__ import division
+
+import numpy
+
+
+class LazyActivation(object):
+  """LazyActivation(activation, z, [method='f', [block=65536]])
+
+  An array of the values of ``method`` of ``activation`` (e.g.
+  ``activation.f``) at ``z``, computed only where it is read
+
+  Reading the object by indexing or slicing, like a
+  :py:class:`numpy.ndarray`, or converting it with
+  :py:func:`numpy.asarray`, computes the values read, by blocks of
+  consecutive rows (along the first dimension) of about ``block``
+  elements. Blocks are computed once and kept, so that reading the top
+  scores or a few slices of a large matrix only computes and stores the
+  blocks holding them.
+
+  ``z`` is referenced, not copied: it should not be changed while this
+  object is used. It must be an array of 64-bit floats, with 1 to 4
+  dimensions.
+
+  Example:
+
+  .. code-block:: python
+
+     scores = LazyActivation(bob.learn.activation.Logistic(), z)
+     top = numpy.argpartition(z, -10, axis=None)[-10:] # logistic is monotonic
+     best = scores[numpy.unravel_index(top, z.shape)]
+  """
+
+  def __init__(self, activation, z, method='f', block=1 << 16):
+
+    z = numpy.asarray(z)
+    if z.dtype != numpy.float64:
+      raise TypeError("`%s' only supports 64-bit float arrays for input array `z', not `%s'" % (type(self).__name__, z.dtype))
+    if z.ndim < 1 or z.ndim > 4:
+      raise TypeError("`%s' only accepts 1, 2, 3 or 4-dimensional arrays (not %dD arrays)" % (type(self).__name__, z.ndim))
+    if block <= 0:
+      raise ValueError("`%s' block size must be positive, not %d" % (type(self).__name__, block))
+
+    self._activation = activation
+    self._call = getattr(activation, method)
+    self._method = method
+    self._z = z
+    row = int(numpy.prod(z.shape[1:]))
+    self._rows = max(1, block // max(row, 1))
+    self._blocks = {}
+
+  @property
+  def activation(self):
+    """The activation function (read-only)"""
+    return self._activation
+
+  @property
+  def method(self):
+    """The name of the method of the activation function (read-only)"""
+    return self._method
+
+  @property
+  def shape(self):
+    """The shape of the array, that of the input (read-only)"""
+    return self._z.shape
+
+  @property
+  def dtype(self):
+    """The type of the values, 64-bit floats (read-only)"""
+    return self._z.dtype
+
+  @property
+  def ndim(self):
+    """The number of dimensions (read-only)"""
+    return self._z.ndim
+
+  @property
+  def size(self):
+    """The number of values (read-only)"""
+    return self._z.size
+
+  @property
+  def computed(self):
+    """The fraction of the values computed so far (read-only)"""
+    if not len(self._z): return 1.
+    rows = sum(len(b) for b in self._blocks.values())
+    return rows / len(self._z)
+
+  def __len__(self):
+    return len(self._z)
+
+  def __repr__(self):
+    return "<%s of %s.%s, shape %s, %.0f%% computed>" % (type(self).__name__,
+        type(self._activation).__name__, self._method, self.shape,
+        100 * self.computed)
+
+  def _block(self, k):
+    """Returns the activated rows of block ``k``, computing them if needed"""
+
+    retval = self._blocks.get(k)
+    if retval is None:
+      start = k * self._rows
+      retval = self._call(self._z[start:start + self._rows])
+      self._blocks[k] = retval
+    return retval
+
+  def _gather(self, rows):
+    """Returns the activated rows with the given sorted, unique indices"""
+
+    retval = numpy.empty((len(rows),) + self._z.shape[1:])
+    blocks = rows // self._rows
+    for k in numpy.unique(blocks):
+      selected = blocks == k
+      retval[selected] = self._block(k)[rows[selected] - k * self._rows]
+    return retval
+
+  def __array__(self, dtype=None, copy=None):
+    retval = self._gather(numpy.arange(len(self._z)))
+    return retval if dtype is None else retval.astype(dtype)
+
+  def __getitem__(self, key):
+
+    if not isinstance(key, tuple): key = (key,)
+    first, rest = (key[0], key[1:]) if key else (slice(None), ())
+
+    if first is Ellipsis or first is None: # indices may shift: computes all
+      return numpy.asarray(self)[key]
+
+    mask = numpy.asarray(first) if isinstance(first, (list, numpy.ndarray)) else None
+    if mask is not None and mask.dtype == bool and mask.ndim > 1:
+      # a mask over several axes: the rows it selects, then the mask on them
+      if mask.shape != self._z.shape[:mask.ndim]:
+        raise IndexError("boolean index of shape %s does not match array of shape %s" % (mask.shape, self.shape))
+      rows = numpy.unique(numpy.nonzero(mask)[0])
+      return self._gather(rows)[(mask[rows],) + rest]
+
+    # the rows read, as numpy selects them
+    selected = numpy.arange(len(self._z))[first]
+    rows = numpy.unique(selected)
+    values = self._gather(rows)
+
+    # the same selection, from the rows gathered
+    if isinstance(first, slice):
+      step = first.step or 1
+      first = slice(None) if step > 0 else slice(None, None, -1)
+    elif numpy.ndim(selected) == 0:
+      first = int(numpy.searchsorted(rows, selected))
+    else:
+      first = numpy.searchsorted(rows, selected)
+
+    return values[(first,) + rest]
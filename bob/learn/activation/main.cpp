@@ -15,8 +15,1145 @@
 #include <bob.blitz/cleanup.h>
 #include <bob.core/api.h>
 #include <bob.io.base/api.h>
+#include <bob.learn.activation/Compact.h>
+#include <bob.learn.activation/Trace.h>
+#include <bob.learn.activation/Tuning.h>
+#include <bob.learn.activation/BufferPool.h>
+#include <fstream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+PyDoc_STRVAR(s_set_interning_str, "set_interning");
+PyDoc_STRVAR(s_set_interning_doc,
+"set_interning(enabled) -> bool\n\
+\n\
+Turns interning of loaded activation functions on or off, returning\n\
+the previous setting. While on, :py:func:`load_activation` (and\n\
+C++ code loading activations from files) returns a single shared\n\
+instance for all activations with the same type and parameters.\n\
+Shared instances must not be modified with\n\
+:py:meth:`Activation.load`. Interning is off by default.\n\
+\n\
+");
+
+static PyObject* set_interning(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"enabled", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* enabled = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &enabled)) return 0;
+
+  int value = PyObject_IsTrue(enabled);
+  if (value < 0) return 0;
+
+  if (bob::learn::activation::set_interning(value)) Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+
+}
+
+PyDoc_STRVAR(s_intern_str, "intern");
+PyDoc_STRVAR(s_intern_doc,
+"intern(activation) -> Activation\n\
+\n\
+Returns an activation function sharing the C++ instance of all\n\
+interned activations with the same type and parameters as\n\
+``activation``, which becomes that instance if there is none yet.\n\
+\n\
+");
+
+static PyObject* intern(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"activation", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBobLearnActivationObject* activation = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+        &PyBobLearnActivation_Type, &activation)) return 0;
+
+  if (!activation->cxx) {
+    PyErr_Format(PyExc_TypeError, "cannot intern an uninitialized `%s'", Py_TYPE(activation)->tp_name);
+    return 0;
+  }
+
+  return PyBobLearnActivation_NewFromActivation(bob::learn::activation::intern_activation(activation->cxx));
+
+}
+
+PyDoc_STRVAR(s_load_activation_str, "load_activation");
+PyDoc_STRVAR(s_load_activation_doc,
+"load_activation(f) -> Activation\n\
+\n\
+Loads an activation function of any registered type from the\n\
+current group of the :py:class:`bob.io.base.HDF5File` ``f``.\n\
+\n\
+");
+
+static PyObject* load_activation(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"f", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBobIoHDF5FileObject* f = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
+        &PyBobIoHDF5File_Converter, &f)) return 0;
+
+  auto f_ = make_safe(f);
+
+  try {
+    return PyBobLearnActivation_NewFromActivation(bob::learn::activation::load_activation(*f->f));
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot load activation from file `%s' (at group `%s'): unknown exception caught", f->f->filename().c_str(), f->f->cwd().c_str());
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_interning_statistics_str, "interning_statistics");
+PyDoc_STRVAR(s_interning_statistics_doc,
+"interning_statistics() -> dict\n\
+\n\
+Returns the counters of activation interning: ``requests``, the\n\
+number of activations looked up, ``deduplicated``, how many of\n\
+those returned an existing instance instead of a new one, and\n\
+``live``, the number of shared instances still in use.\n\
+\n\
+");
+
+static PyObject* interning_statistics(PyObject*) {
+
+  bob::learn::activation::InterningStatistics stats = bob::learn::activation::interning_statistics();
+
+  return Py_BuildValue("{s:n,s:n,s:n}",
+      "requests", (Py_ssize_t)stats.requests,
+      "deduplicated", (Py_ssize_t)stats.deduplicated,
+      "live", (Py_ssize_t)stats.live);
+
+}
+
+PyDoc_STRVAR(s_reset_interning_statistics_str, "reset_interning_statistics");
+PyDoc_STRVAR(s_reset_interning_statistics_doc,
+"reset_interning_statistics() -> None\n\
+\n\
+Resets the ``requests`` and ``deduplicated`` counters of\n\
+:py:func:`interning_statistics` to zero.\n\
+\n\
+");
+
+static PyObject* reset_interning_statistics(PyObject*) {
+
+  bob::learn::activation::reset_interning_statistics();
+  Py_RETURN_NONE;
+
+}
+
+/**
+ * Converts o, an Activation or an iterable over activations, into a vector
+ */
+static int convert_activations(PyObject* o,
+    std::vector<boost::shared_ptr<bob::learn::activation::Activation> >& activations) {
+
+  if (PyBobLearnActivation_Check(o)) {
+    activations.push_back(reinterpret_cast<PyBobLearnActivationObject*>(o)->cxx);
+  }
+
+  else {
+
+    PyObject* iterator = PyObject_GetIter(o);
+    if (!iterator) return 0;
+    auto iterator_ = make_safe(iterator);
+
+    while (PyObject* item = PyIter_Next(iterator)) {
+      auto item_ = make_safe(item);
+      if (!PyBobLearnActivation_Check(item)) {
+        PyErr_Format(PyExc_TypeError, "expected an activation function, but got an object of type `%s'", Py_TYPE(item)->tp_name);
+        return 0;
+      }
+      activations.push_back(reinterpret_cast<PyBobLearnActivationObject*>(item)->cxx);
+    }
+
+    if (PyErr_Occurred()) return 0;
+
+  }
+
+  for (auto it = activations.begin(); it != activations.end(); ++it) {
+    if (!*it) {
+      PyErr_SetString(PyExc_TypeError, "cannot serialize an uninitialized activation function");
+      return 0;
+    }
+  }
+
+  return 1;
+
+}
+
+/**
+ * Returns a new list with Python objects wrapping the activations
+ */
+static PyObject* new_activation_list(const std::vector<boost::shared_ptr<bob::learn::activation::Activation> >& activations) {
+
+  PyObject* retval = PyList_New(activations.size());
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  for (std::size_t k=0; k<activations.size(); ++k) {
+    PyObject* item = PyBobLearnActivation_NewFromActivation(activations[k]);
+    if (!item) return 0;
+    PyList_SET_ITEM(retval, k, item);
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyDoc_STRVAR(s_dumps_str, "dumps");
+PyDoc_STRVAR(s_dumps_doc,
+"dumps(activations) -> bytes\n\
+\n\
+Serializes an activation function, or an iterable over activation\n\
+functions, into a compact byte string: a table of the types used\n\
+followed by one fixed-size record (type and parameters) per\n\
+activation. Use :py:func:`loads` to read them back.\n\
+\n\
+The data is written in the byte order of this machine.\n\
+\n\
+");
+
+static PyObject* dumps(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"activations", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &o)) return 0;
+
+  std::vector<boost::shared_ptr<bob::learn::activation::Activation> > activations;
+  if (!convert_activations(o, activations)) return 0;
+
+  try {
+    std::string data = bob::learn::activation::save_compact(activations);
+    return PyBytes_FromStringAndSize(data.data(), data.size());
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_SetString(PyExc_RuntimeError, "cannot serialize activation functions: unknown exception caught");
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_loads_str, "loads");
+PyDoc_STRVAR(s_loads_doc,
+"loads(data) -> [Activation]\n\
+\n\
+Creates the list of activation functions serialized in ``data``,\n\
+a byte string (or any object exporting the buffer protocol) as\n\
+returned by :py:func:`dumps`.\n\
+\n\
+");
+
+static PyObject* loads(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"data", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &o)) return 0;
+
+  Py_buffer view;
+  if (PyObject_GetBuffer(o, &view, PyBUF_SIMPLE) < 0) return 0;
+
+  std::vector<boost::shared_ptr<bob::learn::activation::Activation> > activations;
+  std::string error;
+
+  try {
+    activations = bob::learn::activation::load_compact(view.buf, view.len);
+  }
+  catch (std::exception& e) {
+    error = e.what();
+  }
+  catch (...) {
+    error = "cannot load activation functions: unknown exception caught";
+  }
+
+  PyBuffer_Release(&view);
+
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return 0;
+  }
+
+  return new_activation_list(activations);
+
+}
+
+PyDoc_STRVAR(s_save_bundle_str, "save_bundle");
+PyDoc_STRVAR(s_save_bundle_doc,
+"save_bundle(filename, activations) -> None\n\
+\n\
+Writes activation functions to ``filename`` in the compact form of\n\
+:py:func:`dumps`. Bundles are memory-mapped when loaded with\n\
+:py:func:`load_bundle`, and are much faster to load than one HDF5\n\
+group per activation.\n\
+\n\
+");
+
+static PyObject* save_bundle(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"filename", "activations", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* filename = 0;
+  PyObject* o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO", kwlist, &filename, &o)) return 0;
+
+  std::vector<boost::shared_ptr<bob::learn::activation::Activation> > activations;
+  if (!convert_activations(o, activations)) return 0;
+
+  try {
+    bob::learn::activation::save_bundle(filename, activations);
+    Py_RETURN_NONE;
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot save activation functions to `%s': unknown exception caught", filename);
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_load_bundle_str, "load_bundle");
+PyDoc_STRVAR(s_load_bundle_doc,
+"load_bundle(filename) -> [Activation]\n\
+\n\
+Creates the list of activation functions in the bundle\n\
+``filename``, written by :py:func:`save_bundle`.\n\
+\n\
+");
+
+static PyObject* load_bundle(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"filename", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* filename = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &filename)) return 0;
+
+  try {
+    return new_activation_list(bob::learn::activation::load_bundle(filename));
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot load activation functions from `%s': unknown exception caught", filename);
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_unpickle_str, "_unpickle");
+PyDoc_STRVAR(s_unpickle_doc,
+"_unpickle(state) -> Activation\n\
+\n\
+Creates the activation function saved in ``state`` by\n\
+:py:meth:`Activation.__getstate__` (used for unpickling).\n\
+\n\
+");
+
+static PyObject* unpickle(PyObject*, PyObject* args, PyObject* kwds) {
+
+  PyObject* activations = loads(0, args, kwds);
+  if (!activations) return 0;
+  auto activations_ = make_safe(activations);
+
+  if (PyList_GET_SIZE(activations) != 1) {
+    PyErr_Format(PyExc_RuntimeError, "the state of an activation function must hold exactly one activation, not %" PY_FORMAT_SIZE_T "d", PyList_GET_SIZE(activations));
+    return 0;
+  }
+
+  PyObject* retval = PyList_GET_ITEM(activations, 0);
+  Py_INCREF(retval);
+  return retval;
+
+}
+
+PyDoc_STRVAR(s_add_plugin_directory_str, "add_plugin_directory");
+PyDoc_STRVAR(s_add_plugin_directory_doc,
+"add_plugin_directory(directory) -> None\n\
+\n\
+Adds a directory of activation plugin manifests. Manifests are\n\
+files named ``*.manifest``, with one ``<identifier> <library>``\n\
+pair per line, where ``library`` is a shared library (relative to\n\
+the manifest) that registers the activation function ``identifier``\n\
+when loaded. Libraries are only loaded when one of their\n\
+activation functions is first loaded (e.g. by\n\
+:py:func:`load_activation`) without being registered. Directories\n\
+may also be listed, separated by colons, in the environment\n\
+variable ``BOB_LEARN_ACTIVATION_PLUGIN_PATH``.\n\
+\n\
+");
+
+static PyObject* add_plugin_directory(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"directory", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* directory = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &directory)) return 0;
+
+  bob::learn::activation::ActivationRegistry::instance()->addPluginDirectory(directory);
+
+  Py_RETURN_NONE;
+
+}
+
+PyDoc_STRVAR(s_plugins_str, "plugins");
+PyDoc_STRVAR(s_plugins_doc,
+"plugins() -> dict\n\
+\n\
+Returns the libraries of all activation plugins listed in the\n\
+manifests of the plugin directories, by identifier. No library is\n\
+loaded.\n\
+\n\
+");
+
+static PyObject* plugins(PyObject*) {
+
+  std::map<std::string, std::string> plugins;
+  try {
+    plugins = bob::learn::activation::ActivationRegistry::instance()->getPlugins();
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+    return 0;
+  }
+
+  PyObject* retval = PyDict_New();
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  for (auto it = plugins.begin(); it != plugins.end(); ++it) {
+    PyObject* library = Py_BuildValue("s", it->second.c_str());
+    if (!library) return 0;
+    auto library_ = make_safe(library);
+    if (PyDict_SetItemString(retval, it->first.c_str(), library) < 0) return 0;
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyDoc_STRVAR(s_clone_activations_str, "clone_activations");
+PyDoc_STRVAR(s_clone_activations_doc,
+"clone_activations(activations) -> list\n\
+\n\
+Returns a list with independent copies of the activation functions\n\
+in the iterable ``activations``. Functions that appear more than\n\
+once are copied once, and their copies appear at the same places.\n\
+Copies never share C++ state with the originals, so threads that\n\
+evaluate activations concurrently (e.g. in C++ code wrapped by other\n\
+modules) may each work on their own copies.\n\
+\n\
+");
+
+static PyObject* clone_activations(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"activations", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &o)) return 0;
+
+  std::vector<boost::shared_ptr<bob::learn::activation::Activation> > activations;
+  if (!convert_activations(o, activations)) return 0;
+
+  try {
+    return new_activation_list(bob::learn::activation::clone_activations(activations));
+  }
+  catch (std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+  catch (...) {
+    PyErr_SetString(PyExc_RuntimeError, "cannot clone activations: unknown exception caught");
+  }
+
+  return 0;
+
+}
+
+PyDoc_STRVAR(s_evaluate_in_threads_str, "_evaluate_in_threads");
+PyDoc_STRVAR(s_evaluate_in_threads_doc,
+"_evaluate_in_threads(activation, threads, size, iterations, clone) -> float\n\
+\n\
+Benchmarking helper: evaluates ``activation`` on ``size`` values,\n\
+``iterations`` times, from each of ``threads`` threads, the way a\n\
+thread-per-core engine would (taking a reference to the function for\n\
+each evaluation). If ``clone`` is set, each thread first makes its own\n\
+copy. Returns the elapsed time, in seconds.\n\
+\n\
+");
+
+static PyObject* evaluate_in_threads(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"activation", "threads", "size", "iterations", "clone", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBobLearnActivationObject* activation = 0;
+  Py_ssize_t threads = 0;
+  Py_ssize_t size = 0;
+  Py_ssize_t iterations = 0;
+  PyObject* clone = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!nnnO", kwlist,
+        &PyBobLearnActivation_Type, &activation, &threads, &size,
+        &iterations, &clone)) return 0;
+
+  int cloned = PyObject_IsTrue(clone);
+  if (cloned < 0) return 0;
+
+  if (threads <= 0 || size <= 0 || iterations < 0) {
+    PyErr_SetString(PyExc_ValueError, "threads and size must be positive, iterations non-negative");
+    return 0;
+  }
+
+  boost::shared_ptr<bob::learn::activation::Activation> shared = activation->cxx;
+  std::string error;
+  std::mutex error_mutex;
+  double elapsed = 0.;
+
+  Py_BEGIN_ALLOW_THREADS
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (Py_ssize_t t=0; t<threads; ++t) {
+    workers.push_back(std::thread([&shared, &error, &error_mutex, cloned, size, iterations]() {
+      try {
+        boost::shared_ptr<bob::learn::activation::Activation> own =
+          cloned ? shared->clone() : shared;
+        std::vector<double> z(size, 0.5), a(size);
+        for (Py_ssize_t k=0; k<iterations; ++k) {
+          boost::shared_ptr<bob::learn::activation::Activation> layer = own;
+          layer->f_batch(&z[0], 1, &a[0], 1, size);
+        }
+      }
+      catch (std::exception& e) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        error = e.what();
+      }
+    }));
+  }
+  for (auto it = workers.begin(); it != workers.end(); ++it) it->join();
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  Py_END_ALLOW_THREADS
+
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return 0;
+  }
+
+  return Py_BuildValue("d", elapsed);
+
+}
+
+PyDoc_STRVAR(s_set_counting_str, "set_counting");
+PyDoc_STRVAR(s_set_counting_doc,
+"set_counting(enabled) -> bool\n\
+\n\
+Turns counting of evaluations on or off, returning the previous\n\
+setting. While on, each evaluation is timed and recorded in the\n\
+counters of its activation function (see :py:meth:`Activation.stats`)\n\
+and in the global ones (see :py:func:`stats`). Counting is off by\n\
+default, and costs nothing if the package was compiled with\n\
+``BOB_LEARN_ACTIVATION_WITH_COUNTERS=0``.\n\
+\n\
+");
+
+static PyObject* set_counting(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"enabled", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* enabled = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &enabled)) return 0;
+
+  int value = PyObject_IsTrue(enabled);
+  if (value < 0) return 0;
+
+  if (bob::learn::activation::set_counting(value)) Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+
+}
+
+PyDoc_STRVAR(s_stats_str, "stats");
+PyDoc_STRVAR(s_stats_doc,
+"stats() -> dict\n\
+\n\
+Returns the counters of the evaluations of all activation functions,\n\
+made while counting was on, structured like those of\n\
+:py:meth:`Activation.stats`.\n\
+\n\
+");
+
+static PyObject* stats(PyObject*) {
+  return PyBobLearnActivation_BuildCounters(bob::learn::activation::global_counters());
+}
+
+PyDoc_STRVAR(s_reset_stats_str, "reset_stats");
+PyDoc_STRVAR(s_reset_stats_doc,
+"reset_stats() -> None\n\
+\n\
+Sets the counters returned by :py:func:`stats` to zero. The counters\n\
+of each function are reset with :py:meth:`Activation.reset_stats`.\n\
+\n\
+");
+
+static PyObject* reset_stats(PyObject*) {
+  bob::learn::activation::global_counters().reset();
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(s_set_tracing_str, "set_tracing");
+PyDoc_STRVAR(s_set_tracing_doc,
+"set_tracing(enabled) -> bool\n\
+\n\
+Turns tracing of array evaluations on or off, returning the previous\n\
+setting. While on, each evaluation of an array records an event with\n\
+the unique identifier of the function, the method, the shape and type\n\
+of the array, the loop variant used (``'contiguous'``, ``'blocked'``,\n\
+``'strided'``, ``'statistics'``, ``'mapped'`` or ``'hdf5'``), the\n\
+thread and its begin and end times, in a ring buffer of the thread\n\
+that keeps its last 8192 events. Save them with :py:func:`dump_trace`.\n\
+Tracing is off by default, and costs nothing if the package was\n\
+compiled with ``BOB_LEARN_ACTIVATION_WITH_TRACING=0``.\n\
+\n\
+");
+
+static PyObject* set_tracing(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"enabled", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* enabled = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &enabled)) return 0;
+
+  int value = PyObject_IsTrue(enabled);
+  if (value < 0) return 0;
+
+  if (bob::learn::activation::set_tracing(value)) Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+
+}
+
+PyDoc_STRVAR(s_dump_trace_str, "dump_trace");
+PyDoc_STRVAR(s_dump_trace_doc,
+"dump_trace(filename) -> int\n\
+\n\
+Writes the events traced since the last :py:func:`clear_trace`, by\n\
+all threads, to ``filename``, in the Chrome trace JSON format, which\n\
+Perfetto (https://ui.perfetto.dev) and ``chrome://tracing`` display\n\
+as a timeline. Returns the number of events written. Events are\n\
+timed with :py:func:`trace_clock` and recorded against system thread\n\
+identifiers, so they may be merged with other traces using the same\n\
+clock and ``threading.get_native_id()``.\n\
+\n\
+");
+
+static PyObject* dump_trace(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"filename", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* filename = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &filename)) return 0;
+
+  std::size_t retval = 0;
+  bool ok = false;
+
+  Py_BEGIN_ALLOW_THREADS
+  std::ofstream os(filename);
+  if (os) {
+    retval = bob::learn::activation::dump_trace(os);
+    os.close();
+    ok = !os.fail();
+  }
+  Py_END_ALLOW_THREADS
+
+  if (!ok) {
+    PyErr_Format(PyExc_IOError, "cannot write trace to file `%s'", filename);
+    return 0;
+  }
+
+  return Py_BuildValue("n", (Py_ssize_t)retval);
+
+}
+
+PyDoc_STRVAR(s_clear_trace_str, "clear_trace");
+PyDoc_STRVAR(s_clear_trace_doc,
+"clear_trace() -> None\n\
+\n\
+Discards the events traced so far\n\
+\n\
+");
+
+static PyObject* clear_trace(PyObject*) {
+  bob::learn::activation::clear_trace();
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(s_trace_clock_str, "trace_clock");
+PyDoc_STRVAR(s_trace_clock_doc,
+"trace_clock() -> float\n\
+\n\
+Returns the current time of the clock of traced events, in the\n\
+microseconds of the Chrome trace format. On POSIX systems, it is the\n\
+clock of :py:func:`time.monotonic`.\n\
+\n\
+");
+
+static PyObject* trace_clock(PyObject*) {
+  return Py_BuildValue("d", bob::learn::activation::trace_clock() / 1000.);
+}
+
+static PyObject* build_tuning(const bob::learn::activation::Tuning& tuning) {
+  return Py_BuildValue("{s:n,s:n,s:n}",
+      "threads", (Py_ssize_t)tuning.threads,
+      "threshold", (Py_ssize_t)tuning.threshold,
+      "chunk", (Py_ssize_t)tuning.chunk);
+}
+
+PyDoc_STRVAR(s_get_tuning_str, "get_tuning");
+PyDoc_STRVAR(s_get_tuning_doc,
+"get_tuning(identifier) -> dict\n\
+\n\
+Returns how functions with the given unique identifier (see\n\
+:py:meth:`Activation.unique_identifier`) evaluate contiguous arrays:\n\
+with ``threads`` threads, taking ``chunk`` elements at once, if they\n\
+have at least ``threshold`` elements. Functions that were not tuned\n\
+(see :py:mod:`bob.learn.activation.tuning`) use a single thread.\n\
+\n\
+");
+
+static PyObject* get_tuning(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"identifier", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* identifier = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &identifier)) return 0;
+
+  return build_tuning(bob::learn::activation::get_tuning(identifier));
+
+}
+
+PyDoc_STRVAR(s_set_tuning_str, "set_tuning");
+PyDoc_STRVAR(s_set_tuning_doc,
+"set_tuning(identifier, threads, threshold, chunk) -> None\n\
+\n\
+Sets how functions with the given unique identifier evaluate\n\
+contiguous arrays, overriding any tuning (see :py:func:`get_tuning`).\n\
+Arrays of ``threshold`` elements or more are split in chunks of\n\
+``chunk`` elements, evaluated by ``threads`` threads, the calling one\n\
+included, without the GIL. A single thread evaluates arrays serially.\n\
+\n\
+");
+
+static PyObject* set_tuning(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"identifier", "threads", "threshold", "chunk", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* identifier = 0;
+  Py_ssize_t threads = 0;
+  Py_ssize_t threshold = 0;
+  Py_ssize_t chunk = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "snnn", kwlist,
+        &identifier, &threads, &threshold, &chunk)) return 0;
+
+  if (threads <= 0 || threshold < 0 || chunk <= 0) {
+    PyErr_Format(PyExc_ValueError, "tuning of `%s' must have positive threads and chunk and a non-negative threshold (got %" PY_FORMAT_SIZE_T "d, %" PY_FORMAT_SIZE_T "d and %" PY_FORMAT_SIZE_T "d)", identifier, threads, chunk, threshold);
+    return 0;
+  }
+
+  bob::learn::activation::Tuning tuning;
+  tuning.threads = threads;
+  tuning.threshold = threshold;
+  tuning.chunk = chunk;
+  bob::learn::activation::set_tuning(identifier, tuning);
+
+  Py_RETURN_NONE;
+
+}
+
+PyDoc_STRVAR(s_reset_tuning_str, "reset_tuning");
+PyDoc_STRVAR(s_reset_tuning_doc,
+"reset_tuning([identifier]) -> None\n\
+\n\
+Forgets the tuning of functions with the given unique identifier, or\n\
+of all functions, if none is given\n\
+\n\
+");
+
+static PyObject* reset_tuning(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"identifier", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* identifier = "";
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|s", kwlist, &identifier)) return 0;
+
+  bob::learn::activation::reset_tuning(identifier);
+  Py_RETURN_NONE;
+
+}
+
+PyDoc_STRVAR(s_tunings_str, "tunings");
+PyDoc_STRVAR(s_tunings_doc,
+"tunings() -> dict\n\
+\n\
+Returns all tunings set, as returned by :py:func:`get_tuning`, by\n\
+unique identifier\n\
+\n\
+");
+
+static PyObject* tunings(PyObject*) {
+
+  PyObject* retval = PyDict_New();
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  for (auto& k : bob::learn::activation::tunings()) {
+    PyObject* tuning = build_tuning(k.second);
+    if (!tuning) return 0;
+    auto tuning_ = make_safe(tuning);
+    if (PyDict_SetItemString(retval, k.first.c_str(), tuning) < 0) return 0;
+  }
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyDoc_STRVAR(s_set_pooling_str, "set_pooling");
+PyDoc_STRVAR(s_set_pooling_doc,
+"set_pooling(enabled) -> bool\n\
+\n\
+Turns pooling of output arrays on or off, returning the previous\n\
+setting. While on, the memory of output arrays of 64 KiB or more\n\
+that activation functions allocate is taken from a pool, to which it\n\
+returns when the arrays are deleted, so that loops over arrays of\n\
+the same sizes stop allocating memory and faulting it in. Buffers of\n\
+2 MiB or more use transparent huge pages, where available. New\n\
+buffers are first written by the threads evaluating the arrays (see\n\
+:py:func:`set_tuning`), which places their pages near those threads\n\
+on NUMA machines; recycled buffers keep their pages where they are.\n\
+Pooling is off by default.\n\
+\n\
+");
+
+static PyObject* set_pooling(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"enabled", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* enabled = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &enabled)) return 0;
+
+  int value = PyObject_IsTrue(enabled);
+  if (value < 0) return 0;
+
+  if (bob::learn::activation::set_pooling(value)) Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+
+}
+
+PyDoc_STRVAR(s_pool_statistics_str, "pool_statistics");
+PyDoc_STRVAR(s_pool_statistics_doc,
+"pool_statistics() -> dict\n\
+\n\
+Returns the counters of the pool of output arrays: ``hits``, the\n\
+number of buffers reused, ``misses``, the number allocated, ``huge``,\n\
+how many of those use huge pages, ``dropped``, the number freed as\n\
+the pool was full, and ``buffers`` and ``bytes``, the number and size\n\
+of the buffers currently pooled.\n\
+\n\
+");
+
+static PyObject* pool_statistics(PyObject*) {
+  bob::learn::activation::BufferPoolStatistics stats =
+    bob::learn::activation::buffer_pool().statistics();
+  return Py_BuildValue("{s:K,s:K,s:K,s:K,s:n,s:n}",
+      "hits", (unsigned long long)stats.hits,
+      "misses", (unsigned long long)stats.misses,
+      "huge", (unsigned long long)stats.huge,
+      "dropped", (unsigned long long)stats.dropped,
+      "buffers", (Py_ssize_t)stats.buffers,
+      "bytes", (Py_ssize_t)stats.bytes);
+}
+
+PyDoc_STRVAR(s_clear_pool_str, "clear_pool");
+PyDoc_STRVAR(s_clear_pool_doc,
+"clear_pool() -> None\n\
+\n\
+Frees the buffers currently pooled. Buffers of arrays still alive\n\
+return to the pool when the arrays are deleted.\n\
+\n\
+");
+
+static PyObject* clear_pool(PyObject*) {
+  bob::learn::activation::buffer_pool().clear();
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(s_set_pool_limit_str, "set_pool_limit");
+PyDoc_STRVAR(s_set_pool_limit_doc,
+"set_pool_limit(bytes) -> int\n\
+\n\
+Sets the maximum number of bytes kept by the pool of output arrays\n\
+(256 MiB by default), freeing buffers if needed, and returns the\n\
+previous limit\n\
+\n\
+");
+
+static PyObject* set_pool_limit(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"bytes", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t bytes = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &bytes)) return 0;
+
+  if (bytes < 0) {
+    PyErr_Format(PyExc_ValueError, "pool limit must be positive (or zero), not %" PY_FORMAT_SIZE_T "d", bytes);
+    return 0;
+  }
+
+  return Py_BuildValue("n",
+      (Py_ssize_t)bob::learn::activation::buffer_pool().set_limit(bytes));
+
+}
 
 static PyMethodDef module_methods[] = {
+    {
+      s_set_interning_str,
+      (PyCFunction)set_interning,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_interning_doc
+    },
+    {
+      s_intern_str,
+      (PyCFunction)intern,
+      METH_VARARGS|METH_KEYWORDS,
+      s_intern_doc
+    },
+    {
+      s_load_activation_str,
+      (PyCFunction)load_activation,
+      METH_VARARGS|METH_KEYWORDS,
+      s_load_activation_doc
+    },
+    {
+      s_dumps_str,
+      (PyCFunction)dumps,
+      METH_VARARGS|METH_KEYWORDS,
+      s_dumps_doc
+    },
+    {
+      s_loads_str,
+      (PyCFunction)loads,
+      METH_VARARGS|METH_KEYWORDS,
+      s_loads_doc
+    },
+    {
+      s_save_bundle_str,
+      (PyCFunction)save_bundle,
+      METH_VARARGS|METH_KEYWORDS,
+      s_save_bundle_doc
+    },
+    {
+      s_load_bundle_str,
+      (PyCFunction)load_bundle,
+      METH_VARARGS|METH_KEYWORDS,
+      s_load_bundle_doc
+    },
+    {
+      s_unpickle_str,
+      (PyCFunction)unpickle,
+      METH_VARARGS|METH_KEYWORDS,
+      s_unpickle_doc
+    },
+    {
+      s_interning_statistics_str,
+      (PyCFunction)interning_statistics,
+      METH_NOARGS,
+      s_interning_statistics_doc
+    },
+    {
+      s_reset_interning_statistics_str,
+      (PyCFunction)reset_interning_statistics,
+      METH_NOARGS,
+      s_reset_interning_statistics_doc
+    },
+    {
+      s_clone_activations_str,
+      (PyCFunction)clone_activations,
+      METH_VARARGS|METH_KEYWORDS,
+      s_clone_activations_doc
+    },
+    {
+      s_evaluate_in_threads_str,
+      (PyCFunction)evaluate_in_threads,
+      METH_VARARGS|METH_KEYWORDS,
+      s_evaluate_in_threads_doc
+    },
+    {
+      s_add_plugin_directory_str,
+      (PyCFunction)add_plugin_directory,
+      METH_VARARGS|METH_KEYWORDS,
+      s_add_plugin_directory_doc
+    },
+    {
+      s_plugins_str,
+      (PyCFunction)plugins,
+      METH_NOARGS,
+      s_plugins_doc
+    },
+    {
+      s_set_counting_str,
+      (PyCFunction)set_counting,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_counting_doc
+    },
+    {
+      s_stats_str,
+      (PyCFunction)stats,
+      METH_NOARGS,
+      s_stats_doc
+    },
+    {
+      s_reset_stats_str,
+      (PyCFunction)reset_stats,
+      METH_NOARGS,
+      s_reset_stats_doc
+    },
+    {
+      s_set_tracing_str,
+      (PyCFunction)set_tracing,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_tracing_doc
+    },
+    {
+      s_dump_trace_str,
+      (PyCFunction)dump_trace,
+      METH_VARARGS|METH_KEYWORDS,
+      s_dump_trace_doc
+    },
+    {
+      s_clear_trace_str,
+      (PyCFunction)clear_trace,
+      METH_NOARGS,
+      s_clear_trace_doc
+    },
+    {
+      s_trace_clock_str,
+      (PyCFunction)trace_clock,
+      METH_NOARGS,
+      s_trace_clock_doc
+    },
+    {
+      s_get_tuning_str,
+      (PyCFunction)get_tuning,
+      METH_VARARGS|METH_KEYWORDS,
+      s_get_tuning_doc
+    },
+    {
+      s_set_tuning_str,
+      (PyCFunction)set_tuning,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_tuning_doc
+    },
+    {
+      s_reset_tuning_str,
+      (PyCFunction)reset_tuning,
+      METH_VARARGS|METH_KEYWORDS,
+      s_reset_tuning_doc
+    },
+    {
+      s_tunings_str,
+      (PyCFunction)tunings,
+      METH_NOARGS,
+      s_tunings_doc
+    },
+    {
+      s_set_pooling_str,
+      (PyCFunction)set_pooling,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_pooling_doc
+    },
+    {
+      s_pool_statistics_str,
+      (PyCFunction)pool_statistics,
+      METH_NOARGS,
+      s_pool_statistics_doc
+    },
+    {
+      s_clear_pool_str,
+      (PyCFunction)clear_pool,
+      METH_NOARGS,
+      s_clear_pool_doc
+    },
+    {
+      s_set_pool_limit_str,
+      (PyCFunction)set_pool_limit,
+      METH_VARARGS|METH_KEYWORDS,
+      s_set_pool_limit_doc
+    },
     {0}  /* Sentinel */
 };
 
@@ -58,6 +1195,18 @@ static PyObject* create_module (void) {
   if (PyType_Ready(&PyBobLearnMultipliedHyperbolicTangentActivation_Type) < 0)
     return 0;
 
+  PyBobLearnActivationStatistics_Type.tp_new = PyType_GenericNew;
+  if (PyType_Ready(&PyBobLearnActivationStatistics_Type) < 0) return 0;
+
+  PyBobLearnActivationTape_Type.tp_new = PyType_GenericNew;
+  if (PyType_Ready(&PyBobLearnActivationTape_Type) < 0) return 0;
+
+  PyBobLearnCustomActivation_Type.tp_base = &PyBobLearnActivation_Type;
+  if (PyType_Ready(&PyBobLearnCustomActivation_Type) < 0) return 0;
+
+  PyBobLearnFormulaActivation_Type.tp_base = &PyBobLearnActivation_Type;
+  if (PyType_Ready(&PyBobLearnFormulaActivation_Type) < 0) return 0;
+
 # if PY_VERSION_HEX >= 0x03000000
   PyObject* module = PyModule_Create(&module_definition);
   auto module_ = make_xsafe(module);
@@ -87,6 +1236,18 @@ static PyObject* create_module (void) {
   Py_INCREF(&PyBobLearnMultipliedHyperbolicTangentActivation_Type);
   if (PyModule_AddObject(module, "MultipliedHyperbolicTangent", (PyObject *)&PyBobLearnMultipliedHyperbolicTangentActivation_Type) < 0) return 0;
 
+  Py_INCREF(&PyBobLearnActivationStatistics_Type);
+  if (PyModule_AddObject(module, "Statistics", (PyObject *)&PyBobLearnActivationStatistics_Type) < 0) return 0;
+
+  Py_INCREF(&PyBobLearnActivationTape_Type);
+  if (PyModule_AddObject(module, "Tape", (PyObject *)&PyBobLearnActivationTape_Type) < 0) return 0;
+
+  Py_INCREF(&PyBobLearnCustomActivation_Type);
+  if (PyModule_AddObject(module, "Custom", (PyObject *)&PyBobLearnCustomActivation_Type) < 0) return 0;
+
+  Py_INCREF(&PyBobLearnFormulaActivation_Type);
+  if (PyModule_AddObject(module, "Formula", (PyObject *)&PyBobLearnFormulaActivation_Type) < 0) return 0;
+
   static void* PyBobLearnActivation_API[PyBobLearnActivation_API_pointers];
 
   /* exhaustive list of C APIs */
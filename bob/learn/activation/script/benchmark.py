@@ -0,0 +1,630 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Mon 12 Oct 2026 14:03:21 CEST
+
+"""Benchmarks for activation functors
+
+Each sub-command measures one aspect of :py:mod:`bob.learn.activation` and
+prints its figures in a tabular form.
+"""
+
+from __future__ import print_function
+
+import os
+import sys
+import time
+import tempfile
+import argparse
+import multiprocessing
+
+import numpy
+
+
+def peak_rss():
+  """Returns the peak resident set size of this process, in MiB"""
+
+  import resource
+  rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+  # Linux reports KiB, macOS reports bytes
+  return rss / (1024. * 1024.) if sys.platform == 'darwin' else rss / 1024.
+
+
+def _stream_worker(args):
+  """Runs a single streaming variant, in a fresh process"""
+
+  variant, zname, aname, shape, tile = args
+
+  from .. import Logistic
+  op = Logistic()
+
+  z = numpy.memmap(zname, dtype=float, mode='r', shape=shape)
+  a = numpy.memmap(aname, dtype=float, mode='r+', shape=shape)
+
+  start = time.time()
+  if variant == 'f': op.f(z, a)
+  else: op.stream_mapped(z, a, tile=tile)
+  a.flush()
+  elapsed = time.time() - start
+
+  return elapsed, peak_rss()
+
+
+def stream(args):
+  """Compares f() with stream_mapped() on memory-mapped files"""
+
+  elements = int(args.size * (1 << 20) / 8)
+  shape = (elements,)
+  tile = int(args.tile * (1 << 20) / 8)
+
+  directory = args.directory or tempfile.gettempdir()
+  zname = os.path.join(directory, 'bob_learn_activation_z.bin')
+  aname = os.path.join(directory, 'bob_learn_activation_a.bin')
+
+  try:
+    print("Preparing %d MiB input and output files at `%s'..." % \
+        (args.size, directory))
+    z = numpy.memmap(zname, dtype=float, mode='w+', shape=shape)
+    a = numpy.memmap(aname, dtype=float, mode='w+', shape=shape)
+    block = 1 << 20
+    for k in range(0, elements, block):
+      z[k:k+block] = numpy.random.randn(min(block, elements-k))
+      a[k:k+block] = 0.
+    z.flush(); a.flush()
+    del z, a
+
+    print("%-14s %12s %14s %14s" % ('variant', 'time [s]', 'rate [MB/s]', 'peak RSS [MiB]'))
+    for variant in ('f', 'stream_mapped'):
+      for k in range(args.repeat):
+        pool = multiprocessing.Pool(1)
+        elapsed, rss = pool.map(_stream_worker, [(variant, zname, aname, shape, tile)])[0]
+        pool.close()
+        pool.join()
+        print("%-14s %12.3f %14.1f %14.1f" % (variant, elapsed,
+          2*elements*8/(elapsed*1e6), rss))
+
+  finally:
+    for k in (zname, aname):
+      if os.path.exists(k): os.unlink(k)
+
+  print("note: figures depend on the state of the operating system file cache")
+
+
+def _best_of(repeat, call):
+  """Returns the shortest time, in seconds, of ``repeat`` calls"""
+
+  best = float('inf')
+  for k in range(repeat):
+    start = time.time()
+    call()
+    best = min(best, time.time() - start)
+  return best
+
+
+def stats(args):
+  """Measures the overhead of accumulating statistics during f()"""
+
+  from .. import Logistic, HyperbolicTangent, Statistics, tunings, \
+      set_tuning, reset_tuning
+
+  z = numpy.random.randn(int(args.size * (1 << 20) / 8))
+  a = numpy.empty_like(z)
+
+  def separate(op, s):
+    op.f(z, a)
+    # what one would otherwise do: a second pass over the outputs
+    a.mean(); a.var(); a.min(); a.max()
+    numpy.histogram(a, bins=s.histogram.size, range=(s.lower, s.upper))
+
+  print("%-18s %8s %12s %16s %16s %10s" % ('function', 'threads',
+    'f() [ms]', 'f(stats) [ms]', 'f()+numpy [ms]', 'overhead'))
+  for op in (Logistic(), HyperbolicTangent()):
+    identifier = op.unique_identifier()
+    previous = tunings().get(identifier)
+    try:
+      for threads in args.threads:
+        # serial or parallel evaluation, statistics included
+        set_tuning(identifier, threads, 1 << 16, 1 << 14)
+        s = Statistics(args.bins)
+        plain = _best_of(args.repeat, lambda: op.f(z, a))
+        fused = _best_of(args.repeat, lambda: op.f(z, a, s))
+        second = _best_of(args.repeat, lambda: separate(op, s))
+        print("%-18s %8d %12.2f %16.2f %16.2f %9.1f%%" % (type(op).__name__,
+          threads, 1e3*plain, 1e3*fused, 1e3*second, 100*(fused-plain)/plain))
+    finally:
+      if previous: set_tuning(identifier, previous['threads'],
+          previous['threshold'], previous['chunk'])
+      else: reset_tuning(identifier)
+
+
+def _bundle_worker(args):
+  """Loads all activations of a model, in a fresh process"""
+
+  variant, fname, count = args
+
+  from .. import load_activation, load_bundle
+
+  start = time.time()
+  if variant == 'hdf5':
+    import bob.io.base
+    f = bob.io.base.HDF5File(fname, 'r')
+    activations = []
+    for k in range(count):
+      f.cd('/layer%d' % k)
+      activations.append(load_activation(f))
+  else:
+    activations = load_bundle(fname)
+  elapsed = time.time() - start
+
+  assert len(activations) == count
+  return elapsed
+
+
+def bundle(args):
+  """Compares cold-start loading of HDF5 groups and compact bundles"""
+
+  import bob.io.base
+  from .. import Logistic, HyperbolicTangent, MultipliedHyperbolicTangent, \
+      save_bundle
+
+  kinds = (Logistic(), HyperbolicTangent(),
+      MultipliedHyperbolicTangent(1.7159, 2./3.))
+  activations = [kinds[k % len(kinds)] for k in range(args.layers)]
+
+  directory = args.directory or tempfile.gettempdir()
+  hname = os.path.join(directory, 'bob_learn_activation_model.hdf5')
+  bname = os.path.join(directory, 'bob_learn_activation_model.bin')
+
+  try:
+    print("Saving %d activations..." % args.layers)
+    f = bob.io.base.HDF5File(hname, 'w')
+    for k, a in enumerate(activations):
+      f.create_group('/layer%d' % k)
+      f.cd('/layer%d' % k)
+      a.save(f)
+    del f
+    save_bundle(bname, activations)
+
+    print("%-8s %12s %12s" % ('format', 'size [KiB]', 'load [ms]'))
+    for variant, fname in (('hdf5', hname), ('bundle', bname)):
+      times = []
+      for k in range(args.repeat):
+        pool = multiprocessing.Pool(1)
+        times.append(pool.map(_bundle_worker, [(variant, fname, args.layers)])[0])
+        pool.close()
+        pool.join()
+      print("%-8s %12.1f %12.2f" % (variant, os.path.getsize(fname)/1024.,
+        1e3*min(times)))
+
+  finally:
+    for k in (hname, bname):
+      if os.path.exists(k): os.unlink(k)
+
+
+def formula(args):
+  """Compares formulas with the equivalent built-in functions"""
+
+  from .. import Logistic, HyperbolicTangent, MultipliedHyperbolicTangent, \
+      Formula
+
+  z = numpy.random.randn(int(args.size * (1 << 20) / 8))
+  a = numpy.empty_like(z)
+
+  pairs = (
+      (Logistic(), Formula('1 / (1 + exp(-z))')),
+      (HyperbolicTangent(), Formula('tanh(z)')),
+      (MultipliedHyperbolicTangent(1.7159, 2./3.),
+        Formula('C * tanh(M * z)', {'C': 1.7159, 'M': 2./3.})),
+      )
+
+  print("%-28s %-7s %14s %14s %10s" % ('function', 'method', 'built-in [ms]',
+    'formula [ms]', 'ratio'))
+  for builtin, op in pairs:
+    for method in ('f', 'f_prime'):
+      native = _best_of(args.repeat, lambda: getattr(builtin, method)(z, a))
+      compiled = _best_of(args.repeat, lambda: getattr(op, method)(z, a))
+      print("%-28s %-7s %14.2f %14.2f %9.2fx" % (op.formula, method,
+        1e3*native, 1e3*compiled, compiled/native))
+
+
+def clone(args):
+  """Compares threads sharing an activation with threads using clones"""
+
+  from .. import Logistic, MultipliedHyperbolicTangent
+  from .._library import _evaluate_in_threads
+
+  print("%-28s %8s %14s %14s %10s" % ('function', 'threads',
+    'shared [ms]', 'cloned [ms]', 'speed-up'))
+  for op in (Logistic(), MultipliedHyperbolicTangent(1.7159, 2./3.)):
+    for threads in args.threads:
+      run = lambda clone: _evaluate_in_threads(op, threads, args.size,
+          args.iterations, clone)
+      shared = min(run(False) for k in range(args.repeat))
+      cloned = min(run(True) for k in range(args.repeat))
+      print("%-28s %8d %14.2f %14.2f %9.2fx" % (type(op).__name__, threads,
+        1e3*shared, 1e3*cloned, shared/cloned))
+
+
+def _shape(elements, rank):
+  """Returns a shape of the given rank with (about) ``elements`` entries"""
+
+  side = max(1, int(round(elements ** (1. / rank))))
+  return tuple([side] * (rank - 1) + [max(1, elements // side ** (rank - 1))])
+
+
+def kernels(args):
+  """Measures the C++ kernels of the built-in functions, writing JSON"""
+
+  import json
+  import platform
+  import datetime
+  from .. import _benchmark
+  from .. import version
+
+  print("%-28s %-15s %-9s %5s %-10s %7s %14s %12s" % ('function', 'method',
+    'size', 'rank', 'layout', 'threads', 'rate [Mel/s]', 'cycles/el'),
+    file=sys.stderr)
+
+  records = []
+  for size in args.sizes:
+    elements = max(1, int(size * 1024 / 8))
+    for rank in args.ranks:
+      shape = _shape(elements, rank)
+      for layout in args.layouts:
+        for threads in args.threads:
+          results = _benchmark.kernels(shape, layout == 'strided', threads,
+              args.repeat, args.elements)
+          for r in results:
+            r.update({'size': int(size * 1024), 'rank': rank, 'shape': list(shape),
+              'layout': layout, 'threads': threads})
+            records.append(r)
+            cycles = r['cycles_per_element']
+            print("%-28s %-15s %-9s %5d %-10s %7d %14.1f %12s" % (r['activation'],
+              r['method'], '%gK' % size, rank, layout, threads,
+              r['elements_per_second'] / 1e6,
+              '%.2f' % cycles if cycles is not None else '-'), file=sys.stderr)
+
+  report = {
+      'version': version.module,
+      'date': datetime.datetime.now().isoformat(),
+      'machine': {
+        'platform': platform.platform(),
+        'processor': platform.processor() or platform.machine(),
+        'cpus': multiprocessing.cpu_count(),
+        },
+      'results': records,
+      }
+
+  if args.output:
+    with open(args.output, 'w') as f: json.dump(report, f, indent=2)
+  else:
+    json.dump(report, sys.stdout, indent=2)
+    print()
+
+
+def _per_call(repeat, call, duration=0.1):
+  """Returns the shortest time, in seconds, of one of the ``call``'s, timed
+  in batches lasting at least ``duration`` seconds"""
+
+  import timeit
+  timer = timeit.Timer(call)
+  number = 1
+  while timer.timeit(number) < duration: number *= 4
+  return min(timer.repeat(repeat, number)) / number
+
+
+def overhead(args):
+  """Measures the cost of calls from Python, against plain numpy"""
+
+  import json
+  import platform
+  import datetime
+  from .. import Logistic, HyperbolicTangent
+  from .. import version
+
+  cases = (
+      ('Logistic', Logistic(),
+        lambda z: 1. / (1. + numpy.exp(-z)),
+        lambda z, a: numpy.reciprocal(numpy.add(numpy.exp(numpy.negative(z, out=a), out=a), 1., out=a), out=a)),
+      ('HyperbolicTangent', HyperbolicTangent(),
+        numpy.tanh,
+        lambda z, a: numpy.tanh(z, out=a)),
+      )
+
+  print("%-18s %-9s %10s %14s %14s %14s %14s" % ('function', 'input',
+    'size', 'f(z) [us]', 'f(z,res) [us]', 'numpy [us]', 'numpy out [us]'),
+    file=sys.stderr)
+
+  records = []
+  for name, op, expression, expression_out in cases:
+    times = {}
+    times[('scalar', 1)] = (
+        _per_call(args.repeat, lambda: op(0.5)),
+        None,
+        _per_call(args.repeat, lambda: expression(0.5)),
+        None,
+        )
+    for size in args.sizes:
+      z = numpy.random.randn(size)
+      a = numpy.empty_like(z)
+      times[('array', size)] = (
+          _per_call(args.repeat, lambda: op(z)),
+          _per_call(args.repeat, lambda: op(z, a)),
+          _per_call(args.repeat, lambda: expression(z)),
+          _per_call(args.repeat, lambda: expression_out(z, a)),
+          )
+
+    for (kind, size) in sorted(times):
+      for variant, t in zip(('f', 'f_res', 'numpy', 'numpy_out'), times[(kind, size)]):
+        if t is None: continue
+        records.append({'activation': name, 'input': kind, 'size': size,
+          'variant': variant, 'seconds': t})
+      print("%-18s %-9s %10d %14s %14s %14s %14s" % ((name, kind, size) + \
+          tuple('%.3f' % (1e6*t) if t is not None else '-' for t in times[(kind, size)])),
+          file=sys.stderr)
+
+  report = {
+      'version': version.module,
+      'date': datetime.datetime.now().isoformat(),
+      'machine': {
+        'platform': platform.platform(),
+        'processor': platform.processor() or platform.machine(),
+        'cpus': multiprocessing.cpu_count(),
+        'python': platform.python_version(),
+        'numpy': numpy.__version__,
+        },
+      'results': records,
+      }
+
+  if args.output:
+    with open(args.output, 'w') as f: json.dump(report, f, indent=2)
+  else:
+    json.dump(report, sys.stdout, indent=2)
+    print()
+
+
+# entries of JSON records that are measurements rather than parameters
+_MEASUREMENTS = ('seconds', 'elements_per_second', 'cycles_per_element')
+
+
+def compare(args):
+  """Compares JSON results against a baseline, flagging regressions"""
+
+  import json
+
+  def records(fname):
+    with open(fname) as f: report = json.load(f)
+    retval = {}
+    for r in report['results']:
+      key = tuple(sorted((k, str(v)) for k, v in r.items() if k not in _MEASUREMENTS))
+      retval[key] = r['seconds']
+    return report, retval
+
+  baseline_report, baseline = records(args.baseline)
+  current_report, current = records(args.current)
+
+  print("baseline: %s (%s, %s)" % (args.baseline, baseline_report.get('version'),
+    baseline_report.get('date')))
+  print("current:  %s (%s, %s)" % (args.current, current_report.get('version'),
+    current_report.get('date')))
+  if baseline_report.get('machine') != current_report.get('machine'):
+    print("warning: the results were obtained on different machines")
+
+  regressions = 0
+  print("%-70s %12s %12s %8s" % ('benchmark', 'baseline', 'current', 'change'))
+  for key in sorted(set(baseline) & set(current)):
+    change = current[key] / baseline[key] - 1.
+    flag = ''
+    if change > args.threshold / 100.:
+      flag = '  REGRESSION'
+      regressions += 1
+    elif args.regressions_only:
+      continue
+    print("%-70s %12.4g %12.4g %+7.1f%%%s" % (' '.join('%s=%s' % k for k in key),
+      baseline[key], current[key], 100*change, flag))
+
+  missing = len(set(baseline) - set(current))
+  if missing: print("%d benchmark(s) of the baseline were not run" % missing)
+
+  print("%d regression(s) above %g%%" % (regressions, args.threshold))
+  return 1 if regressions else 0
+
+
+def accuracy(args):
+  """Measures errors, in ULPs, against a high-precision reference"""
+
+  import json
+  from .. import Identity, Linear, Logistic, HyperbolicTangent, \
+      MultipliedHyperbolicTangent
+  from .. import accuracy as reference
+
+  budgets = reference.BUDGETS
+  if args.budgets:
+    with open(args.budgets) as f: budgets = json.load(f)
+
+  print("%-8s %-28s %-16s %-11s %10s %10s %10s %10s %12s" % ('input',
+    'function', 'method', 'region', 'max ULP', 'mean ULP', 'max abs',
+    'mean abs', 'rate [Mel/s]'))
+
+  violations = 0
+  for dtype in args.types:
+    for op in (Identity(), Linear(2.), Logistic(), HyperbolicTangent(),
+        MultipliedHyperbolicTangent(1.7159, 2./3.)):
+      name = type(op).__name__
+      for method in reference.METHODS:
+        for region in args.regions:
+          r = reference.measure(op, method, reference.inputs(region,
+            args.size, dtype))
+          budget = budgets.get(dtype, {}).get(name, {}).get(method)
+          flags = reference.check(r, budget) if budget else []
+          violations += len(flags)
+          print("%-8s %-28s %-16s %-11s %10.3g %10.3g %10.3g %10.3g %12.1f%s" % \
+              (dtype, name, method, region, r['max_ulp'], r['mean_ulp'],
+                r['max_abs'], r['mean_abs'], r['elements_per_second'] / 1e6,
+                ''.join('  OVER BUDGET: ' + k for k in flags)))
+
+  print("%d budget violation(s)" % violations)
+  return 1 if violations else 0
+
+
+def tune(args):
+  """Tunes the parallel evaluation of large arrays for this machine"""
+
+  from .. import tuning
+
+  if args.show:
+    saved = tuning.load(args.cache)
+    if saved is None:
+      print("nothing was tuned for `%s' yet" % tuning.cpu_model())
+      return 1
+    results = saved
+  else:
+    kwargs = {'elements': args.elements, 'margin': args.margin / 100.}
+    if args.threads: kwargs['threads'] = args.threads
+    if args.chunks: kwargs['chunks'] = args.chunks
+    results = tuning.autotune(path=False if args.dry_run else args.cache,
+        **kwargs)
+
+  print("%s (%s)" % (tuning.cpu_model(), args.cache or tuning.cache_path()))
+  print("%-60s %-8s %8s %10s %8s" % ('function', 'type', 'threads',
+    'threshold', 'chunk'))
+  for identifier in sorted(results):
+    for dtype, t in sorted(results[identifier].items()):
+      print("%-60s %-8s %8d %10d %8d" % (identifier, dtype, t['threads'],
+        t['threshold'], t['chunk']))
+
+
+def main(user_input=None):
+
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawDescriptionHelpFormatter)
+  subparsers = parser.add_subparsers(dest='command')
+
+  p = subparsers.add_parser('stream', help=stream.__doc__)
+  p.add_argument('--size', type=int, default=1024,
+      help="size of the input (and output) file, in MiB (default: %(default)s)")
+  p.add_argument('--tile', type=float, default=4,
+      help="tile size for stream_mapped(), in MiB (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=1,
+      help="how many times to run each variant (default: %(default)s)")
+  p.add_argument('--directory', default=None,
+      help="where to create the files (default: the system temporary directory)")
+  p.set_defaults(func=stream)
+
+  p = subparsers.add_parser('stats', help=stats.__doc__)
+  p.add_argument('--size', type=float, default=64,
+      help="size of the input array, in MiB (default: %(default)s)")
+  p.add_argument('--bins', type=int, default=100,
+      help="number of histogram bins (default: %(default)s)")
+  p.add_argument('--threads', type=int, nargs='+',
+      default=sorted(set([1, multiprocessing.cpu_count()])),
+      help="numbers of threads evaluating the array, 1 being serial (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=5,
+      help="how many times to run each variant (default: %(default)s)")
+  p.set_defaults(func=stats)
+
+  p = subparsers.add_parser('bundle', help=bundle.__doc__)
+  p.add_argument('--layers', type=int, default=10000,
+      help="number of activations in the model (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=3,
+      help="how many times to load each format (default: %(default)s)")
+  p.add_argument('--directory', default=None,
+      help="where to create the files (default: the system temporary directory)")
+  p.set_defaults(func=bundle)
+
+  p = subparsers.add_parser('formula', help=formula.__doc__)
+  p.add_argument('--size', type=float, default=64,
+      help="size of the input array, in MiB (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=5,
+      help="how many times to run each variant (default: %(default)s)")
+  p.set_defaults(func=formula)
+
+  p = subparsers.add_parser('clone', help=clone.__doc__)
+  p.add_argument('--threads', type=int, nargs='+',
+      default=[1, 2, multiprocessing.cpu_count()],
+      help="numbers of threads to try (default: %(default)s)")
+  p.add_argument('--size', type=int, default=16,
+      help="values evaluated per call, e.g. a layer width (default: %(default)s)")
+  p.add_argument('--iterations', type=int, default=200000,
+      help="calls per thread (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=3,
+      help="how many times to run each variant (default: %(default)s)")
+  p.set_defaults(func=clone)
+
+  p = subparsers.add_parser('kernels', help=kernels.__doc__)
+  p.add_argument('--sizes', type=float, nargs='+', default=[16, 256, 4096, 65536],
+      help="sizes of the input array, in KiB - by default, resident in L1, L2, L3 and DRAM (default: %(default)s)")
+  p.add_argument('--ranks', type=int, nargs='+', default=[1, 2, 3, 4],
+      choices=[1, 2, 3, 4], help="array ranks to try (default: %(default)s)")
+  p.add_argument('--layouts', nargs='+', default=['contiguous', 'strided'],
+      choices=['contiguous', 'strided'],
+      help="memory layouts to try (default: %(default)s)")
+  p.add_argument('--threads', type=int, nargs='+',
+      default=sorted(set([1, multiprocessing.cpu_count()])),
+      help="numbers of threads to try (default: %(default)s)")
+  p.add_argument('--elements', type=int, default=1<<22,
+      help="minimum number of values computed per measurement (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=5,
+      help="how many times to run each variant (default: %(default)s)")
+  p.add_argument('--output', default=None,
+      help="where to write the JSON results (default: the standard output)")
+  p.set_defaults(func=kernels)
+
+  p = subparsers.add_parser('overhead', help=overhead.__doc__)
+  p.add_argument('--sizes', type=int, nargs='+', default=[1, 16, 1024, 1<<20],
+      help="sizes of the input arrays, in elements (default: %(default)s)")
+  p.add_argument('--repeat', type=int, default=5,
+      help="how many times to run each variant (default: %(default)s)")
+  p.add_argument('--output', default=None,
+      help="where to write the JSON results (default: the standard output)")
+  p.set_defaults(func=overhead)
+
+  p = subparsers.add_parser('accuracy', help=accuracy.__doc__)
+  p.add_argument('--types', nargs='+', default=['float64', 'float32'],
+      choices=['float64', 'float32'],
+      help="input types, whose ULPs measure errors (default: %(default)s)")
+  p.add_argument('--regions', nargs='+',
+      default=['dense', 'random', 'saturation', 'denormal'],
+      choices=['dense', 'random', 'saturation', 'denormal'],
+      help="input sweeps, see bob.learn.activation.accuracy.inputs (default: %(default)s)")
+  p.add_argument('--size', type=int, default=10000,
+      help="number of inputs per sweep (default: %(default)s)")
+  p.add_argument('--budgets', default=None,
+      help="JSON file with error budgets, structured like bob.learn.activation.accuracy.BUDGETS (default: the built-in ones)")
+  p.set_defaults(func=accuracy)
+
+  p = subparsers.add_parser('tune', help=tune.__doc__)
+  p.add_argument('--threads', type=int, nargs='+', default=None,
+      help="thread counts to try (default: powers of two up to the number of processors)")
+  p.add_argument('--chunks', type=int, nargs='+', default=None,
+      help="chunk sizes to try, in elements (default: 4096 16384 65536)")
+  p.add_argument('--elements', type=int, default=1 << 22,
+      help="approximate number of elements evaluated per measurement (default: %(default)s)")
+  p.add_argument('--margin', type=float, default=10.,
+      help="speed-up, in percent, parallel evaluation must reach to be chosen (default: %(default)s)")
+  p.add_argument('--cache', default=None,
+      help="cache file of tuned configurations (default: see bob.learn.activation.tuning.cache_path)")
+  p.add_argument('--dry-run', action='store_true',
+      help="does not save the results")
+  p.add_argument('--show', action='store_true',
+      help="only shows the configurations saved for this machine")
+  p.set_defaults(func=tune)
+
+  p = subparsers.add_parser('compare', help=compare.__doc__)
+  p.add_argument('baseline',
+      help="JSON results of the 'kernels' or 'overhead' sub-commands, used as reference")
+  p.add_argument('current', help="JSON results of the same sub-command to check")
+  p.add_argument('--threshold', type=float, default=10.,
+      help="slow-down, in percent, above which a benchmark is flagged (default: %(default)s)")
+  p.add_argument('--regressions-only', action='store_true',
+      help="only lists the benchmarks flagged as regressions")
+  p.set_defaults(func=compare)
+
+  args = parser.parse_args(args=user_input)
+  if not hasattr(args, 'func'):
+    parser.print_help()
+    return 1
+
+  return args.func(args) or 0
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,311 @@
+/**
+ * @date Wed 14 Oct 2026 11:20:05 CEST
+ *
+ * @brief Bindings for statistics of activated values
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOB_LEARN_ACTIVATION_MODULE
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.learn.activation/api.h>
+#include <cstring>
+
+PyDoc_STRVAR(s_statistics_str, BOB_EXT_MODULE_PREFIX ".Statistics");
+
+PyDoc_STRVAR(s_statistics_doc,
+"Statistics([bins=100, [lower=-1., [upper=1.]]]) -> new Statistics\n\
+\n\
+Accumulates statistics of activated values: their count, mean,\n\
+variance, minimum, maximum, fraction of saturated values and a\n\
+histogram with ``bins`` equal bins covering ``[lower, upper)``.\n\
+Values outside that range are counted in the first or last bin.\n\
+\n\
+Pass an object of this type as ``stats`` to\n\
+:py:meth:`Activation.f` to accumulate the statistics of its\n\
+outputs in the same pass that computes them, which is cheaper\n\
+than going over the outputs a second time. Values are accumulated\n\
+over successive calls, until :py:meth:`reset` is called.\n\
+\n\
+Values are saturated when the activation function's derivative\n\
+nearly vanishes, e.g. ``|tanh(z)| > 0.99`` or ``logistic(z)``\n\
+below ``0.01`` or above ``0.99``. Identity and linear functions\n\
+never saturate.\n\
+\n\
+");
+
+static int PyBobLearnActivationStatistics_init
+(PyBobLearnActivationStatisticsObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"bins", "lower", "upper", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t bins = 100;
+  double lower = -1.;
+  double upper = 1.;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ndd", kwlist,
+        &bins, &lower, &upper)) return -1;
+
+  if (bins <= 0) {
+    PyErr_Format(PyExc_ValueError, "`%s' requires a positive number of bins (not %" PY_FORMAT_SIZE_T "d)", Py_TYPE(self)->tp_name, bins);
+    return -1;
+  }
+
+  try {
+    self->cxx.reset(new bob::learn::activation::Statistics(bins, lower, upper));
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot create new object of type `%s' - unknown exception thrown", s_statistics_str);
+  }
+
+  if (PyErr_Occurred()) return -1;
+
+  return 0;
+
+}
+
+static void PyBobLearnActivationStatistics_delete
+(PyBobLearnActivationStatisticsObject* self) {
+
+  self->cxx.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+
+}
+
+PyDoc_STRVAR(s_reset_str, "reset");
+PyDoc_STRVAR(s_reset_doc,
+"o.reset() -> None\n\
+\n\
+Forgets all values accumulated so far.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivationStatistics_reset
+(PyBobLearnActivationStatisticsObject* self) {
+
+  self->cxx->reset();
+  Py_RETURN_NONE;
+
+}
+
+PyDoc_STRVAR(s_merge_str, "merge");
+PyDoc_STRVAR(s_merge_doc,
+"o.merge(other) -> None\n\
+\n\
+Merges the values accumulated by ``other``, another\n\
+:py:class:`Statistics` object with the same histogram\n\
+configuration, into this one.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivationStatistics_merge
+(PyBobLearnActivationStatisticsObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"other", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBobLearnActivationStatisticsObject* other = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+        &PyBobLearnActivationStatistics_Type, &other)) return 0;
+
+  try {
+    self->cxx->merge(*other->cxx);
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+    return 0;
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot merge statistics - unknown exception thrown");
+    return 0;
+  }
+
+  Py_RETURN_NONE;
+
+}
+
+static PyMethodDef PyBobLearnActivationStatistics_methods[] = {
+  {
+    s_reset_str,
+    (PyCFunction)PyBobLearnActivationStatistics_reset,
+    METH_NOARGS,
+    s_reset_doc
+  },
+  {
+    s_merge_str,
+    (PyCFunction)PyBobLearnActivationStatistics_merge,
+    METH_VARARGS|METH_KEYWORDS,
+    s_merge_doc
+  },
+  {0} /* Sentinel */
+};
+
+static PyObject* PyBobLearnActivationStatistics_count
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("n", (Py_ssize_t)self->cxx->count());
+}
+
+static PyObject* PyBobLearnActivationStatistics_mean
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->mean());
+}
+
+static PyObject* PyBobLearnActivationStatistics_variance
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->variance());
+}
+
+static PyObject* PyBobLearnActivationStatistics_min
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->min());
+}
+
+static PyObject* PyBobLearnActivationStatistics_max
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->max());
+}
+
+static PyObject* PyBobLearnActivationStatistics_saturated
+(PyBobLearnActivationStatisticsObject* self) {
+  std::size_t count = self->cxx->count();
+  return Py_BuildValue("d", count ? (double)self->cxx->saturated() / count : 0.);
+}
+
+static PyObject* PyBobLearnActivationStatistics_histogram
+(PyBobLearnActivationStatisticsObject* self) {
+
+  const std::vector<uint64_t>& histogram = self->cxx->histogram();
+  npy_intp size = histogram.size();
+  PyObject* retval = PyArray_SimpleNew(1, &size, NPY_UINT64);
+  if (!retval) return 0;
+  std::memcpy(PyArray_DATA(reinterpret_cast<PyArrayObject*>(retval)),
+      &histogram[0], size*sizeof(uint64_t));
+  return retval;
+
+}
+
+static PyObject* PyBobLearnActivationStatistics_lower
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->lower());
+}
+
+static PyObject* PyBobLearnActivationStatistics_upper
+(PyBobLearnActivationStatisticsObject* self) {
+  return Py_BuildValue("d", self->cxx->upper());
+}
+
+static PyGetSetDef PyBobLearnActivationStatistics_getseters[] = {
+    {
+      "count",
+      (getter)PyBobLearnActivationStatistics_count,
+      0,
+      "Number of values accumulated (read-only)",
+      0
+    },
+    {
+      "mean",
+      (getter)PyBobLearnActivationStatistics_mean,
+      0,
+      "Mean of the values accumulated (read-only)",
+      0
+    },
+    {
+      "variance",
+      (getter)PyBobLearnActivationStatistics_variance,
+      0,
+      "Population variance of the values accumulated (read-only)",
+      0
+    },
+    {
+      "min",
+      (getter)PyBobLearnActivationStatistics_min,
+      0,
+      "Smallest value accumulated, ``inf`` if none (read-only)",
+      0
+    },
+    {
+      "max",
+      (getter)PyBobLearnActivationStatistics_max,
+      0,
+      "Largest value accumulated, ``-inf`` if none (read-only)",
+      0
+    },
+    {
+      "saturated",
+      (getter)PyBobLearnActivationStatistics_saturated,
+      0,
+      "Fraction of the values accumulated that were saturated (read-only)",
+      0
+    },
+    {
+      "histogram",
+      (getter)PyBobLearnActivationStatistics_histogram,
+      0,
+      "A copy of the histogram counts, as a 64-bit unsigned integer array (read-only)",
+      0
+    },
+    {
+      "lower",
+      (getter)PyBobLearnActivationStatistics_lower,
+      0,
+      "Lower bound of the histogram (read-only)",
+      0
+    },
+    {
+      "upper",
+      (getter)PyBobLearnActivationStatistics_upper,
+      0,
+      "Upper bound of the histogram (read-only)",
+      0
+    },
+    {0}  /* Sentinel */
+};
+
+PyTypeObject PyBobLearnActivationStatistics_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    s_statistics_str,                                   /*tp_name*/
+    sizeof(PyBobLearnActivationStatisticsObject),       /*tp_basicsize*/
+    0,                                                  /*tp_itemsize*/
+    (destructor)PyBobLearnActivationStatistics_delete,  /*tp_dealloc*/
+    0,                                                  /*tp_print*/
+    0,                                                  /*tp_getattr*/
+    0,                                                  /*tp_setattr*/
+    0,                                                  /*tp_compare*/
+    0,                                                  /*tp_repr*/
+    0,                                                  /*tp_as_number*/
+    0,                                                  /*tp_as_sequence*/
+    0,                                                  /*tp_as_mapping*/
+    0,                                                  /*tp_hash */
+    0,                                                  /*tp_call*/
+    0,                                                  /*tp_str*/
+    0,                                                  /*tp_getattro*/
+    0,                                                  /*tp_setattro*/
+    0,                                                  /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,                                 /*tp_flags*/
+    s_statistics_doc,                                   /* tp_doc */
+    0,		                                              /* tp_traverse */
+    0,		                                              /* tp_clear */
+    0,                                                  /* tp_richcompare */
+    0,		                                              /* tp_weaklistoffset */
+    0,		                                              /* tp_iter */
+    0,		                                              /* tp_iternext */
+    PyBobLearnActivationStatistics_methods,             /* tp_methods */
+    0,                                                  /* tp_members */
+    PyBobLearnActivationStatistics_getseters,           /* tp_getset */
+    0,                                                  /* tp_base */
+    0,                                                  /* tp_dict */
+    0,                                                  /* tp_descr_get */
+    0,                                                  /* tp_descr_set */
+    0,                                                  /* tp_dictoffset */
+    (initproc)PyBobLearnActivationStatistics_init,      /* tp_init */
+    0,                                                  /* tp_alloc */
+    0,                                                  /* tp_new */
+};
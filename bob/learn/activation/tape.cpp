@@ -0,0 +1,435 @@
+/**
+ * @date Sun 18 Oct 2026 21:15:32 CEST
+ *
+ * @brief Bindings for tapes of forward activations
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOB_LEARN_ACTIVATION_MODULE
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.learn.activation/api.h>
+#include <exception>
+
+PyDoc_STRVAR(s_tape_str, BOB_EXT_MODULE_PREFIX ".Tape");
+
+PyDoc_STRVAR(s_tape_doc,
+"Tape([capacity=0]) -> new Tape\n\
+\n\
+Records the outputs of the activation functions of a sequence of\n\
+layers during the forward pass of a training iteration, for the\n\
+backward pass, in a single reusable memory arena.\n\
+\n\
+Call :py:meth:`forward` for each layer, in order, then\n\
+:py:meth:`backward` for each layer, in reverse order, to multiply\n\
+the gradients of its outputs by the derivative of its function,\n\
+computed from the outputs recorded. Call :py:meth:`rewind` before\n\
+the next iteration.\n\
+\n\
+During the first iteration, the arena grows as needed, unless it\n\
+was created with enough ``capacity`` (in values). On rewinding, it\n\
+is resized to fit all outputs of the iteration at once. Later\n\
+iterations with the same shapes allocate no memory at all: they\n\
+return the same output arrays, overwritten, and the backward pass\n\
+works in place.\n\
+\n\
+.. warning::\n\
+\n\
+   Outputs returned by :py:meth:`forward` are views of the arena:\n\
+   they are overwritten by the next iterations. Copy them to keep\n\
+   them.\n\
+\n\
+");
+
+static int PyBobLearnActivationTape_init
+(PyBobLearnActivationTapeObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"capacity", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t capacity = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n", kwlist, &capacity)) return -1;
+
+  if (capacity < 0) {
+    PyErr_Format(PyExc_ValueError, "`%s' capacity must be positive (or zero), not %" PY_FORMAT_SIZE_T "d", Py_TYPE(self)->tp_name, capacity);
+    return -1;
+  }
+
+  Py_XDECREF(self->views);
+  self->views = PyList_New(0);
+  if (!self->views) return -1;
+
+  try {
+    self->cxx.reset(new bob::learn::activation::Tape(capacity));
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+  }
+  catch (...) {
+    PyErr_Format(PyExc_RuntimeError, "cannot create new object of type `%s' - unknown exception thrown", s_tape_str);
+  }
+
+  if (PyErr_Occurred()) return -1;
+
+  return 0;
+
+}
+
+static void PyBobLearnActivationTape_delete
+(PyBobLearnActivationTapeObject* self) {
+
+  self->cxx.reset();
+  Py_XDECREF(self->views);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+
+}
+
+static void delete_block(PyObject* capsule) {
+  delete reinterpret_cast<boost::shared_array<double>*>(PyCapsule_GetPointer(capsule, 0));
+}
+
+/**
+ * Returns a new reference to an array of the given shape over the outputs of
+ * layer k, reusing the one of the previous iteration if it matches, so that
+ * steady iterations allocate nothing. Returns 0 with an exception set on
+ * errors.
+ */
+static PyObject* layer_view(PyBobLearnActivationTapeObject* self,
+    std::size_t k, int ndim, npy_intp* shape) {
+
+  double* data = self->cxx->data(k);
+
+  if ((Py_ssize_t)k < PyList_GET_SIZE(self->views)) {
+    PyArrayObject* view = reinterpret_cast<PyArrayObject*>(PyList_GET_ITEM(self->views, k));
+    bool same = PyArray_DATA(view) == data && PyArray_NDIM(view) == ndim;
+    for (int d=0; same && d<ndim; ++d) same = PyArray_DIM(view, d) == shape[d];
+    if (same) return Py_BuildValue("O", view);
+  }
+
+  PyObject* retval = PyArray_SimpleNewFromData(ndim, shape, NPY_FLOAT64, data);
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  // the array keeps its block of the arena alive, even if the tape goes away
+  PyObject* base = PyCapsule_New(new boost::shared_array<double>(self->cxx->block(k)), 0, &delete_block);
+  if (!base) return 0;
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), base) < 0) return 0;
+
+  if ((Py_ssize_t)k < PyList_GET_SIZE(self->views)) {
+    Py_INCREF(retval);
+    if (PyList_SetItem(self->views, k, retval) < 0) return 0;
+  }
+  else if (PyList_Append(self->views, retval) < 0) return 0;
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyDoc_STRVAR(s_forward_str, "forward");
+PyDoc_STRVAR(s_forward_doc,
+"o.forward(activation, z) -> array\n\
+\n\
+Computes ``activation.f(z)`` into the arena, recording it as the\n\
+output of the next layer, and returns it. ``z`` must be an array of\n\
+64-bit floats with 1 to 4 dimensions. The output is a C-contiguous\n\
+array of the same shape, valid until the next iteration.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivationTape_forward
+(PyBobLearnActivationTapeObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"activation", "z", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBobLearnActivationObject* activation = 0;
+  PyObject* z_object = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O", kwlist,
+        &PyBobLearnActivation_Type, &activation, &z_object)) return 0;
+
+  PyArrayObject* z = reinterpret_cast<PyArrayObject*>(PyArray_CheckFromAny(z_object,
+        0, 0, 0, NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED, 0));
+  if (!z) return 0;
+  auto z_ = make_safe(z);
+
+  if (PyArray_TYPE(z) != NPY_FLOAT64) {
+    PyErr_Format(PyExc_TypeError, "`%s' only records 64-bit float arrays for input array `z'", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  if (PyArray_NDIM(z) < 1 || PyArray_NDIM(z) > 4) {
+    PyErr_Format(PyExc_TypeError, "`%s' only records 1, 2, 3 or 4-dimensional arrays (not %dD arrays)", Py_TYPE(self)->tp_name, PyArray_NDIM(z));
+    return 0;
+  }
+
+  std::size_t k = self->cxx->size();
+  try {
+    self->cxx->push(activation->cxx, PyArray_SIZE(z));
+  }
+  catch (std::exception& ex) {
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+    return 0;
+  }
+
+  PyObject* retval = layer_view(self, k, PyArray_NDIM(z), PyArray_DIMS(z));
+  if (!retval || !PyBobLearnActivation_Apply(activation,
+        bob::learn::activation::F, (PyObject*)z, retval)) {
+    Py_XDECREF(retval);
+    self->cxx->pop();
+    return 0;
+  }
+
+  return retval;
+
+}
+
+PyDoc_STRVAR(s_backward_str, "backward");
+PyDoc_STRVAR(s_backward_doc,
+"o.backward(k, delta, [res]) -> array\n\
+\n\
+Multiplies ``delta``, the gradients of the outputs of layer ``k``\n\
+(negative values count from the last layer), by the derivative of\n\
+its activation function at them, writing the results to ``res``\n\
+and returning it. If ``res`` is not given, ``delta`` is updated in\n\
+place. Both must be C-contiguous arrays of 64-bit floats with as\n\
+many values as the outputs of the layer.\n\
+\n\
+");
+
+/**
+ * Checks that o is a C-contiguous array of n 64-bit floats, writeable if
+ * requested. Returns 0 with an exception set otherwise.
+ */
+static int check_gradients(PyBobLearnActivationTapeObject* self, PyObject* o,
+    const char* name, std::size_t n, bool writeable) {
+
+  if (!PyArray_Check(o)) {
+    PyErr_Format(PyExc_TypeError, "`%s' requires a numpy array for `%s', not `%s'", Py_TYPE(self)->tp_name, name, Py_TYPE(o)->tp_name);
+    return 0;
+  }
+
+  PyArrayObject* a = reinterpret_cast<PyArrayObject*>(o);
+  if (PyArray_TYPE(a) != NPY_FLOAT64 || !PyArray_IS_C_CONTIGUOUS(a) ||
+      (writeable && !PyArray_ISWRITEABLE(a))) {
+    PyErr_Format(PyExc_TypeError, "`%s' requires a C-contiguous%s array of 64-bit floats for `%s'", Py_TYPE(self)->tp_name, writeable ? ", writeable" : "", name);
+    return 0;
+  }
+
+  if ((std::size_t)PyArray_SIZE(a) != n) {
+    PyErr_Format(PyExc_RuntimeError, "`%s' requires %" PY_FORMAT_SIZE_T "d values for `%s', as many as the outputs of the layer, not %" PY_FORMAT_SIZE_T "d", Py_TYPE(self)->tp_name, (Py_ssize_t)n, name, (Py_ssize_t)PyArray_SIZE(a));
+    return 0;
+  }
+
+  return 1;
+
+}
+
+static PyObject* PyBobLearnActivationTape_backward
+(PyBobLearnActivationTapeObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"k", "delta", "res", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t k = 0;
+  PyObject* delta = 0;
+  PyObject* res = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "nO|O", kwlist,
+        &k, &delta, &res)) return 0;
+
+  Py_ssize_t size = self->cxx->size();
+  if (k < 0) k += size;
+  if (k < 0 || k >= size) {
+    PyErr_Format(PyExc_IndexError, "`%s' has no layer %" PY_FORMAT_SIZE_T "d (it has %" PY_FORMAT_SIZE_T "d)", Py_TYPE(self)->tp_name, k, size);
+    return 0;
+  }
+
+  if (!res) res = delta;
+  std::size_t n = self->cxx->length(k);
+  if (!check_gradients(self, delta, "delta", n, false)) return 0;
+  if (!check_gradients(self, res, "res", n, true)) return 0;
+
+  const double* dp = reinterpret_cast<const double*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(delta)));
+  double* rp = reinterpret_cast<double*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(res)));
+  std::exception_ptr error;
+
+  // other threads may rewind or extend the tape once the GIL is released:
+  // the layer is computed from copies, which keep its memory alive
+  boost::shared_ptr<bob::learn::activation::Activation> activation =
+    self->cxx->activation(k);
+  boost::shared_array<double> block = self->cxx->block(k);
+  const double* f = self->cxx->data(k);
+
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    bob::learn::activation::Tape::backward(*activation, f, dp, rp, n);
+  }
+  catch (...) {
+    error = std::current_exception();
+  }
+  Py_END_ALLOW_THREADS
+
+  if (error) {
+    try { std::rethrow_exception(error); }
+    catch (std::exception& e) {
+      PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
+    catch (...) {
+      PyErr_Format(PyExc_RuntimeError, "unknown exception caught while computing gradients of layer %" PY_FORMAT_SIZE_T "d of `%s'", k, Py_TYPE(self)->tp_name);
+    }
+    return 0;
+  }
+
+  return Py_BuildValue("O", res);
+
+}
+
+PyDoc_STRVAR(s_rewind_str, "rewind");
+PyDoc_STRVAR(s_rewind_doc,
+"o.rewind() -> None\n\
+\n\
+Forgets all layers, for a new iteration. If the arena grew during\n\
+the last iteration, it is replaced by one that fits all its outputs.\n\
+\n\
+");
+
+static PyObject* PyBobLearnActivationTape_rewind
+(PyBobLearnActivationTapeObject* self) {
+
+  self->cxx->rewind();
+  Py_RETURN_NONE;
+
+}
+
+static PyMethodDef PyBobLearnActivationTape_methods[] = {
+  {
+    s_forward_str,
+    (PyCFunction)PyBobLearnActivationTape_forward,
+    METH_VARARGS|METH_KEYWORDS,
+    s_forward_doc
+  },
+  {
+    s_backward_str,
+    (PyCFunction)PyBobLearnActivationTape_backward,
+    METH_VARARGS|METH_KEYWORDS,
+    s_backward_doc
+  },
+  {
+    s_rewind_str,
+    (PyCFunction)PyBobLearnActivationTape_rewind,
+    METH_NOARGS,
+    s_rewind_doc
+  },
+  {0} /* Sentinel */
+};
+
+static Py_ssize_t PyBobLearnActivationTape_len
+(PyBobLearnActivationTapeObject* self) {
+  return self->cxx->size();
+}
+
+static PyObject* PyBobLearnActivationTape_getitem
+(PyBobLearnActivationTapeObject* self, Py_ssize_t k) {
+
+  if (k < 0 || k >= (Py_ssize_t)self->cxx->size()) {
+    PyErr_Format(PyExc_IndexError, "`%s' has no layer %" PY_FORMAT_SIZE_T "d", Py_TYPE(self)->tp_name, k);
+    return 0;
+  }
+
+  return Py_BuildValue("O", PyList_GET_ITEM(self->views, k));
+
+}
+
+static PySequenceMethods PyBobLearnActivationTape_sequence = {
+  (lenfunc)PyBobLearnActivationTape_len,        /* sq_length */
+  0,                                            /* sq_concat */
+  0,                                            /* sq_repeat */
+  (ssizeargfunc)PyBobLearnActivationTape_getitem, /* sq_item */
+};
+
+static PyObject* PyBobLearnActivationTape_capacity
+(PyBobLearnActivationTapeObject* self) {
+  return Py_BuildValue("n", (Py_ssize_t)self->cxx->capacity());
+}
+
+static PyObject* PyBobLearnActivationTape_used
+(PyBobLearnActivationTapeObject* self) {
+  return Py_BuildValue("n", (Py_ssize_t)self->cxx->used());
+}
+
+static PyObject* PyBobLearnActivationTape_allocations
+(PyBobLearnActivationTapeObject* self) {
+  return Py_BuildValue("n", (Py_ssize_t)self->cxx->allocations());
+}
+
+static PyGetSetDef PyBobLearnActivationTape_getseters[] = {
+    {
+      "capacity",
+      (getter)PyBobLearnActivationTape_capacity,
+      0,
+      "Number of values the arena holds (read-only)",
+      0
+    },
+    {
+      "used",
+      (getter)PyBobLearnActivationTape_used,
+      0,
+      "Number of values recorded in this iteration (read-only)",
+      0
+    },
+    {
+      "allocations",
+      (getter)PyBobLearnActivationTape_allocations,
+      0,
+      "Number of times memory was allocated for the arena (read-only)",
+      0
+    },
+    {0}  /* Sentinel */
+};
+
+PyTypeObject PyBobLearnActivationTape_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    s_tape_str,                                         /*tp_name*/
+    sizeof(PyBobLearnActivationTapeObject),             /*tp_basicsize*/
+    0,                                                  /*tp_itemsize*/
+    (destructor)PyBobLearnActivationTape_delete,        /*tp_dealloc*/
+    0,                                                  /*tp_print*/
+    0,                                                  /*tp_getattr*/
+    0,                                                  /*tp_setattr*/
+    0,                                                  /*tp_compare*/
+    0,                                                  /*tp_repr*/
+    0,                                                  /*tp_as_number*/
+    &PyBobLearnActivationTape_sequence,                 /*tp_as_sequence*/
+    0,                                                  /*tp_as_mapping*/
+    0,                                                  /*tp_hash */
+    0,                                                  /*tp_call*/
+    0,                                                  /*tp_str*/
+    0,                                                  /*tp_getattro*/
+    0,                                                  /*tp_setattro*/
+    0,                                                  /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,                                 /*tp_flags*/
+    s_tape_doc,                                         /* tp_doc */
+    0,		                                              /* tp_traverse */
+    0,		                                              /* tp_clear */
+    0,                                                  /* tp_richcompare */
+    0,		                                              /* tp_weaklistoffset */
+    0,		                                              /* tp_iter */
+    0,		                                              /* tp_iternext */
+    PyBobLearnActivationTape_methods,                   /* tp_methods */
+    0,                                                  /* tp_members */
+    PyBobLearnActivationTape_getseters,                 /* tp_getset */
+    0,                                                  /* tp_base */
+    0,                                                  /* tp_dict */
+    0,                                                  /* tp_descr_get */
+    0,                                                  /* tp_descr_set */
+    0,                                                  /* tp_dictoffset */
+    (initproc)PyBobLearnActivationTape_init,            /* tp_init */
+    0,                                                  /* tp_alloc */
+    0,                                                  /* tp_new */
+};
@@ -10,7 +10,30 @@ import numpy
 import math
 
 from . import Identity, Linear, Logistic, HyperbolicTangent, \
-    MultipliedHyperbolicTangent
+    MultipliedHyperbolicTangent, Statistics, intern, set_interning, \
+    interning_statistics, reset_interning_statistics, load_activation, \
+    dumps, loads, save_bundle, load_bundle, Custom, Formula, \
+    add_plugin_directory, plugins, clone_activations
+
+def restore_tunings(saved):
+  """Replaces the tunings of all functions by ``saved``, as returned by
+  :py:func:`bob.learn.activation.tunings`"""
+
+  from . import tunings, set_tuning, reset_tuning
+  for identifier in tunings(): reset_tuning(identifier)
+  for identifier, t in saved.items():
+    set_tuning(identifier, t['threads'], t['threshold'], t['chunk'])
+
+def setup_module():
+  # the tunings saved for this machine, applied on import, change the paths
+  # arrays go through: tests run without them, which are restored afterwards
+  from . import tunings
+  global saved_tunings
+  saved_tunings = tunings()
+  restore_tunings({})
+
+def teardown_module():
+  restore_tunings(saved_tunings)
 
 def estimate_gradient(f, x, epsilon=1e-4, args=()):
   """Estimates the gradient for a given callable f
@@ -321,3 +344,1323 @@ def test_4d_ndarray():
     assert is_close(op.f(x), Y_f.flat[k])
     assert is_close(op.f_prime(x), Y_f_prime.flat[k])
     assert is_close(op.f_prime_from_f(x), Y_f_prime_from_f.flat[k])
+
+def test_buffer_protocol():
+
+  import array
+
+  op = Logistic()
+  X = array.array('d', numpy.random.rand(10))
+
+  # read-only views through any buffer object
+  Y = op.f(X)
+  assert Y.shape == (10,)
+  for k,x in enumerate(X):
+    assert is_close(op.f(x), Y[k])
+
+  Y = op.f(memoryview(X))
+  for k,x in enumerate(X):
+    assert is_close(op.f(x), Y[k])
+
+  # output goes straight into the buffer, without copies
+  R = array.array('d', [0.]*10)
+  op.f_prime(X, R)
+  for k,x in enumerate(X):
+    assert is_close(op.f_prime(x), R[k])
+
+  # outputs that cannot be written in place are rejected
+  for R in ([0.]*10, bytes(bytearray(80))):
+    try:
+      op.f(X, R)
+      assert False, 'did not raise'
+    except TypeError:
+      pass
+
+def test_strided_ndarray():
+
+  op = HyperbolicTangent()
+  X = numpy.random.rand(5, 4, 3)
+
+  for Z in (numpy.asfortranarray(X), X.transpose(2, 0, 1), X[::2,:,::-1]):
+
+    Y = op(Z)
+    assert Y.shape == Z.shape
+    assert numpy.allclose(Y, numpy.tanh(Z))
+
+    R = numpy.zeros(Z.shape, order='F')
+    op.f_prime(Z, R)
+    assert numpy.allclose(R, 1. - numpy.tanh(Z)**2)
+
+    R = numpy.zeros(Z.shape)
+    op.f_prime_from_f(Z, R.T.T)
+    assert numpy.allclose(R, 1. - Z**2)
+
+def test_stream_hdf5():
+
+  import os
+  import tempfile
+  import bob.io.base
+
+  op = Logistic()
+  X = numpy.random.rand(5, 3, 4)
+
+  fname = tempfile.mktemp(suffix='.hdf5')
+  try:
+    f = bob.io.base.HDF5File(fname, 'w')
+    for x in X: f.append('z', x)
+    f.set('single', X[0])
+
+    op.stream_hdf5(f, 'z', f, 'a')
+    op.stream_hdf5(f, 'single', f, 'd', method='f_prime')
+
+    for k,x in enumerate(X):
+      assert numpy.allclose(f.read('a', k), op.f(x))
+    assert numpy.allclose(f.read('d'), op.f_prime(X[0]))
+
+    # streams large expandable datasets, but does not load others whole
+    op.stream_hdf5(f, 'z', f, 'b', limit=8)
+    assert numpy.allclose(f.read('b', 4), op.f(X[4]))
+    try:
+      op.stream_hdf5(f, 'single', f, 'e', limit=8)
+      assert False, 'did not raise on large non-expandable dataset'
+    except RuntimeError:
+      pass
+    assert not f.has_key('e')
+
+    # refuses to overwrite existing datasets
+    try:
+      op.stream_hdf5(f, 'z', f, 'a')
+      assert False, 'did not raise on existing output dataset'
+    except RuntimeError:
+      pass
+
+    del f
+  finally:
+    if os.path.exists(fname): os.unlink(fname)
+
+def test_stream_mapped():
+
+  import os
+  import tempfile
+
+  op = HyperbolicTangent()
+  X = numpy.random.randn(1000, 70)
+
+  zname = tempfile.mktemp(suffix='.bin')
+  aname = tempfile.mktemp(suffix='.bin')
+  try:
+    z = numpy.memmap(zname, dtype=float, mode='w+', shape=X.shape)
+    z[:] = X
+    z.flush()
+    del z
+
+    z = numpy.memmap(zname, dtype=float, mode='r', shape=X.shape)
+    a = numpy.memmap(aname, dtype=float, mode='w+', shape=X.shape)
+
+    # small tiles, so that read-ahead and release are exercised
+    op.stream_mapped(z, a, tile=1000)
+    assert numpy.allclose(a, numpy.tanh(X))
+    assert numpy.allclose(z, X) #input must be intact after being released
+
+    op.stream_mapped(z, a, method='f_prime_from_f', tile=1234)
+    assert numpy.allclose(a, 1. - X**2)
+
+    del z, a
+
+  finally:
+    for k in (zname, aname):
+      if os.path.exists(k): os.unlink(k)
+
+  # plain arrays are processed, but never released
+  Y = numpy.zeros(X.shape)
+  op.stream_mapped(X, Y, 'f_prime', 999)
+  assert numpy.allclose(Y, 1. - numpy.tanh(X)**2)
+  assert numpy.allclose(op.stream_mapped(X.T, Y.T), numpy.tanh(X.T))
+
+def test_async():
+
+  op = Logistic()
+  X = numpy.random.randn(50, 20)
+
+  futures = [op.f_async(x) for x in X]
+  for x, future in zip(X, futures):
+    assert numpy.allclose(future.result(), op.f(x))
+
+  R = numpy.zeros(X.shape)
+  future = op.f_prime_async(X, R)
+  assert future.result() is R
+  assert numpy.allclose(R, op.f_prime(X))
+
+  assert is_close(op.f_prime_from_f_async(0.3).result(), op.f_prime_from_f(0.3))
+
+def test_async_fork():
+
+  import os
+  import sys
+  if not hasattr(os, 'fork'): return
+
+  op = Logistic()
+  X = numpy.random.randn(100)
+  op.f_async(X).result() # starts the executor in this process
+
+  read, write = os.pipe()
+  pid = os.fork()
+  if pid == 0: # child: computes with a new executor
+    status = 1
+    try:
+      import signal
+      signal.alarm(20) # hangs would not complete otherwise
+      Y = op.f_async(X).result()
+      if sys.version_info >= (3, 5): # awaits it, too
+        import asyncio
+        loop = asyncio.new_event_loop()
+        try:
+          Y = loop.run_until_complete(op.f_async(X))
+        finally:
+          loop.close()
+      if numpy.array_equal(Y, op.f(X)): status = 0
+    finally:
+      os.write(write, b'0' if status == 0 else b'1')
+      os._exit(status)
+
+  os.close(write)
+  try:
+    assert os.read(read, 1) == b'0'
+  finally:
+    os.close(read)
+    os.waitpid(pid, 0)
+  assert numpy.array_equal(op.f_async(X).result(), op.f(X))
+
+def test_async_await():
+
+  import sys
+  if sys.version_info < (3, 5): return #no support for awaitables
+
+  import asyncio
+
+  op = HyperbolicTangent()
+  X = numpy.random.randn(1000)
+
+  # the event loop awaits on the future returned
+  loop = asyncio.new_event_loop()
+  try:
+    Y = loop.run_until_complete(op.f_async(X))
+  finally:
+    loop.close()
+  assert numpy.allclose(Y, numpy.tanh(X))
+
+def test_statistics():
+
+  op = HyperbolicTangent()
+  X = 3 * numpy.random.randn(40, 50)
+  A = numpy.tanh(X)
+
+  stats = Statistics(bins=10, lower=-1., upper=1.)
+  Y = op.f(X, stats=stats)
+  assert numpy.allclose(Y, A)
+  assert stats.count == X.size
+  assert is_close(stats.mean, A.mean())
+  assert is_close(stats.variance, A.var())
+  assert is_close(stats.min, A.min()) and is_close(stats.max, A.max())
+  assert is_close(stats.saturated, numpy.mean(abs(A) > 0.99))
+  hist, _ = numpy.histogram(A, bins=10, range=(-1., 1.))
+  assert (stats.histogram == hist).all()
+
+  # strided outputs, accumulated over a second call and merged partials
+  R = numpy.zeros((50, 40)).T
+  op.f(X, R, stats)
+  assert numpy.allclose(R, A)
+  assert stats.count == 2 * X.size
+  other = Statistics(10)
+  op.f(X[:10], stats=other)
+  stats.merge(other)
+  assert stats.count == 2 * X.size + 500
+  B = numpy.concatenate((A.flatten(), A.flatten(), A[:10].flatten()))
+  assert is_close(stats.mean, B.mean())
+  assert is_close(stats.variance, B.var())
+
+  stats.reset()
+  assert stats.count == 0 and stats.histogram.sum() == 0
+
+  # saturation bounds depend on the function
+  stats = Statistics()
+  Logistic().f(numpy.array([-10., 0., 10.]), stats=stats)
+  assert is_close(stats.saturated, 2./3.)
+  stats = Statistics()
+  Linear(2.).f(numpy.array([-10., 0., 10.]), stats=stats)
+  assert stats.saturated == 0.
+  assert stats.histogram[0] == 1 and stats.histogram[-1] == 1
+
+def test_interning():
+
+  reset_interning_statistics()
+
+  keep = [intern(Linear(2.)) for k in range(10)]
+  keep += [intern(MultipliedHyperbolicTangent(1.5, 0.5)) for k in range(5)]
+  keep.append(intern(Linear(3.)))
+
+  stats = interning_statistics()
+  assert stats['requests'] == 16
+  assert stats['deduplicated'] == 13
+  assert stats['live'] >= 3
+
+  # interned objects keep their types and parameters
+  assert isinstance(keep[0], Linear) and keep[0].C == 2.
+  assert isinstance(keep[10], MultipliedHyperbolicTangent)
+  assert keep[10].C == 1.5 and keep[10].M == 0.5
+  assert keep[-1].C == 3.
+
+  # unused instances are released
+  del keep
+  intern(Logistic())
+  assert interning_statistics()['live'] <= 1
+
+  assert set_interning(True) is False
+  assert set_interning(False) is True
+
+def test_load_interned():
+
+  import os
+  import tempfile
+  import bob.io.base
+
+  fname = tempfile.mktemp(suffix='.hdf5')
+  try:
+    f = bob.io.base.HDF5File(fname, 'w')
+    for k in range(20):
+      f.create_group('layer%d' % k)
+      f.cd('layer%d' % k)
+      (Logistic() if k % 2 else Linear(0.5)).save(f)
+      f.cd('..')
+
+    previous = set_interning(True)
+    try:
+      reset_interning_statistics()
+      loaded = []
+      for k in range(20):
+        f.cd('layer%d' % k)
+        loaded.append(load_activation(f))
+        f.cd('..')
+    finally:
+      set_interning(previous)
+
+    assert isinstance(loaded[0], Linear) and loaded[0].C == 0.5
+    assert isinstance(loaded[1], Logistic)
+    assert interning_statistics()['deduplicated'] == 18
+
+    del f
+  finally:
+    if os.path.exists(fname): os.unlink(fname)
+
+def check_same_activations(first, second):
+
+  assert len(first) == len(second)
+  X = numpy.linspace(-3, 3, 13)
+  for a, b in zip(first, second):
+    assert type(a) == type(b)
+    assert a.unique_identifier() == b.unique_identifier()
+    assert numpy.allclose(a.f(X), b.f(X))
+    assert numpy.allclose(a.f_prime(X), b.f_prime(X))
+
+def test_compact():
+
+  activations = [Identity(), Linear(0.25), Logistic(), HyperbolicTangent(),
+      MultipliedHyperbolicTangent(1.7, 2./3.), Linear(-3.)] * 50
+
+  data = dumps(activations)
+  # types are only stored once, records have a fixed size
+  assert len(data) < 32 * (len(activations) + 10)
+  check_same_activations(loads(data), activations)
+  check_same_activations(loads(memoryview(data)), activations)
+  check_same_activations(loads(dumps(Linear(2.))), [Linear(2.)])
+  assert loads(dumps([])) == []
+
+  try:
+    loads(data[:len(data)//2])
+    assert False, 'did not raise on truncated data'
+  except RuntimeError:
+    pass
+
+def test_bundle():
+
+  import os
+  import tempfile
+
+  activations = [MultipliedHyperbolicTangent(2., 0.5), Logistic()] * 100
+
+  fname = tempfile.mktemp(suffix='.bin')
+  try:
+    save_bundle(fname, activations)
+    check_same_activations(load_bundle(fname), activations)
+  finally:
+    if os.path.exists(fname): os.unlink(fname)
+
+def test_compact_hdf5_roundtrip():
+
+  import os
+  import tempfile
+  import bob.io.base
+
+  activations = [Identity(), Linear(0.25), Logistic(), HyperbolicTangent(),
+      MultipliedHyperbolicTangent(1.7, 2./3.)]
+
+  fname = tempfile.mktemp(suffix='.hdf5')
+  try:
+    f = bob.io.base.HDF5File(fname, 'w')
+    for k, a in enumerate(loads(dumps(activations))):
+      f.create_group('a%d' % k)
+      f.cd('a%d' % k)
+      a.save(f)
+      f.cd('..')
+    loaded = []
+    for k in range(len(activations)):
+      f.cd('a%d' % k)
+      loaded.append(load_activation(f))
+      f.cd('..')
+    del f
+    check_same_activations(loads(dumps(loaded)), activations)
+  finally:
+    if os.path.exists(fname): os.unlink(fname)
+
+def _apply_in_worker(args):
+  op, x = args
+  return op.f(x)
+
+def test_pickle_and_copy():
+
+  import copy
+  import pickle
+
+  activations = [Identity(), Linear(0.25), Logistic(), HyperbolicTangent(),
+      MultipliedHyperbolicTangent(1.7, 2./3.)]
+
+  for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+    loaded = [pickle.loads(pickle.dumps(a, protocol)) for a in activations]
+    check_same_activations(loaded, activations)
+
+  check_same_activations([copy.copy(a) for a in activations], activations)
+  check_same_activations(copy.deepcopy(activations), activations)
+  assert copy.deepcopy(activations[1]) is not activations[1]
+  assert activations[4].__getstate__() == dumps(activations[4])
+
+def test_multiprocessing():
+
+  import multiprocessing
+
+  op = MultipliedHyperbolicTangent(1.7, 2./3.)
+  X = numpy.random.randn(4, 10)
+
+  pool = multiprocessing.Pool(2)
+  try:
+    results = pool.map(_apply_in_worker, [(op, x) for x in X])
+  finally:
+    pool.close()
+    pool.join()
+
+  for x, r in zip(X, results):
+    assert numpy.allclose(r, op.f(x))
+
+def test_equality_and_hash():
+
+  assert Logistic() == Logistic()
+  assert Logistic() != HyperbolicTangent()
+  assert Linear(2.) == Linear(2.)
+  assert MultipliedHyperbolicTangent(1.7, 0.5) == MultipliedHyperbolicTangent(1.7, 0.5)
+  assert MultipliedHyperbolicTangent(1.7, 0.5) != MultipliedHyperbolicTangent(0.5, 1.7)
+
+  # parameters are compared exactly, not as printed by str()
+  assert Linear(1.) != Linear(1. + 1e-9)
+  assert str(Linear(1.)) == str(Linear(1. + 1e-9))
+
+  # activations can be used as dictionary keys
+  cache = {Linear(2.): 'a', Logistic(): 'b'}
+  assert cache[Linear(2.)] == 'a'
+  assert cache[Logistic()] == 'b'
+  assert Linear(3.) not in cache
+  assert hash(MultipliedHyperbolicTangent(2., 3.)) == \
+      hash(MultipliedHyperbolicTangent(2., 3.))
+
+  # other objects never compare equal
+  assert Logistic() != 1
+  assert not (Identity() == 'f(z) = z')
+
+class Softplus(Custom):
+
+  def __init__(self, beta=1.):
+    Custom.__init__(self,
+        lambda z: numpy.log1p(numpy.exp(beta * z)) / beta,
+        lambda a: 1. - numpy.exp(-beta * a),
+        identifier='bob.learn.activation.test.Softplus',
+        parameters=(beta,),
+        )
+
+def test_custom():
+
+  calls = []
+  def f(z):
+    calls.append(z.shape)
+    return numpy.tanh(z)
+
+  op = Custom(f, lambda a: 1. - a**2)
+  ref = HyperbolicTangent()
+
+  X = numpy.random.randn(3, 100)
+  assert numpy.allclose(op.f(X), ref.f(X))
+  assert calls == [(300,)] # once per array, not once per element
+
+  # derivatives are computed from f if f_prime is not given
+  assert numpy.allclose(op.f_prime(X), ref.f_prime(X))
+  assert numpy.allclose(op.f_prime_from_f(ref.f(X)), ref.f_prime(X))
+  assert is_close(op.f(0.5), math.tanh(0.5))
+
+  # strided inputs are gathered before the call
+  assert numpy.allclose(op.f(X[:, ::2]), ref.f(X[:, ::2]))
+
+  # errors in callbacks are raised to the caller
+  def broken(z): raise ValueError('broken callback')
+  for op in (Custom(broken, broken), Custom(lambda z: z[:1], broken)):
+    try:
+      op.f(X)
+      assert False, 'did not raise'
+    except RuntimeError:
+      pass
+
+def test_custom_registered():
+
+  import copy
+  import pickle
+
+  Softplus.register('bob.learn.activation.test.Softplus')
+
+  op = Softplus(2.)
+  assert op.parameters == (2.,)
+  X = numpy.random.randn(50)
+  Y = numpy.log1p(numpy.exp(2. * X)) / 2.
+  assert numpy.allclose(op.f(X), Y)
+
+  # registered functions may be saved, copied and pickled
+  for other in (loads(dumps(op))[0], pickle.loads(pickle.dumps(op)),
+      copy.deepcopy(op)):
+    assert other == op
+    assert numpy.allclose(other.f(X), Y)
+  assert op != Softplus(1.)
+
+def test_custom_collected():
+
+  import gc
+  import weakref
+
+  class Holder(object): pass
+  holder = Holder()
+  op = Custom(lambda z: holder.f(z), lambda a: a)
+  holder.f = op.f # creates a reference cycle
+  ref = weakref.ref(holder)
+  del holder, op
+  gc.collect()
+  assert ref() is None
+
+def test_formula():
+
+  op = Formula('tanh(z)', f_prime_from_f='1 - a^2')
+  ref = HyperbolicTangent()
+  X = numpy.random.randn(3, 300) # more than one block
+
+  assert numpy.allclose(op.f(X), ref.f(X))
+  assert numpy.allclose(op.f_prime(X), ref.f_prime(X))
+  assert numpy.allclose(op.f_prime_from_f(ref.f(X)), ref.f_prime(X))
+  assert numpy.allclose(op.f(X[:, ::3]), ref.f(X[:, ::3]))
+  assert op.derivative == '1 - tanh(z)^2'
+
+  # parameters, and derivatives checked against finite differences
+  op = Formula('C * tanh(M * z)', {'C': 1.7, 'M': 2./3.})
+  ref = MultipliedHyperbolicTangent(1.7, 2./3.)
+  assert numpy.allclose(op.f(X), ref.f(X))
+  assert numpy.allclose(op.f_prime(X), ref.f_prime(X))
+  assert op.parameters == {'C': 1.7, 'M': 2./3.}
+
+  for formula in ('x / (1 + abs(x))', '1 / (1 + exp(-x))', 'log1p(exp(x))',
+      'x^3 - 2*x', '2**x', 'sqrt(1 + x^2) - 1', 'erf(x) * cos(x)'):
+    op = Formula(formula)
+    for x in (-1.3, -0.2, 0.4, 2.1):
+      assert is_close(op.f_prime(x), estimate_gradient(op.f, x), 1e-6), \
+          (formula, op.derivative, x)
+
+  # invalid formulas and parameters are reported
+  for args in (('z +',), ('foo(z)',), ('z * y',), ('z', {'z': 1.}),
+      ('z', {'C': 'one'})):
+    try:
+      Formula(*args)
+      assert False, 'did not raise for %s' % (args,)
+    except (RuntimeError, TypeError, ValueError):
+      pass
+
+  # the derivative from f requires a formula for it
+  try:
+    Formula('z / (1 + abs(z))').f_prime_from_f(0.5)
+    assert False, 'did not raise'
+  except RuntimeError:
+    pass
+
+def test_formula_copy():
+
+  import copy
+  import pickle
+
+  op = Formula('C * z / (1 + abs(z))', {'C': 2.}, '2 * (1 - abs(a) / 2)^2')
+  assert op == Formula('C * z / (1 + abs(z))', {'C': 2.}, '2 * (1 - abs(a) / 2)^2')
+  assert op != Formula('C * z / (1 + abs(z))', {'C': 3.}, '2 * (1 - abs(a) / 2)^2')
+  assert op != Formula('C * x / (1 + abs(x))', {'C': 2.}, '2 * (1 - abs(a) / 2)^2')
+
+  X = numpy.random.randn(50)
+  for other in (pickle.loads(pickle.dumps(op)), copy.deepcopy(op)):
+    assert isinstance(other, Formula)
+    assert other == op
+    assert hash(other) == hash(op)
+    assert numpy.allclose(other.f(X), op.f(X))
+  assert numpy.allclose(op.f_prime_from_f(op.f(X)), op.f_prime(X))
+
+def test_formula_hdf5():
+
+  import os
+  import tempfile
+  import bob.io.base
+
+  op = Formula('C * tanh(M * z)', {'C': 1.7, 'M': 2./3.}, 'C * M * (1 - (a/C)^2)')
+
+  fname = tempfile.mktemp(suffix='.hdf5')
+  try:
+    f = bob.io.base.HDF5File(fname, 'w')
+    op.save(f)
+    del f
+    loaded = load_activation(bob.io.base.HDF5File(fname))
+    assert isinstance(loaded, Formula)
+    assert loaded == op
+    assert loaded.f_prime_from_f_formula == op.f_prime_from_f_formula
+  finally:
+    if os.path.exists(fname): os.unlink(fname)
+
+def test_plugins():
+
+  import os
+  import shutil
+  import tempfile
+
+  directory = tempfile.mkdtemp()
+  try:
+    with open(os.path.join(directory, 'test.manifest'), 'wt') as f:
+      f.write('# activations for tests\n')
+      f.write('bob.learn.activation.Activation.Plugin missing.so\n')
+    add_plugin_directory(directory)
+
+    library = os.path.join(directory, 'missing.so')
+    assert plugins()['bob.learn.activation.Activation.Plugin'] == library
+
+    # a record of an unregistered type triggers loading its library
+    data = dumps(Linear(2.)).replace(b'Activation.Linear', b'Activation.Plugin')
+    try:
+      loads(data)
+      assert False, 'did not raise'
+    except RuntimeError as e:
+      assert 'missing.so' in str(e)
+
+  finally:
+    shutil.rmtree(directory)
+
+PLUGIN_SOURCE = """
+#include <bob.learn.activation/Activation.h>
+
+namespace {
+
+  using namespace bob::learn::activation;
+
+  // f(z) = C * z, as a type of its own
+  class ScaledActivation: public Activation {
+    public:
+      ScaledActivation(double C=1.): m_C(C) {}
+      virtual double f(double z) const { return m_C * z; }
+      virtual double f_prime_from_f(double) const { return m_C; }
+      virtual std::vector<double> parameters() const { return std::vector<double>(1, m_C); }
+      virtual boost::shared_ptr<Activation> clone() const { return boost::make_shared<ScaledActivation>(*this); }
+      virtual std::string unique_identifier() const { return "bob.learn.activation.Activation.Scaled"; }
+      virtual std::string str() const { return "f(z) = C * z"; }
+      double m_C;
+  };
+
+  boost::shared_ptr<Activation> factory(bob::io::base::HDF5File& f) {
+    return boost::make_shared<ScaledActivation>(f.read<double>("C"));
+  }
+
+  boost::shared_ptr<Activation> builder(const std::string&, const std::vector<double>& p) {
+    return boost::make_shared<ScaledActivation>(p.at(0));
+  }
+
+  struct Registration {
+    Registration() {
+      auto registry = ActivationRegistry::instance();
+      registry->registerActivation("bob.learn.activation.Activation.Scaled", factory);
+      registry->registerBuilder("bob.learn.activation.Activation.Scaled", builder);
+    }
+  } s_registration;
+
+}
+"""
+
+def build_plugin(directory, name):
+  """Compiles PLUGIN_SOURCE into the library ``name`` in ``directory``,
+  against the headers and library of this package, or skips the calling test
+  if that is not possible. Extra compiler flags are taken from ``CXXFLAGS``."""
+
+  import os
+  import glob
+  import shlex
+  import sysconfig
+  import importlib
+  import subprocess
+  from unittest import SkipTest
+
+  here = os.path.dirname(os.path.abspath(__file__))
+  includes = [os.path.join(here, 'include')]
+  for package in ('bob.blitz', 'bob.core', 'bob.io.base'):
+    try:
+      includes += importlib.import_module(package).get_include_directories()
+    except (ImportError, AttributeError):
+      pass
+
+  # the library holding the registry, which the plugin registers with
+  libraries = sorted(glob.glob(os.path.join(here, 'libbob.learn.activation*.so*'))) or \
+      sorted(glob.glob(os.path.join(here, '_library*.so')))
+  if not libraries: raise SkipTest("cannot find the library of bob.learn.activation")
+
+  source = os.path.join(directory, name + '.cpp')
+  with open(source, 'wt') as f: f.write(PLUGIN_SOURCE)
+  library = os.path.join(directory, name + '.so')
+
+  compiler = shlex.split(sysconfig.get_config_var('CXX') or 'c++')
+  command = compiler + ['-std=c++11', '-shared', '-fPIC', '-o', library, source] + \
+      ['-I' + k for k in includes] + shlex.split(os.environ.get('CXXFLAGS', '')) + \
+      [libraries[0], '-Wl,-rpath,' + here]
+  try:
+    subprocess.check_output(command, stderr=subprocess.STDOUT)
+  except (OSError, subprocess.CalledProcessError) as e:
+    raise SkipTest("cannot build a test plugin: %s" % getattr(e, 'output', e))
+
+  return library
+
+def test_plugin_library():
+
+  import os
+  import shutil
+  import tempfile
+
+  identifier = 'bob.learn.activation.Activation.Scaled'
+  directory = tempfile.mkdtemp()
+  try:
+    library = build_plugin(directory, 'scaled')
+    with open(os.path.join(directory, 'scaled.manifest'), 'wt') as f:
+      f.write('# a plugin built by the tests\n')
+      f.write('%s scaled.so\n' % identifier)
+    add_plugin_directory(directory)
+    assert plugins()[identifier] == library
+
+    # loading a record of that type loads the library, which registers it
+    data = dumps(Linear(3.)).replace(b'Activation.Linear', b'Activation.Scaled')
+    op, = loads(data)
+    assert op.unique_identifier() == identifier
+    assert op.f(2.) == 6. and op.f_prime(2.) == 3.
+    X = numpy.random.randn(10, 5)
+    assert numpy.allclose(op(X), 3. * X)
+    other, = loads(dumps(op))
+    assert other.unique_identifier() == identifier
+    assert numpy.allclose(other(X), 3. * X)
+
+  finally:
+    shutil.rmtree(directory)
+
+def test_clone_activations():
+
+  shared = Logistic()
+  activations = [shared, Linear(2.), shared, Formula('z^2', f_prime_from_f='2*sqrt(a)'),
+      MultipliedHyperbolicTangent(1.7, 2./3.)]
+  copies = clone_activations(activations)
+
+  check_same_activations(copies, activations)
+  assert copies == activations
+  assert clone_activations([]) == []
+
+  # evaluating clones from several threads gives the same results
+  from ._library import _evaluate_in_threads
+  for clone in (False, True):
+    assert _evaluate_in_threads(activations[3], 4, 16, 100, clone) >= 0.
+
+def test_f_second():
+
+  functions = [Identity(), Linear(2.), HyperbolicTangent(), Logistic(),
+      MultipliedHyperbolicTangent(1.7, 2./3.), Formula('z / (1 + abs(z))'),
+      Formula('log1p(exp(z))')]
+
+  X = numpy.random.randn(3, 300)
+  for op in functions:
+    for k in X.flat[:50]:
+      absdiff = abs(op.f_second(k)-estimate_gradient(op.f_prime,k))
+      assert absdiff < 1e-4, '%s second derivative and estimation do not match to 10^-4: |%g-%g| = %g' % (op, op.f_second(k), estimate_gradient(op.f_prime,k), absdiff)
+
+    # batch and scalar versions agree
+    res = op.f_second(X)
+    assert numpy.allclose(res, numpy.vectorize(op.f_second)(X))
+    out = numpy.empty_like(X)
+    assert op.f_second(X, out) is out
+    assert numpy.allclose(out, res)
+
+  # closed forms from the activated value
+  for op in functions[:5]:
+    assert numpy.allclose(op.f_second_from_f(op(X)), op.f_second(X))
+
+  assert Formula('z^3').second_derivative == '6 * z'
+
+  try:
+    functions[-1].f_second_from_f(X)
+    assert False, 'did not raise'
+  except RuntimeError as e:
+    assert 'second derivatives' in str(e)
+
+def test_accuracy():
+
+  # error budgets may be overridden, e.g. to check approximate kernels, by a
+  # JSON file with the structure of accuracy.BUDGETS
+  import os
+  import json
+  from . import accuracy
+
+  budgets = accuracy.BUDGETS
+  fname = os.environ.get('BOB_LEARN_ACTIVATION_ACCURACY_BUDGETS')
+  if fname:
+    budgets = json.loads(json.dumps(budgets)) # a deep copy
+    with open(fname) as f: overrides = json.load(f)
+    for dtype, functions in overrides.items():
+      for name, methods in functions.items():
+        budgets.setdefault(dtype, {}).setdefault(name, {}).update(methods)
+
+  functions = [Identity(), Linear(2.), HyperbolicTangent(), Logistic(),
+      MultipliedHyperbolicTangent(1.7159, 2./3.)]
+
+  violations = []
+  for dtype in ('float64', 'float32'):
+    for op in functions:
+      name = type(op).__name__
+      for method in accuracy.METHODS:
+        for region in accuracy.REGIONS:
+          results = accuracy.measure(op, method, accuracy.inputs(region, 200, dtype))
+          for v in accuracy.check(results, budgets[dtype][name][method]):
+            violations.append('%s.%s (%s, %s): %s' % (name, method, dtype, region, v))
+
+  assert not violations, '\n'.join(violations)
+
+def test_counters():
+
+  from . import set_counting, stats, reset_stats
+  import copy
+
+  op = Logistic()
+  X = numpy.linspace(-1., 1., 100)
+
+  # off by default
+  op.f(X)
+  assert op.stats() == {}
+
+  previous = set_counting(True)
+  assert previous is False
+  try:
+    reset_stats()
+    op.f(0.5)
+    op.f(X)
+    op.f(X, numpy.empty_like(X))
+    op.f_prime(X)
+    op.f_async(X).result()
+  finally:
+    set_counting(False)
+
+  s = op.stats()
+  assert sorted(s.keys()) == ['f', 'f_prime']
+  assert s['f']['scalar']['calls'] == 1
+  assert s['f']['scalar']['elements'] == 1
+  assert s['f']['serial']['calls'] == 2
+  assert s['f']['serial']['elements'] == 200
+  assert s['f']['serial']['bytes'] == 200 * 16
+  assert s['f']['parallel']['calls'] == 1
+  assert s['f']['parallel']['elements'] == 100
+  assert list(s['f_prime'].keys()) == ['serial']
+  for paths in s.values():
+    for entry in paths.values():
+      assert sum(entry['histogram']) == entry['calls']
+      assert entry['nanoseconds'] >= 0
+
+  # the global counters also include other functions
+  other = HyperbolicTangent()
+  set_counting(True)
+  try:
+    other.f(X)
+  finally:
+    set_counting(False)
+  assert other.stats()['f']['serial']['calls'] == 1
+  g = stats()
+  assert g['f']['serial']['calls'] == 3
+  assert g['f']['scalar']['calls'] == 1
+
+  # copies start from zero
+  assert copy.copy(op).stats() == {}
+
+  op.reset_stats()
+  assert op.stats() == {}
+  assert stats()['f']['serial']['calls'] == 3
+  reset_stats()
+  assert stats() == {}
+
+def test_tracing():
+
+  import os
+  import json
+  import tempfile
+  from . import set_tracing, dump_trace, clear_trace, trace_clock
+
+  op = Logistic()
+  X = numpy.linspace(-1., 1., 60).reshape(3, 4, 5)
+
+  fd, fname = tempfile.mkstemp(suffix='.json')
+  os.close(fd)
+
+  try:
+    clear_trace()
+    op.f(X) # not traced
+    start = trace_clock()
+    assert set_tracing(True) is False
+    try:
+      op.f(X)
+      op.f_prime(X.transpose(2, 0, 1))
+      op.f(X[:, :, ::2])
+      op.f_async(X).result()
+      op.f(0.5) # scalars are not traced
+    finally:
+      set_tracing(False)
+    end = trace_clock()
+    op.f(X) # not traced
+
+    assert dump_trace(fname) == 4
+    with open(fname) as f: trace = json.load(f)
+
+  finally:
+    os.unlink(fname)
+
+  events = trace['traceEvents']
+  assert len(events) == 4
+  for e in events:
+    assert e['name'] == op.unique_identifier()
+    assert e['ph'] == 'X'
+    assert start <= e['ts'] and e['ts'] + e['dur'] <= end
+    assert e['args']['dtype'] == 'float64'
+  assert [e['args']['method'] for e in events] == ['f', 'f_prime', 'f', 'f']
+  assert [e['args']['variant'] for e in events] == ['contiguous', 'contiguous',
+      'strided', 'contiguous']
+  assert events[0]['args']['shape'] == [3, 4, 5]
+  assert events[1]['args']['shape'] == [5, 3, 4]
+  assert events[2]['args']['shape'] == [3, 4, 3]
+  assert events[0]['tid'] == events[1]['tid']
+
+  clear_trace()
+  fd, fname = tempfile.mkstemp(suffix='.json')
+  os.close(fd)
+  try:
+    assert dump_trace(fname) == 0
+  finally:
+    os.unlink(fname)
+
+def test_tuning():
+
+  import os
+  import json
+  import tempfile
+  from . import get_tuning, set_tuning, reset_tuning, tunings, set_counting
+  from . import tuning
+
+  op = Logistic()
+  identifier = op.unique_identifier()
+  X = numpy.random.RandomState(0).uniform(-5, 5, (40, 50))
+  expected = op.f(X)
+
+  previous_tunings = tunings()
+  try:
+    reset_tuning(identifier)
+    assert get_tuning(identifier)['threads'] == 1
+
+    set_tuning(identifier, 3, 1000, 128)
+    assert get_tuning(identifier) == dict(threads=3, threshold=1000, chunk=128)
+    assert tunings()[identifier] == get_tuning(identifier)
+
+    previous = set_counting(True)
+    try:
+      op.reset_stats()
+      assert numpy.array_equal(op.f(X), expected)
+      assert numpy.array_equal(op.f(numpy.asfortranarray(X)), expected)
+      assert numpy.array_equal(op.f(X[:, ::2]), expected[:, ::2]) # serial
+      assert numpy.array_equal(op.f(X[:10]), expected[:10]) # below threshold
+    finally:
+      set_counting(previous)
+    s = op.stats()['f']
+    assert s['parallel']['calls'] == 2
+    assert s['serial']['calls'] == 2
+
+    # statistics are accumulated by each thread, then merged
+    serial = Statistics(bins=10, lower=0., upper=1.)
+    op.f(X[:, ::2], stats=serial)
+    op.f(X[:, 1::2], stats=serial)
+    parallel = Statistics(bins=10, lower=0., upper=1.)
+    op.reset_stats()
+    previous = set_counting(True)
+    try:
+      assert numpy.array_equal(op.f(X, stats=parallel), expected)
+    finally:
+      set_counting(previous)
+    assert op.stats()['f']['parallel']['calls'] == 1
+    assert parallel.count == serial.count == X.size
+    assert (parallel.histogram == serial.histogram).all()
+    assert parallel.saturated == serial.saturated
+    assert parallel.min == serial.min and parallel.max == serial.max
+    assert is_close(parallel.mean, serial.mean)
+    assert is_close(parallel.variance, serial.variance)
+
+    try:
+      set_tuning(identifier, 0, 1000, 128)
+      assert False, 'did not raise'
+    except ValueError:
+      pass
+
+    # tunes, saves and loads back
+    fd, fname = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+    os.unlink(fname)
+    try:
+      results = tuning.autotune([op], path=fname, sizes=(1024, 4096),
+          threads=[2], chunks=[512], elements=1 << 14)
+      assert list(results) == [identifier]
+      t = results[identifier]['float64']
+      assert get_tuning(identifier) == t
+      assert t['threads'] in (1, 2)
+      reset_tuning(identifier)
+      assert identifier not in tunings()
+      with open(fname) as f: saved = json.load(f)
+      assert saved[tuning.cpu_model()] == results
+      assert tuning.load(fname) == results
+      assert get_tuning(identifier) == t
+    finally:
+      if os.path.exists(fname): os.unlink(fname)
+
+  finally:
+    restore_tunings(previous_tunings)
+
+  assert identifier not in tunings()
+
+def test_tape():
+
+  from . import Tape
+
+  functions = [HyperbolicTangent(), Logistic(), Identity()]
+  shapes = [(64, 300), (64, 200), (64, 50)]
+  r = numpy.random.RandomState(0)
+
+  tape = Tape()
+  assert len(tape) == 0
+  for iteration in range(4):
+    tape.rewind()
+    inputs = [r.uniform(-2, 2, s) for s in shapes]
+    outputs = [tape.forward(op, z) for op, z in zip(functions, inputs)]
+    assert len(tape) == 3
+    assert tape.used == sum(z.size for z in inputs)
+    for op, z, a, k in zip(functions, inputs, outputs, range(3)):
+      assert a.shape == z.shape
+      assert tape[k] is a
+      assert numpy.array_equal(a, op.f(z))
+
+    if iteration == 1:
+      allocations = tape.allocations
+      first = outputs
+      assert tape.capacity == tape.used # resized to fit
+    if iteration > 1:
+      assert tape.allocations == allocations # steady state
+      assert all(a is b for a, b in zip(outputs, first))
+
+    # backward, in place and to a separate output
+    for k in reversed(range(3)):
+      delta = r.uniform(-1, 1, shapes[k])
+      expected = delta * functions[k].f_prime_from_f(outputs[k])
+      res = numpy.empty_like(delta)
+      assert tape.backward(k, delta, res) is res
+      assert numpy.allclose(res, expected)
+      assert tape.backward(k - 3, delta) is delta
+      assert numpy.array_equal(delta, res)
+
+  # outputs outlive the tape
+  a = tape[0].copy()
+  view = tape[0]
+  del tape
+  assert numpy.array_equal(view, a)
+
+  tape = Tape(capacity=1000)
+  assert tape.capacity == 1000 and tape.allocations == 1
+  tape.forward(Logistic(), numpy.zeros((10, 10)))
+  try:
+    tape.backward(1, numpy.zeros(100))
+    assert False, 'did not raise'
+  except IndexError:
+    pass
+  try:
+    tape.backward(0, numpy.zeros(99))
+    assert False, 'did not raise'
+  except RuntimeError:
+    pass
+  try:
+    tape.backward(0, numpy.zeros((10, 20))[:, ::2])
+    assert False, 'did not raise'
+  except TypeError:
+    pass
+  try:
+    tape.forward(Logistic(), numpy.zeros(10, dtype='float32'))
+    assert False, 'did not raise'
+  except TypeError:
+    pass
+  assert len(tape) == 1
+
+  # rewinding while another thread goes backward
+  import threading
+  tape = Tape()
+  Z = numpy.random.RandomState(1).uniform(-2, 2, (100, 1000))
+  tape.forward(Logistic(), Z)
+  errors = []
+
+  def backward():
+    for k in range(200):
+      try:
+        delta = numpy.ones(Z.shape)
+        tape.backward(-1, delta)
+        assert numpy.isfinite(delta).all()
+      except (IndexError, RuntimeError):
+        pass # the layer went away
+      except Exception as e:
+        errors.append(e)
+
+  thread = threading.Thread(target=backward)
+  thread.start()
+  for k in range(200):
+    tape.rewind()
+    tape.forward(HyperbolicTangent(), Z[:, :k+1])
+    tape.forward(Logistic(), Z)
+  thread.join()
+  assert not errors, errors
+
+def test_pooling():
+
+  from . import set_pooling, pool_statistics, clear_pool, set_pool_limit
+
+  op = Logistic()
+  X = numpy.random.RandomState(0).uniform(-5, 5, (100, 200))
+  expected = op.f(X)
+
+  assert set_pooling(True) is False
+  try:
+    clear_pool()
+    before = pool_statistics()
+
+    for k in range(5):
+      a = op.f(X)
+      assert numpy.array_equal(a, expected)
+      del a
+    s = pool_statistics()
+    assert s['misses'] - before['misses'] == 1
+    assert s['hits'] - before['hits'] == 4
+    assert s['buffers'] == 1 and s['bytes'] == X.nbytes
+
+    # keeps the memory layout, and small arrays are not pooled
+    a = op.f(X.T)
+    assert a.strides == X.T.strides
+    assert numpy.array_equal(a, expected.T)
+    b = op.f(X[:2])
+    assert b.flags.owndata
+    assert numpy.array_equal(b, expected[:2])
+    assert pool_statistics()['hits'] - before['hits'] == 5
+    del a, b
+
+    # buffers outlive the pool being disabled or cleared
+    a = op.f(X)
+    set_pooling(False)
+    clear_pool()
+    assert pool_statistics()['buffers'] == 0
+    assert numpy.array_equal(a, expected)
+    del a
+    assert pool_statistics()['buffers'] == 1
+
+    # buffers above the limit are freed
+    assert set_pool_limit(X.nbytes - 1) == 1 << 28
+    assert pool_statistics()['buffers'] == 0
+    set_pooling(True)
+    op.f(X)
+    assert pool_statistics()['buffers'] == 0
+
+  finally:
+    set_pooling(False)
+    set_pool_limit(1 << 28)
+    clear_pool()
+
+def test_lazy():
+
+  from . import LazyActivation
+
+  op = Logistic()
+  Z = numpy.random.RandomState(0).uniform(-5, 5, (1000, 30))
+  expected = op.f(Z)
+
+  lazy = LazyActivation(op, Z, block=300) # 10 rows per block
+  assert lazy.shape == Z.shape and len(lazy) == 1000 and lazy.size == Z.size
+  assert lazy.computed == 0.
+
+  assert numpy.array_equal(lazy[5], expected[5])
+  assert lazy.computed == 0.01
+  assert lazy[5, 7] == expected[5, 7]
+  assert numpy.array_equal(lazy[3:8, ::2], expected[3:8, ::2])
+  assert lazy.computed == 0.01
+
+  # top-k
+  top = numpy.argpartition(Z, -5, axis=None)[-5:]
+  index = numpy.unravel_index(top, Z.shape)
+  assert numpy.array_equal(lazy[index], expected[index])
+  assert lazy.computed <= 0.06
+
+  # scores above a threshold, by a mask of the full shape
+  mask = Z > 4.99
+  above = LazyActivation(op, Z, block=300)
+  assert numpy.array_equal(above[mask], expected[mask])
+  assert above.computed <= 0.01 * len(numpy.unique(numpy.nonzero(mask)[0]))
+  Z3, expected3 = Z.reshape(100, 10, 30), expected.reshape(100, 10, 30)
+  mask = Z3[:, :, 0] > 4
+  above = LazyActivation(op, Z3, block=300)
+  assert numpy.array_equal(above[mask], expected3[mask])
+  assert numpy.array_equal(above[mask, 1:3], expected3[mask, 1:3])
+
+  for key in (slice(None, None, -3), [7, 2, 2, 999], Z[:, 0] > 4.9,
+      (slice(100, 120), [1, 2]), (numpy.array([[1, 2], [3, 4]]), numpy.array([0, 29])),
+      (Ellipsis, 3), (slice(5, 1, -1), None), -1):
+    assert numpy.array_equal(lazy[key], expected[key]), key
+
+  assert numpy.array_equal(numpy.asarray(lazy), expected)
+  assert lazy.computed == 1.
+
+  # other methods and shapes
+  lazy = LazyActivation(HyperbolicTangent(), Z[:, 0], method='f_prime', block=64)
+  assert numpy.array_equal(lazy[10:20], HyperbolicTangent().f_prime(Z[10:20, 0]))
+
+  for args in ((Z.astype('float32'),), (Z[0, 0],), (Z, 'f', 0)):
+    try:
+      LazyActivation(op, *args)
+      assert False, 'did not raise'
+    except (TypeError, ValueError):
+      pass
+
+def test_result_cache():
+
+  import copy
+
+  op = HyperbolicTangent()
+  X = numpy.random.RandomState(0).uniform(-5, 5, (20, 30))
+  expected = op.f(X)
+  assert op.cache_stats() is None
+
+  op.set_cache(2)
+  a = op.f(X)
+  assert a.flags.writeable
+  b = op.f(X.copy())
+  assert numpy.array_equal(a, expected) and numpy.array_equal(b, expected)
+  assert not b.flags.writeable # shared with the cache
+  s = op.cache_stats()
+  assert (s['hits'], s['misses'], s['entries']) == (1, 1, 1)
+  assert s['hit_rate'] == 0.5 and s['bytes'] == 2 * X.nbytes
+
+  # changing a result does not change the cache
+  a[:] = 0
+  assert numpy.array_equal(op.f(X), expected)
+
+  # other methods, shapes or values miss
+  assert numpy.array_equal(op.f_prime(X), HyperbolicTangent().f_prime(X))
+  assert numpy.array_equal(op.f(X.reshape(30, 20)), expected.reshape(30, 20))
+  Y = X.copy()
+  Y[-1, -1] += 1
+  assert not numpy.array_equal(op.f(Y), expected)
+  s = op.cache_stats()
+  assert (s['hits'], s['misses']) == (2, 4)
+  assert s['entries'] == 2 and s['evictions'] == 2
+
+  # the least recently used result goes first
+  op.f(X) # evicts the reshaped input
+  op.f(Y)
+  op.f(X)
+  op.f(X.reshape(30, 20)) # evicts Y
+  op.f(X)
+  s = op.cache_stats()
+  assert (s['hits'], s['misses']) == (5, 6)
+
+  # non-contiguous inputs and output arrays bypass the cache
+  op.f(X.T)
+  op.f(X, numpy.empty_like(X))
+  s = op.cache_stats()
+  assert s['hits'] + s['misses'] == 11
+
+  # limits in bytes, clearing and copies
+  op.clear_cache()
+  assert op.cache_stats()['entries'] == 0
+  assert copy.copy(op).cache_stats() is None
+  op.set_cache(10, X.nbytes)
+  op.f(X)
+  assert op.cache_stats()['entries'] == 0
+
+  op.set_cache(0)
+  assert op.cache_stats() is None
+  assert op.f(X).flags.writeable
+
+def test_result_cache_counted():
+
+  import os
+  import json
+  import tempfile
+  from . import set_counting, set_tracing, dump_trace, clear_trace
+
+  op = Logistic()
+  op.set_cache(2)
+  X = numpy.linspace(-1., 1., 60).reshape(3, 4, 5)
+
+  fd, fname = tempfile.mkstemp(suffix='.json')
+  os.close(fd)
+
+  try:
+    clear_trace()
+    set_counting(True)
+    set_tracing(True)
+    try:
+      op.f(X) # a miss, evaluated
+      op.f(X) # a hit
+      op.f(X) # another hit
+    finally:
+      set_tracing(False)
+      set_counting(False)
+    assert dump_trace(fname) == 3
+    with open(fname) as f: trace = json.load(f)
+
+  finally:
+    os.unlink(fname)
+    clear_trace()
+
+  assert op.cache_stats()['hits'] == 2
+  s = op.stats()
+  assert s['f']['serial']['calls'] == 3
+  assert s['f']['serial']['elements'] == 3 * X.size
+  assert sum(s['f']['serial']['histogram']) == 3
+  events = trace['traceEvents']
+  assert [e['args']['variant'] for e in events] == ['contiguous', 'cached',
+      'cached']
+  assert all(e['args']['shape'] == [3, 4, 5] for e in events)
+  op.reset_stats()
@@ -0,0 +1,227 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sun 18 Oct 2026 18:40:05 CEST
+
+"""Tunes, per machine, how activation functions evaluate large arrays
+
+Contiguous arrays may be split in chunks, evaluated by several threads (see
+:py:func:`bob.learn.activation.set_tuning`). Whether that pays off, from
+which array size and with how many threads and which chunk size depends on
+the cache sizes and core counts of each machine. :py:func:`autotune`
+benchmarks candidate configurations of each function and keeps the fastest
+ones, which are saved to a cache file (see :py:func:`cache_path`), keyed by
+processor model. :py:func:`load` applies the configurations saved for this
+machine, as done when the package is imported.
+
+Set the environment variable ``BOB_LEARN_ACTIVATION_AUTOTUNE`` to ``1`` to
+tune functions on import when nothing was saved for this machine yet, or to
+``0`` to ignore saved configurations.
+"""
+
+from __future__ import division
+
+import os
+import json
+import platform
+import tempfile
+import timeit
+
+import numpy
+
+from ._library import get_tuning, set_tuning, reset_tuning, tunings, \
+    HyperbolicTangent, Logistic, MultipliedHyperbolicTangent
+
+
+DTYPE = 'float64'
+"""The type of arrays tuned for, the only one evaluated by the kernels"""
+
+SIZES = tuple(1 << k for k in range(12, 24, 2))
+"""Array sizes, in elements, at which configurations are compared"""
+
+CHUNKS = (1 << 12, 1 << 14, 1 << 16)
+"""Chunk sizes, in elements, tried by default"""
+
+
+def cpu_count():
+  """Returns the number of processors of this machine"""
+
+  try:
+    return len(os.sched_getaffinity(0))
+  except AttributeError: #not on Linux, or Python 2
+    import multiprocessing
+    return multiprocessing.cpu_count()
+
+
+def cpu_model():
+  """Returns a description of the processors of this machine, under which
+  tuned configurations are saved"""
+
+  model = None
+  try:
+    with open('/proc/cpuinfo') as f:
+      for line in f:
+        if line.startswith('model name'):
+          model = line.split(':', 1)[1].strip()
+          break
+  except (IOError, OSError):
+    pass
+
+  model = model or platform.processor() or platform.machine() or 'unknown'
+  return '%s, %d processor(s)' % (' '.join(model.split()), cpu_count())
+
+
+def cache_path():
+  """Returns the path of the cache file of tuned configurations, set by the
+  environment variable ``BOB_LEARN_ACTIVATION_TUNING_CACHE`` or, by default,
+  ``bob.learn.activation/tuning.json`` in the user cache directory"""
+
+  path = os.environ.get('BOB_LEARN_ACTIVATION_TUNING_CACHE')
+  if path: return path
+  base = os.environ.get('XDG_CACHE_HOME') or \
+      os.path.join(os.path.expanduser('~'), '.cache')
+  return os.path.join(base, 'bob.learn.activation', 'tuning.json')
+
+
+def _read(path):
+  try:
+    with open(path) as f: return json.load(f)
+  except (IOError, OSError):
+    return {}
+
+
+def _write(path, contents):
+  """Replaces the contents of ``path`` at once, so that concurrent readers
+  never see partial files"""
+
+  directory = os.path.dirname(os.path.abspath(path))
+  if not os.path.exists(directory): os.makedirs(directory)
+  fd, tmp = tempfile.mkstemp(dir=directory, suffix='.json')
+  try:
+    with os.fdopen(fd, 'w') as f: json.dump(contents, f, indent=2, sort_keys=True)
+    os.rename(tmp, path)
+  except:
+    os.unlink(tmp)
+    raise
+
+
+def load(path=None):
+  """Applies the configurations saved for this machine in the cache file
+  (by default, :py:func:`cache_path`), returning them by function unique
+  identifier and type, or ``None`` if none were saved"""
+
+  saved = _read(path or cache_path()).get(cpu_model())
+  if not saved: return None
+  for identifier, types in saved.items():
+    if DTYPE in types: set_tuning(identifier, **types[DTYPE])
+  return saved
+
+
+def save(configurations, path=None):
+  """Saves the ``configurations`` of :py:func:`autotune` for this machine in
+  the cache file (by default, :py:func:`cache_path`), along with those of
+  other functions and machines"""
+
+  path = path or cache_path()
+  contents = _read(path)
+  contents.setdefault(cpu_model(), {}).update(configurations)
+  _write(path, contents)
+
+
+def _time(op, z, res, elements):
+  """Returns the best time per element of ``op.f(z, res)``, evaluating about
+  ``elements`` elements in total"""
+
+  number = max(1, elements // (3 * z.size))
+  return min(timeit.repeat(lambda: op.f(z, res), number=number, repeat=3)) \
+      / (number * z.size)
+
+
+def tune(op, sizes=SIZES, threads=None, chunks=CHUNKS, elements=1 << 22,
+    margin=0.1):
+  """Finds the fastest configuration of ``op`` for this machine and returns
+  it, as a dictionary like that of
+  :py:func:`bob.learn.activation.get_tuning`
+
+  All combinations of ``threads`` (by default, powers of two up to the
+  number of processors, and the latter) and ``chunks`` are compared, at the
+  largest of ``sizes``, to serial evaluation. The threshold is the smallest
+  size from which the fastest combination beats serial evaluation by the
+  given ``margin`` (a fraction of the serial time) at all sizes. If there is
+  none, serial evaluation is kept. The tuning of ``op`` is restored
+  afterwards.
+  """
+
+  if threads is None:
+    n = cpu_count()
+    threads = sorted(set([1 << k for k in range(1, n.bit_length())] + [n]))
+  candidates = [(t, c) for t in threads if t > 1 for c in chunks]
+
+  identifier = op.unique_identifier()
+  previous = tunings().get(identifier)
+  sizes = sorted(sizes)
+  z = numpy.random.RandomState(0).uniform(-5., 5., sizes[-1])
+  res = numpy.empty_like(z)
+
+  try:
+    reset_tuning(identifier)
+    retval = dict(get_tuning(identifier), threads=1)
+    serial = [_time(op, z[:s], res[:s], elements) for s in sizes]
+
+    best = None
+    for t, c in candidates:
+      set_tuning(identifier, t, 0, c)
+      elapsed = _time(op, z, res, elements)
+      if best is None or elapsed < best[0]: best = (elapsed, t, c)
+
+    if best is None: return retval
+
+    set_tuning(identifier, best[1], 0, best[2])
+    parallel = [_time(op, z[:s], res[:s], elements) for s in sizes]
+
+    threshold = None
+    for s, a, b in reversed(list(zip(sizes, serial, parallel))):
+      if b > (1 - margin) * a: break
+      threshold = s
+
+    if threshold is not None:
+      retval = dict(threads=best[1], threshold=threshold, chunk=best[2])
+    return retval
+
+  finally:
+    if previous: set_tuning(identifier, **previous)
+    else: reset_tuning(identifier)
+
+
+def autotune(activations=None, path=None, **kwargs):
+  """Tunes ``activations`` (by default, the built-in hyperbolic tangents and
+  the logistic function) with :py:func:`tune`, which accepts ``kwargs``, and
+  applies and saves the results to the cache file (by default,
+  :py:func:`cache_path`), unless ``path`` is ``False``. Returns the results,
+  by function unique identifier and type."""
+
+  if activations is None:
+    activations = (HyperbolicTangent(), Logistic(),
+        MultipliedHyperbolicTangent())
+
+  retval = {}
+  for op in activations:
+    tuning = tune(op, **kwargs)
+    set_tuning(op.unique_identifier(), **tuning)
+    retval[op.unique_identifier()] = {DTYPE: tuning}
+
+  if path is not False: save(retval, path)
+  return retval
+
+
+def ensure():
+  """Applies saved configurations, tuning functions first if none were saved
+  for this machine and ``BOB_LEARN_ACTIVATION_AUTOTUNE`` is set to ``1``.
+  Called when the package is imported."""
+
+  setting = os.environ.get('BOB_LEARN_ACTIVATION_AUTOTUNE')
+  if setting == '0': return
+  try:
+    if load() is None and setting == '1': autotune()
+  except (IOError, OSError, ValueError, TypeError) as e:
+    import warnings
+    warnings.warn("ignoring tuned configurations of activation functions: %s" % e)
@@ -53,11 +53,23 @@ setup(
       Library("bob.learn.activation.bob_learn_activation",
         [
           "bob/learn/activation/cpp/ActivationRegistry.cpp",
+          "bob/learn/activation/cpp/Stream.cpp",
+          "bob/learn/activation/cpp/Executor.cpp",
+          "bob/learn/activation/cpp/Statistics.cpp",
+          "bob/learn/activation/cpp/Compact.cpp",
+          "bob/learn/activation/cpp/FormulaActivation.cpp",
+          "bob/learn/activation/cpp/Counters.cpp",
+          "bob/learn/activation/cpp/Trace.cpp",
+          "bob/learn/activation/cpp/Tuning.cpp",
+          "bob/learn/activation/cpp/Tape.cpp",
+          "bob/learn/activation/cpp/BufferPool.cpp",
+          "bob/learn/activation/cpp/ResultCache.cpp",
         ],
         bob_packages = bob_packages,
         version = version,
         packages = packages,
         boost_modules = boost_modules,
+        libraries = ['dl'], # plugins are loaded with dlopen()
       ),
 
       Extension("bob.learn.activation._library",
@@ -68,6 +80,10 @@ setup(
           "bob/learn/activation/logistic.cpp",
           "bob/learn/activation/tanh.cpp",
           "bob/learn/activation/mult_tanh.cpp",
+          "bob/learn/activation/statistics.cpp",
+          "bob/learn/activation/tape.cpp",
+          "bob/learn/activation/custom.cpp",
+          "bob/learn/activation/formula.cpp",
           "bob/learn/activation/main.cpp",
         ],
         bob_packages = bob_packages,
@@ -75,12 +91,28 @@ setup(
         packages = packages,
         boost_modules = boost_modules,
       ),
+
+      Extension("bob.learn.activation._benchmark",
+        [
+          "bob/learn/activation/benchmark.cpp",
+        ],
+        bob_packages = bob_packages,
+        version = version,
+        packages = packages,
+        boost_modules = boost_modules,
+      ),
     ],
 
     cmdclass = {
       'build_ext': build_ext
     },
 
+    entry_points = {
+      'console_scripts': [
+        'bob_learn_activation_benchmark.py = bob.learn.activation.script.benchmark:main',
+      ],
+    },
+
     classifiers = [
       'Framework :: Bob',
       'Development Status :: 4 - Beta',